@@ -0,0 +1,433 @@
+#include <dropclone/path_snapshot.hpp>
+#include <dropclone/path_info.hpp>
+#include <dropclone/clone_config.hpp>
+#include <dropclone/content_hash.hpp>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Microbenchmarks of the snapshot, diff, filter and hash hot paths over
+// synthetic snapshots. Results are printed as a table and written as JSON:
+//
+//   dropclone_bench [--sizes=10000,100000,1000000] [--repetitions=5]
+//                   [--changed-subtree=100000] [--filter=<substring>]
+//                   [--json=<file>]
+//
+// The snapshots are built in memory, except for 'snapshot/make', which
+// scans a generated tree on disk and therefore only runs up to
+// 'max_disk_entries' entries. 'snapshot/local_diff_subtree' diffs a tree
+// in which a whole subtree of --changed-subtree entries changed;
+// 'baseline/quadratic_correction' times the correction pass local_diff
+// used before on such a diff.
+
+namespace fs = std::filesystem;
+namespace chr = std::chrono;
+namespace rng = std::ranges;
+namespace dc = dropclone;
+
+namespace {
+
+constexpr std::size_t max_disk_entries{100'000};
+constexpr std::uint64_t generator_seed{0x5eed};
+constexpr std::size_t directory_fan_out{16};
+constexpr std::size_t files_per_directory{24};
+constexpr std::size_t subtree_files_per_directory{50};
+constexpr std::size_t max_quadratic_entries{10'000};
+
+struct options {
+  std::vector<std::size_t> sizes{10'000, 100'000, 1'000'000};
+  std::size_t changed_subtree{100'000}; // entries of the subtree that changes as a whole
+  std::size_t repetitions{5};
+  std::string filter{};
+  fs::path json{"dropclone_bench.json"};
+};
+
+struct result {
+  std::string name{};
+  std::size_t entries{0};
+  std::size_t repetitions{0};
+  double min_ns{0};
+  double median_ns{0};
+  double mean_ns{0};
+  double items_per_second{0};
+};
+
+// Directory names and file extensions roughly as they show up in home and
+// project directories – including the usual candidates for exclusion.
+constexpr std::string_view directory_names[]{
+  "src", "include", "docs", "assets", "build", "node_modules", ".git", "cache",
+  "photos", "2024", "2025", "projects", "tmp", "vendor", "lib", "out"
+};
+constexpr std::string_view file_extensions[]{
+  ".txt", ".cpp", ".hpp", ".jpg", ".png", ".pdf", ".o", ".tmp",
+  ".log", ".json", ".md", ".mp4", ".swp", ".py", ".zip", ""
+};
+
+// 'count' entries in a tree of 'directory_fan_out' directories per level
+// with 'files_per_directory' files each, deterministic for a given count
+auto synthetic_entries(std::size_t count) -> dc::path_snapshot::entry_list {
+  std::mt19937_64 random{generator_seed};
+  std::uniform_int_distribution<std::uintmax_t> file_size{0, 16 * 1024 * 1024};
+  auto const now = fs::file_time_type::clock::now();
+
+  dc::path_snapshot::entry_list entries{};
+  entries.reserve(count);
+
+  std::vector<fs::path> directories{fs::path{}};
+  for (std::size_t next_directory{0}; entries.size() < count; ++next_directory) {
+    auto const parent = directories[next_directory];
+
+    for (std::size_t file{0}; file != files_per_directory && entries.size() < count; ++file) {
+      dc::path_info info{};
+      info.file_size = file_size(random);
+      info.last_write_time = now - chr::seconds{random() % (365 * 24 * 3600)};
+      info.file_perms = fs::perms::owner_read | fs::perms::owner_write | fs::perms::group_read;
+      auto name = "file_" + std::to_string(file) + std::string{file_extensions[random() % std::size(file_extensions)]};
+      entries.emplace_back(parent / name, info);
+    }
+
+    for (std::size_t child{0}; child != directory_fan_out && entries.size() < count; ++child) {
+      dc::path_info info{};
+      info.is_directory = true;
+      info.last_write_time = now;
+      info.file_perms = fs::perms::owner_all | fs::perms::group_read | fs::perms::group_exec;
+      auto const directory = parent / (std::string{directory_names[child]} + "_" + std::to_string(next_directory));
+      entries.emplace_back(directory, info);
+      directories.push_back(directory);
+    }
+  }
+  return entries;
+}
+
+// a later state of 'entries': 1% of the files modified, 0.5% deleted and
+// as many added
+auto mutated_entries(dc::path_snapshot::entry_list entries) -> dc::path_snapshot::entry_list {
+  std::mt19937_64 random{generator_seed + 1};
+  auto const changes = std::max<std::size_t>(entries.size() / 200, 1);
+
+  for (std::size_t change{0}; change != changes * 2; ++change) {
+    auto& info = entries[random() % entries.size()].second;
+    if (!info.is_directory) { info.last_write_time += chr::seconds{1}; }
+  }
+  for (std::size_t change{0}; change != changes; ++change) {
+    auto const index = random() % entries.size();
+    if (entries[index].second.is_directory) { continue; }
+
+    auto added = entries[index];
+    added.first.replace_filename("added_" + std::to_string(change) + ".txt");
+    entries[index] = entries.back();
+    entries.back() = std::move(added);
+  }
+  return entries;
+}
+
+// 'changed' entries below 'hot' that all changed, next to as many below
+// 'stable' that did not: the previous and the current state
+auto subtree_entries(std::size_t changed) -> std::pair<dc::path_snapshot::entry_list, dc::path_snapshot::entry_list> {
+  auto const subtree = synthetic_entries(changed);
+
+  dc::path_snapshot::entry_list previous{};
+  previous.reserve(subtree.size() * 2 + 2);
+  for (auto const* name : {"stable", "hot"}) {
+    dc::path_info info{};
+    info.is_directory = true;
+    info.file_perms = fs::perms::owner_all;
+    previous.emplace_back(name, info);
+    rng::for_each(subtree, [&](auto const& entry) { previous.emplace_back(name / entry.first, entry.second); });
+  }
+
+  auto current = previous;
+  rng::for_each(current, [](auto& entry) {
+    if (*entry.first.begin() == "hot") { entry.second.last_write_time += chr::seconds{1}; }
+  });
+  return {std::move(previous), std::move(current)};
+}
+
+// the structural correction pass of local_diff before it was made linear:
+// every directory scans all changed entries for one below it
+auto quadratic_correction(dc::path_snapshot const& diff) -> std::size_t {
+  std::size_t structurally_required{0};
+  rng::for_each(diff.directories(), [&](auto const& directory) {
+    auto const is_relevant_change = [&](auto const& entry) {
+      return entry.first != directory.first &&
+             entry.first.string().starts_with(directory.first.string()) &&
+             entry.second.path_status != dc::path_info::status::deleted;
+    };
+    if (directory.second.path_status != dc::path_info::status::deleted &&
+        !rng::any_of(diff.files(), is_relevant_change) && !rng::any_of(diff.directories(), is_relevant_change)) {
+      ++structurally_required;
+    }
+  });
+  return structurally_required;
+}
+
+// makes 'value' observable to the compiler, so the work producing it is
+// neither folded nor hoisted out of the measured loop
+template <typename value_type>
+auto do_not_optimize(value_type const& value) -> void {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+auto measure(std::string name, std::size_t entries, options const& options,
+             std::function<void()> const& setup, std::function<void()> const& run) -> result {
+  std::vector<double> samples{};
+  samples.reserve(options.repetitions);
+
+  for (std::size_t repetition{0}; repetition != options.repetitions; ++repetition) {
+    setup();
+    auto const started = chr::steady_clock::now();
+    run();
+    samples.push_back(chr::duration<double, std::nano>{chr::steady_clock::now() - started}.count());
+  }
+
+  rng::sort(samples);
+  result measured{std::move(name), entries, options.repetitions};
+  measured.min_ns = samples.front();
+  measured.median_ns = samples[samples.size() / 2];
+  measured.mean_ns = std::accumulate(samples.begin(), samples.end(), 0.0) / static_cast<double>(samples.size());
+  measured.items_per_second = measured.median_ns > 0 ? static_cast<double>(entries) * 1e9 / measured.median_ns : 0;
+  return measured;
+}
+
+auto absolute_paths(fs::path const& root, dc::path_snapshot::entry_list const& entries) -> std::vector<fs::path> {
+  std::vector<fs::path> paths{};
+  paths.reserve(entries.size());
+  rng::for_each(entries, [&](auto const& entry) { paths.push_back(root / entry.first); });
+  return paths;
+}
+
+auto make_disk_tree(fs::path const& root, dc::path_snapshot::entry_list const& entries) -> void {
+  fs::remove_all(root);
+  fs::create_directories(root);
+  rng::for_each(entries, [&](auto const& entry) {
+    if (entry.second.is_directory) {
+      fs::create_directories(root / entry.first);
+    } else {
+      fs::create_directories((root / entry.first).parent_path());
+      std::ofstream{root / entry.first};
+    }
+  });
+}
+
+auto run_benchmarks(options const& options) -> std::vector<result> {
+  std::vector<result> results{};
+  auto const selected = [&](std::string_view name) {
+    return options.filter.empty() || name.find(options.filter) != std::string_view::npos;
+  };
+  auto const record = [&](result measured) {
+    std::cout << std::format("{:<32} {:>10} {:>14.0f} ns {:>14.0f} items/s\n",
+      measured.name, measured.entries, measured.median_ns, measured.items_per_second);
+    results.push_back(std::move(measured));
+  };
+
+  fs::path const root{"/bench/source"};
+
+  // realistic exclude and include sets: globs for build output, VCS and
+  // editor files, plus a few regexes
+  dc::config_entry::raw_patterns_type exclude_patterns{
+    "glob:node_modules", "glob:.git", "glob:build/**", "glob:*.tmp", "glob:*.swp",
+    "glob:*.o", "glob:cache", "\\.log$", "(^|/)tmp_[0-9]+/", "glob:**/vendor/**/*.zip"
+  };
+  dc::config_entry::raw_patterns_type include_patterns{
+    "glob:*.jpg", "glob:*.png", "glob:*.pdf", "glob:photos/**", "\\.(cpp|hpp|py)$"
+  };
+  dc::config_entry::raw_patterns_type no_patterns{};
+  dc::config_entry exclude_entry{root, "/bench/destination", dc::clone_mode::copy, exclude_patterns, no_patterns};
+  dc::config_entry include_entry{root, "/bench/destination", dc::clone_mode::copy, no_patterns, include_patterns};
+
+  for (auto const size : options.sizes) {
+    auto const entries = synthetic_entries(size);
+    auto const changed = mutated_entries(entries);
+    auto const nothing = [] {};
+
+    if (selected("snapshot/build")) {
+      record(measure(std::format("snapshot/build/{}", size), size, options, nothing, [&] {
+        dc::path_snapshot snapshot{root, entries};
+      }));
+    }
+
+    if (selected("snapshot/local_diff")) {
+      dc::path_snapshot previous{root, entries};
+      dc::path_snapshot current{root, changed};
+      record(measure(std::format("snapshot/local_diff/{}", size), size, options, nothing, [&] {
+        do_not_optimize(current.local_diff(previous).files().size());
+        do_not_optimize(previous.local_diff(current).files().size());
+      }));
+    }
+
+    if (selected("filter/exclude") || selected("filter/include")) {
+      auto const paths = absolute_paths(root, entries);
+      if (selected("filter/exclude")) {
+        record(measure(std::format("filter/exclude/{}", size), size, options, nothing, [&] {
+          rng::for_each(paths, [&](auto const& path) { do_not_optimize(exclude_entry.filter(path)); });
+        }));
+      }
+      if (selected("filter/include")) {
+        record(measure(std::format("filter/include/{}", size), size, options, nothing, [&] {
+          rng::for_each(paths, [&](auto const& path) { do_not_optimize(include_entry.filter(path)); });
+        }));
+      }
+    }
+
+    if (selected("snapshot/make") && size <= max_disk_entries) {
+      auto const tree = fs::temp_directory_path() / "dropclone_bench_tree";
+      make_disk_tree(tree, entries);
+      auto const threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+      record(measure(std::format("snapshot/make/{}", size), size, options, nothing, [&] {
+        dc::path_snapshot snapshot{tree};
+        snapshot.make({}, 1);
+      }));
+      record(measure(std::format("snapshot/make_parallel/{}", size), size, options, nothing, [&] {
+        dc::path_snapshot snapshot{tree};
+        snapshot.make({}, threads);
+      }));
+
+      fs::remove_all(tree);
+    }
+  }
+
+  // a whole subtree changed: local_diff against the quadratic correction
+  // pass it used before. That pass needs minutes at 100k entries, so it
+  // runs once and only up to 'max_quadratic_entries'; local_diff runs at
+  // that size as well for comparison.
+  auto const subtree_sizes = std::set<std::size_t>{
+    std::min(options.changed_subtree, max_quadratic_entries), options.changed_subtree
+  };
+  for (auto const changed : subtree_sizes) {
+    if (!selected("snapshot/local_diff_subtree") && !selected("baseline/quadratic_correction")) { break; }
+
+    auto const [previous_entries, current_entries] = subtree_entries(changed);
+    dc::path_snapshot previous{root, previous_entries};
+    dc::path_snapshot current{root, current_entries};
+
+    if (selected("snapshot/local_diff_subtree")) {
+      record(measure(std::format("snapshot/local_diff_subtree/{}", changed), changed, options, [] {}, [&] {
+        do_not_optimize(current.local_diff(previous).files().size());
+      }));
+    }
+    if (selected("baseline/quadratic_correction") && changed <= max_quadratic_entries) {
+      auto const diff = current.local_diff(previous);
+      auto once = options;
+      once.repetitions = 1;
+      record(measure(std::format("baseline/quadratic_correction/{}", changed), changed, once, [] {}, [&] {
+        do_not_optimize(quadratic_correction(diff));
+      }));
+    }
+  }
+
+  // content digests: bytes per second, independent of the snapshot size
+  if (selected("hash/xxh3")) {
+    for (std::size_t const bytes : {std::size_t{4096}, std::size_t{1 << 20}, std::size_t{64 << 20}}) {
+      std::vector<unsigned char> buffer(bytes);
+      std::mt19937_64 random{generator_seed};
+      rng::generate(buffer, [&] { return static_cast<unsigned char>(random()); });
+
+      record(measure(std::format("hash/xxh3/{}", bytes), bytes, options, [] {}, [&] {
+        dc::xxh3 hasher{};
+        hasher.update(buffer.data(), buffer.size());
+        do_not_optimize(hasher.digest());
+      }));
+    }
+  }
+
+  return results;
+}
+
+auto parse_sizes(std::string_view list) -> std::vector<std::size_t> {
+  std::vector<std::size_t> sizes{};
+  while (!list.empty()) {
+    auto const comma = list.find(',');
+    sizes.push_back(std::stoull(std::string{list.substr(0, comma)}));
+    list.remove_prefix(comma == std::string_view::npos ? list.size() : comma + 1);
+  }
+  return sizes;
+}
+
+auto parse_options(int argc, char const* argv[]) -> options {
+  options parsed{};
+  for (int index{1}; index < argc; ++index) {
+    std::string_view const argument{argv[index]};
+    auto const value = argument.substr(argument.find('=') + 1);
+
+    if (argument.starts_with("--sizes=")) { parsed.sizes = parse_sizes(value); }
+    else if (argument.starts_with("--repetitions=")) { parsed.repetitions = std::max<std::size_t>(std::stoull(std::string{value}), 1); }
+    else if (argument.starts_with("--changed-subtree=")) { parsed.changed_subtree = std::max<std::size_t>(std::stoull(std::string{value}), 1); }
+    else if (argument.starts_with("--filter=")) { parsed.filter = value; }
+    else if (argument.starts_with("--json=")) { parsed.json = value; }
+    else { throw std::invalid_argument{std::string{argument}}; }
+  }
+  return parsed;
+}
+
+auto write_json(options const& options, std::vector<result> const& results) -> void {
+  nlohmann::json report{};
+  auto const now = std::time(nullptr);
+  char date[32]{};
+  std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+  report["context"] = {
+    {"date", date},
+    {"repetitions", options.repetitions},
+    {"hardware_concurrency", std::thread::hardware_concurrency()},
+#ifdef NDEBUG
+    {"build_type", "release"},
+#else
+    {"build_type", "debug"},
+#endif
+#if defined(__clang__)
+    {"compiler", std::format("clang {}.{}", __clang_major__, __clang_minor__)}
+#elif defined(__GNUC__)
+    {"compiler", std::format("gcc {}.{}", __GNUC__, __GNUC_MINOR__)}
+#else
+    {"compiler", "unknown"}
+#endif
+  };
+
+  report["benchmarks"] = nlohmann::json::array();
+  rng::for_each(results, [&](auto const& measured) {
+    report["benchmarks"].push_back({
+      {"name", measured.name},
+      {"entries", measured.entries},
+      {"repetitions", measured.repetitions},
+      {"min_ns", measured.min_ns},
+      {"median_ns", measured.median_ns},
+      {"mean_ns", measured.mean_ns},
+      {"items_per_second", measured.items_per_second}
+    });
+  });
+
+  std::ofstream{options.json} << report.dump(2) << '\n';
+}
+
+} // namespace
+
+auto main(int argc, char const* argv[]) -> int {
+  try {
+    auto const options = parse_options(argc, argv);
+    write_json(options, run_benchmarks(options));
+    std::cout << "results written to " << options.json.string() << '\n';
+  } catch (std::invalid_argument const& e) {
+    std::cerr << "unknown argument: " << e.what() << '\n'
+              << "usage: dropclone_bench [--sizes=<n,...>] [--repetitions=<n>] [--changed-subtree=<n>] [--filter=<name>] [--json=<file>]\n";
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
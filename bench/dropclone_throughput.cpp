@@ -0,0 +1,546 @@
+#include <dropclone/drop_clone.hpp>
+#include <dropclone/nlohmann_json_parser.hpp>
+#include <dropclone/exception.hpp>
+#include <spdlog/spdlog.h>
+#include <nlohmann/json.hpp>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cerrno>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// End-to-end throughput of drop_clone::sync on a generated tree on disk,
+// next to 'cp -a' and 'rsync -a --delete' on the same tree:
+//
+//   dropclone_throughput [--work=<dir>] [--profile=small|large|mixed]
+//                        [--files=<n>] [--depth=<n>] [--fan-out=<n>]
+//                        [--rounds=<n>] [--mutations=<fraction>]
+//                        [--modes=copy,move] [--seed=<n>] [--json=<file>]
+//
+// Each mode starts with a full sync of a fresh tree, followed by rounds
+// of scripted mutations (add, modify, delete, rename, chmod), each synced
+// and timed on its own. Moved files leave the source, so the rounds of
+// 'move' only add files. The page cache stays warm; dirty pages are
+// written back before every timed step.
+//
+// Syscalls are the read and write calls of /proc/<pid>/io (syscr, syscw),
+// the only per-process syscall counters the kernel keeps without tracing.
+
+namespace fs = std::filesystem;
+namespace chr = std::chrono;
+namespace rng = std::ranges;
+namespace dc = dropclone;
+
+namespace {
+
+enum class tree_profile { small, large, mixed };
+
+struct options {
+  fs::path work{fs::temp_directory_path() / "dropclone_throughput"};
+  tree_profile profile{tree_profile::mixed};
+  std::size_t files{20'000};
+  std::size_t depth{4};
+  std::size_t fan_out{6};
+  std::size_t rounds{3};
+  double mutations{0.05};
+  std::vector<std::string> modes{"copy", "move"};
+  std::uint64_t seed{0x5eed};
+  fs::path json{"dropclone_throughput.json"};
+};
+
+struct io_counters {
+  std::uint64_t read_calls{0};
+  std::uint64_t write_calls{0};
+};
+
+struct measurement {
+  std::string tool{};
+  std::string mode{};
+  std::string step{};
+  std::size_t files{0};
+  std::uintmax_t bytes{0};
+  double seconds{0};
+  std::optional<std::uint64_t> syscalls{};
+  long peak_rss_kib{0};
+};
+
+// the paths a step has to bring over and the bytes written to them
+struct workload {
+  std::size_t files{0};
+  std::uintmax_t bytes{0};
+};
+
+auto profile_name(tree_profile profile) -> std::string_view {
+  switch (profile) {
+    case tree_profile::small: return "small";
+    case tree_profile::large: return "large";
+    case tree_profile::mixed: return "mixed";
+  }
+  return "unknown";
+}
+
+// Synthetic source trees. 'small' is source code and documents (a few
+// KiB each), 'large' is media (several MiB each), 'mixed' is 95% small
+// and 5% large files – the shape of a typical home directory.
+class tree_generator {
+ public:
+  tree_generator(options const& options) : options_{options}, random_{options.seed} {}
+
+  auto generate(fs::path const& root) -> workload {
+    fs::remove_all(root);
+    directories_.clear();
+    add_directories(root, 0);
+
+    workload generated{};
+    for (std::size_t file{0}; file != options_.files; ++file) {
+      generated.bytes += write_file(directories_[random_() % directories_.size()] / file_name(file));
+      ++generated.files;
+    }
+    next_file_ = options_.files;
+    return generated;
+  }
+
+  // applies one round of mutations to 'root' and returns what a sync has
+  // to transfer afterwards
+  auto mutate(fs::path const& root, bool only_add) -> workload {
+    auto files = regular_files(root);
+    auto const count = std::max<std::size_t>(
+      static_cast<std::size_t>(static_cast<double>(std::max(files.size(), options_.files)) * options_.mutations), 1);
+
+    workload changed{};
+    auto const add = [&] {
+      changed.bytes += write_file(directories_[random_() % directories_.size()] / file_name(next_file_++));
+    };
+
+    if (only_add || files.empty()) {
+      for (std::size_t mutation{0}; mutation != count; ++mutation) { add(); }
+      changed.files = count;
+      return changed;
+    }
+
+    rng::shuffle(files, random_);
+    files.resize(std::min(files.size(), count));
+
+    for (std::size_t index{0}; index != files.size(); ++index) {
+      auto const& file = files[index];
+      switch (index % 5) {
+        case 0: add(); break;
+        case 1: changed.bytes += write_file(file); break;
+        case 2: fs::remove(file); break;
+        case 3: {
+          auto renamed = file;
+          renamed.replace_filename("renamed_" + file.filename().string());
+          fs::rename(file, renamed);
+          break;
+        }
+        case 4: fs::permissions(file, fs::perms::group_write, fs::perm_options::add); break;
+      }
+    }
+    changed.files = files.size();
+    return changed;
+  }
+
+ private:
+  auto add_directories(fs::path const& directory, std::size_t level) -> void {
+    fs::create_directories(directory);
+    directories_.push_back(directory);
+    if (level == options_.depth) { return; }
+
+    for (std::size_t child{0}; child != options_.fan_out; ++child) {
+      add_directories(directory / std::format("dir_{}_{}", level, child), level + 1);
+    }
+  }
+
+  auto file_size() -> std::uintmax_t {
+    // log-normal sizes, median 4 KiB and 8 MiB
+    std::lognormal_distribution<double> small{std::log(4096.0), 1.0};
+    std::lognormal_distribution<double> large{std::log(8.0 * 1024 * 1024), 0.5};
+    std::bernoulli_distribution pick_large{options_.profile == tree_profile::large ? 1.0
+                                         : options_.profile == tree_profile::mixed ? 0.05 : 0.0};
+
+    auto const size = pick_large(random_) ? std::clamp(large(random_), 1024.0 * 1024, 64.0 * 1024 * 1024)
+                                          : std::clamp(small(random_), 0.0, 256.0 * 1024);
+    return static_cast<std::uintmax_t>(size);
+  }
+
+  auto write_file(fs::path const& path) -> std::uintmax_t {
+    auto const size = file_size();
+    if (buffer_.size() < size) {
+      buffer_.resize(size);
+      rng::generate(buffer_, [&] { return static_cast<char>(random_()); });
+    }
+
+    // a random offset gives every file other content
+    auto const offset = buffer_.size() > size ? random_() % (buffer_.size() - size) : 0;
+    std::ofstream file{path, std::ios::binary | std::ios::trunc};
+    file.write(buffer_.data() + offset, static_cast<std::streamsize>(size));
+    return size;
+  }
+
+  static auto file_name(std::size_t number) -> std::string {
+    constexpr std::string_view extensions[]{".txt", ".cpp", ".jpg", ".pdf", ".json", ".md", ".png", ".bin"};
+    return std::format("file_{}{}", number, extensions[number % std::size(extensions)]);
+  }
+
+  static auto regular_files(fs::path const& root) -> std::vector<fs::path> {
+    std::vector<fs::path> files{};
+    for (auto const& entry : fs::recursive_directory_iterator{root}) {
+      if (entry.is_regular_file()) { files.push_back(entry.path()); }
+    }
+    rng::sort(files);
+    return files;
+  }
+
+  options const& options_;
+  std::mt19937_64 random_;
+  std::vector<fs::path> directories_{};
+  std::vector<char> buffer_{};
+  std::size_t next_file_{0};
+};
+
+auto read_io_counters(pid_t pid) -> io_counters {
+  std::ifstream file{std::format("/proc/{}/io", pid)};
+  io_counters counters{};
+  for (std::string key{}; file >> key;) {
+    std::uint64_t value{0};
+    file >> value;
+    if (key == "syscr:") { counters.read_calls = value; }
+    else if (key == "syscw:") { counters.write_calls = value; }
+  }
+  return counters;
+}
+
+auto syscalls_between(io_counters const& before, io_counters const& after) -> std::uint64_t {
+  return (after.read_calls - before.read_calls) + (after.write_calls - before.write_calls);
+}
+
+// VmHWM after resetting it, so every step reports its own peak
+auto reset_peak_rss() -> void {
+  std::ofstream{"/proc/self/clear_refs"} << "5";
+}
+
+auto peak_rss_kib() -> long {
+  std::ifstream file{"/proc/self/status"};
+  for (std::string line{}; std::getline(file, line);) {
+    if (line.starts_with("VmHWM:")) { return std::stol(line.substr(6)); }
+  }
+  return 0;
+}
+
+// Runs the baseline tools. A forked process inherits the peak RSS of its
+// parent, and wait4 reports it even after exec, so the tools are started
+// from a launcher forked at startup, before the benchmark grows. The
+// syscalls of a tool are read from /proc before it is reaped.
+class tool_launcher {
+ public:
+  struct result {
+    bool succeeded{false};
+    double seconds{0};
+    std::uint64_t syscalls{0};
+    long peak_rss_kib{0};
+  };
+
+  tool_launcher() {
+    int requests[2]{-1, -1};
+    int results[2]{-1, -1};
+    if (::pipe(requests) == -1 || ::pipe(results) == -1) { throw std::runtime_error{"tool_launcher: pipe"}; }
+
+    pid_ = ::fork();
+    if (pid_ == -1) { throw std::runtime_error{"tool_launcher: fork"}; }
+    if (pid_ == 0) {
+      ::close(requests[1]);
+      ::close(results[0]);
+      serve(requests[0], results[1]);
+    }
+
+    ::close(requests[0]);
+    ::close(results[1]);
+    requests_ = requests[1];
+    results_ = results[0];
+  }
+
+  ~tool_launcher() {
+    ::close(requests_);
+    ::close(results_);
+    ::waitpid(pid_, nullptr, 0);
+  }
+
+  tool_launcher(tool_launcher const&) = delete;
+  auto operator=(tool_launcher const&) -> tool_launcher& = delete;
+
+  // nothing if the tool is not installed or fails
+  auto run(std::vector<std::string> const& arguments) -> std::optional<result> {
+    std::string request{};
+    rng::for_each(arguments, [&](auto const& argument) { request.append(argument).push_back('\0'); });
+    auto const length = static_cast<std::uint32_t>(request.size());
+
+    result ran{};
+    if (!transfer(::write, requests_, &length, sizeof(length)) ||
+        !transfer(::write, requests_, request.data(), request.size()) ||
+        !transfer(::read, results_, &ran, sizeof(ran)) || !ran.succeeded) {
+      return std::nullopt;
+    }
+    return ran;
+  }
+
+ private:
+  template <typename io, typename buffer>
+  static auto transfer(io call, int descriptor, buffer* data, std::size_t size) -> bool {
+    auto* bytes = reinterpret_cast<std::conditional_t<std::is_const_v<buffer>, char const, char>*>(data);
+    while (size != 0) {
+      auto const done = call(descriptor, bytes, size);
+      if (done == -1 && errno == EINTR) { continue; }
+      if (done <= 0) { return false; }
+      bytes += done;
+      size -= static_cast<std::size_t>(done);
+    }
+    return true;
+  }
+
+  [[noreturn]] static auto serve(int requests, int results) -> void {
+    for (std::uint32_t length{0}; transfer(::read, requests, &length, sizeof(length));) {
+      std::string request(length, '\0');
+      if (!transfer(::read, requests, request.data(), request.size())) { break; }
+
+      auto const ran = launch(request);
+      if (!transfer(::write, results, &ran, sizeof(ran))) { break; }
+    }
+    ::_exit(EXIT_SUCCESS);
+  }
+
+  static auto launch(std::string& request) -> result {
+    std::vector<char*> argv{};
+    for (std::size_t offset{0}; offset < request.size(); offset = request.find('\0', offset) + 1) {
+      argv.push_back(request.data() + offset);
+    }
+    argv.push_back(nullptr);
+
+    auto const started = chr::steady_clock::now();
+    auto const pid = ::fork();
+    if (pid == -1) { return {}; }
+    if (pid == 0) {
+      ::execvp(argv[0], argv.data());
+      ::_exit(127);
+    }
+
+    siginfo_t info{};
+    ::waitid(P_PID, static_cast<id_t>(pid), &info, WEXITED | WNOWAIT);
+    auto const elapsed = chr::steady_clock::now() - started;
+    auto const counters = read_io_counters(pid);
+
+    int status{0};
+    rusage usage{};
+    ::wait4(pid, &status, 0, &usage);
+
+    return {WIFEXITED(status) && WEXITSTATUS(status) == 0, chr::duration<double>{elapsed}.count(),
+            syscalls_between({}, counters), usage.ru_maxrss};
+  }
+
+  pid_t pid_{-1};
+  int requests_{-1};
+  int results_{-1};
+};
+
+auto run_tool(tool_launcher& launcher, std::vector<std::string> const& arguments, workload const& work,
+              std::string mode, std::string step) -> std::optional<measurement> {
+  ::sync();
+  auto const ran = launcher.run(arguments);
+  if (!ran) { return std::nullopt; }
+
+  return measurement{arguments.front(), std::move(mode), std::move(step), work.files, work.bytes,
+                     ran->seconds, ran->syscalls, ran->peak_rss_kib};
+}
+
+auto time_sync(dc::drop_clone& clone, workload const& work, std::string mode, std::string step) -> measurement {
+  ::sync();
+  reset_peak_rss();
+  auto const before = read_io_counters(::getpid());
+  auto const started = chr::steady_clock::now();
+
+  clone.sync();
+  spdlog::get("sync")->flush();
+
+  auto const elapsed = chr::steady_clock::now() - started;
+  return measurement{"dropclone", std::move(mode), std::move(step), work.files, work.bytes,
+                     chr::duration<double>{elapsed}.count(),
+                     syscalls_between(before, read_io_counters(::getpid())), peak_rss_kib()};
+}
+
+auto write_config(fs::path const& directory, std::string const& mode) -> fs::path {
+  nlohmann::json config{
+    {"clone_config", nlohmann::json::array({{
+      {"source_directory", (directory / "source").string()},
+      {"destination_directory", (directory / "destination").string()},
+      {"mode", mode}
+    }})},
+    {"log_directory", (directory / "log").string()}
+  };
+  auto const path = directory / "config.json";
+  std::ofstream{path} << config.dump(2);
+  return path;
+}
+
+auto run_mode(options const& options, std::string const& mode, tool_launcher& launcher,
+              std::vector<measurement>& results) -> void {
+  auto const directory = options.work / mode;
+  auto const source = directory / "source";
+  fs::remove_all(directory);
+  fs::create_directories(directory);
+
+  tree_generator generator{options};
+  auto work = generator.generate(source);
+  auto const is_move = mode == "move";
+
+  // baselines on a pristine copy of the tree, before 'move' empties it
+  if (auto copied = run_tool(launcher, {"cp", "-a", source.string(), (directory / "cp").string()}, work, mode, "initial")) {
+    results.push_back(std::move(*copied));
+  }
+  auto const rsync = [&](std::string step) {
+    return run_tool(launcher, {"rsync", "-a", "--delete", source.string() + "/", (directory / "rsync").string() + "/"},
+                    work, mode, std::move(step));
+  };
+  if (!is_move) {
+    if (auto synced = rsync("initial")) { results.push_back(std::move(*synced)); }
+  }
+
+  // the loggers of a previous mode are still registered with spdlog
+  spdlog::drop_all();
+  dc::drop_clone clone{write_config(directory, mode), dc::nlohmann_json_parser{}};
+  results.push_back(time_sync(clone, work, mode, "initial"));
+
+  for (std::size_t round{1}; round <= options.rounds; ++round) {
+    work = generator.mutate(source, is_move);
+    auto const step = std::format("round_{}", round);
+
+    results.push_back(time_sync(clone, work, mode, step));
+    if (!is_move) {
+      if (auto synced = rsync(step)) { results.push_back(std::move(*synced)); }
+    }
+  }
+}
+
+auto split(std::string_view list) -> std::vector<std::string> {
+  std::vector<std::string> items{};
+  while (!list.empty()) {
+    auto const comma = list.find(',');
+    items.emplace_back(list.substr(0, comma));
+    list.remove_prefix(comma == std::string_view::npos ? list.size() : comma + 1);
+  }
+  return items;
+}
+
+auto parse_options(int argc, char const* argv[]) -> options {
+  options parsed{};
+  for (int index{1}; index < argc; ++index) {
+    std::string_view const argument{argv[index]};
+    std::string const value{argument.substr(argument.find('=') + 1)};
+
+    if (argument.starts_with("--work=")) { parsed.work = value; }
+    else if (argument.starts_with("--files=")) { parsed.files = std::stoull(value); }
+    else if (argument.starts_with("--depth=")) { parsed.depth = std::stoull(value); }
+    else if (argument.starts_with("--fan-out=")) { parsed.fan_out = std::max<std::size_t>(std::stoull(value), 1); }
+    else if (argument.starts_with("--rounds=")) { parsed.rounds = std::stoull(value); }
+    else if (argument.starts_with("--mutations=")) { parsed.mutations = std::clamp(std::stod(value), 0.0, 1.0); }
+    else if (argument.starts_with("--seed=")) { parsed.seed = std::stoull(value); }
+    else if (argument.starts_with("--json=")) { parsed.json = value; }
+    else if (argument.starts_with("--modes=")) {
+      parsed.modes = split(value);
+      if (!rng::all_of(parsed.modes, [](auto const& mode) { return mode == "copy" || mode == "move"; })) {
+        throw std::invalid_argument{std::string{argument}};
+      }
+    } else if (argument.starts_with("--profile=")) {
+      if (value == "small") { parsed.profile = tree_profile::small; }
+      else if (value == "large") { parsed.profile = tree_profile::large; }
+      else if (value == "mixed") { parsed.profile = tree_profile::mixed; }
+      else { throw std::invalid_argument{std::string{argument}}; }
+    } else { throw std::invalid_argument{std::string{argument}}; }
+  }
+  return parsed;
+}
+
+auto report(options const& options, std::vector<measurement> const& results) -> void {
+  nlohmann::json json{};
+  json["context"] = {
+    {"profile", profile_name(options.profile)},
+    {"files", options.files},
+    {"depth", options.depth},
+    {"fan_out", options.fan_out},
+    {"rounds", options.rounds},
+    {"mutations", options.mutations},
+    {"seed", options.seed}
+  };
+  json["results"] = nlohmann::json::array();
+
+  std::cout << std::format("{:<10} {:<5} {:<9} {:>8} {:>12} {:>10} {:>10} {:>14} {:>12}\n",
+    "tool", "mode", "step", "files", "bytes", "seconds", "files/s", "syscalls/file", "peak RSS KiB");
+
+  rng::for_each(results, [&](auto const& result) {
+    auto const files_per_second = result.seconds > 0 ? static_cast<double>(result.files) / result.seconds : 0;
+    auto const mib_per_second = result.seconds > 0 ? static_cast<double>(result.bytes) / (1024.0 * 1024) / result.seconds : 0;
+    auto const syscalls_per_file = result.syscalls && result.files != 0
+      ? static_cast<double>(*result.syscalls) / static_cast<double>(result.files) : 0;
+
+    std::cout << std::format("{:<10} {:<5} {:<9} {:>8} {:>12} {:>10.3f} {:>10.0f} {:>14.1f} {:>12}  ({:.1f} MiB/s)\n",
+      result.tool, result.mode, result.step, result.files, result.bytes, result.seconds,
+      files_per_second, syscalls_per_file, result.peak_rss_kib, mib_per_second);
+
+    json["results"].push_back({
+      {"tool", result.tool},
+      {"mode", result.mode},
+      {"step", result.step},
+      {"files", result.files},
+      {"bytes", result.bytes},
+      {"seconds", result.seconds},
+      {"files_per_second", files_per_second},
+      {"mib_per_second", mib_per_second},
+      {"syscalls", result.syscalls ? nlohmann::json(*result.syscalls) : nlohmann::json(nullptr)},
+      {"syscalls_per_file", syscalls_per_file},
+      {"peak_rss_kib", result.peak_rss_kib}
+    });
+  });
+
+  std::ofstream{options.json} << json.dump(2) << '\n';
+}
+
+} // namespace
+
+auto main(int argc, char const* argv[]) -> int {
+  try {
+    tool_launcher launcher{};
+    auto const options = parse_options(argc, argv);
+    std::vector<measurement> results{};
+    rng::for_each(options.modes, [&](auto const& mode) { run_mode(options, mode, launcher, results); });
+    report(options, results);
+    fs::remove_all(options.work);
+  } catch (std::invalid_argument const& e) {
+    std::cerr << "invalid argument: " << e.what() << '\n';
+    return EXIT_FAILURE;
+  } catch (dc::exception const& e) {
+    std::cerr << e.what() << '\n';
+    return EXIT_FAILURE;
+  } catch (fs::filesystem_error const& e) {
+    std::cerr << e.what() << '\n';
+    return EXIT_FAILURE;
+  } catch (std::runtime_error const& e) {
+    std::cerr << e.what() << '\n';
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
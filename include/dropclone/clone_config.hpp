@@ -1,12 +1,17 @@
 #pragma once
 
+#include <dropclone/path_matcher.hpp>
+#include <dropclone/durability.hpp>
 #include <nlohmann/json.hpp>
 #include <filesystem>
 #include <functional>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
-#include <regex>
+#include <cstddef>
+#include <cstdint>
+#include <chrono>
 
 namespace dropclone {
 
@@ -20,8 +25,63 @@ NLOHMANN_JSON_SERIALIZE_ENUM(clone_mode, {
   {clone_mode::move, "move"}
 })
 
+// How files that changed in the source reach an existing destination file:
+// 'copy' recopies them and swaps them in, 'delta' rewrites only the
+// changed blocks in place (copy mode, files of at least delta_min_size).
+enum class update_mode { copy, delta, undefined };
+
+NLOHMANN_JSON_SERIALIZE_ENUM(update_mode, {
+  {update_mode::undefined, "undefined"},
+  {update_mode::copy, "copy"},
+  {update_mode::delta, "delta"}
+})
+
+// How a file is found to differ from its destination (copy mode only):
+// 'metadata' trusts mtime, size and permissions; 'metadata_then_hash'
+// recopies a file with changed metadata only if its content digest differs
+// from the destination's; 'hash' also compares the digests of files whose
+// metadata did not change, on every full scan.
+enum class compare_strategy { metadata, metadata_then_hash, hash, undefined };
+
+NLOHMANN_JSON_SERIALIZE_ENUM(compare_strategy, {
+  {compare_strategy::undefined, "undefined"},
+  {compare_strategy::metadata, "metadata"},
+  {compare_strategy::metadata_then_hash, "metadata_then_hash"},
+  {compare_strategy::hash, "hash"}
+})
+
+NLOHMANN_JSON_SERIALIZE_ENUM(durability_mode, {
+  {durability_mode::undefined, "undefined"},
+  {durability_mode::none, "none"},
+  {durability_mode::per_file, "per_file"},
+  {durability_mode::per_directory, "per_directory"},
+  {durability_mode::per_transaction, "per_transaction"}
+})
+
+// How file operations of the sync log are written: 'text' formats a line
+// for each; 'binary' records them in a ring file that dropclone-logdump
+// turns back into text. Summaries and errors are always logged as text.
+enum class log_format { text, binary, undefined };
+
+NLOHMANN_JSON_SERIALIZE_ENUM(log_format, {
+  {log_format::undefined, "undefined"},
+  {log_format::text, "text"},
+  {log_format::binary, "binary"}
+})
+
+// How often an entry is scanned: 'fixed' every sync_interval; 'adaptive'
+// every sync_interval after a cycle that found changes, doubling the
+// interval after each idle cycle up to max_sync_interval.
+enum class interval_mode { fixed, adaptive, undefined };
+
+NLOHMANN_JSON_SERIALIZE_ENUM(interval_mode, {
+  {interval_mode::undefined, "undefined"},
+  {interval_mode::fixed, "fixed"},
+  {interval_mode::adaptive, "adaptive"}
+})
+
 struct config_entry {
-  using patterns_type = std::vector<std::regex>;
+  using patterns_type = path_matcher;
   using raw_patterns_type = std::vector<std::string>;
 
   config_entry(fs::path source_directory, fs::path destination_directory);
@@ -32,14 +92,31 @@ struct config_entry {
   fs::path source_directory{};
   fs::path destination_directory{};
   clone_mode mode{};
+  // the exclude patterns that, once they match a directory, match everything
+  // below it as well; scans do not descend into such directories
+  patterns_type prune_patterns{};
   patterns_type exclude_patterns{};
   patterns_type include_patterns{};
+  std::size_t scan_threads{1};
+  std::size_t copy_workers{1};
+  bool watch{false};
+  bool io_uring{false}; // only with DROPCLONE_ENABLE_IO_URING
+  dropclone::update_mode update_mode{dropclone::update_mode::copy};
+  std::uintmax_t delta_min_size{1024 * 1024}; // bytes
+  compare_strategy compare{compare_strategy::metadata};
+  durability_mode durability{durability_mode::none};
+  std::chrono::seconds sync_budget{0}; // 0: no limit per sync cycle
+  std::chrono::milliseconds sync_interval{30'000};
+  std::chrono::milliseconds max_sync_interval{0}; // 0: 16 times sync_interval
+  dropclone::interval_mode interval_mode{dropclone::interval_mode::fixed};
 
   // bidirectional_sync {true, false} // comming soon
   auto sanitize() -> void;
   auto filter(fs::path const&) -> bool;
+  auto prune(fs::path const& directory) -> bool;
 
   static auto compile_patterns(raw_patterns_type& raw_patterns) -> patterns_type;
+  static auto is_prefix_stable(std::string_view pattern) -> bool;
 };
 
 class clone_config {
@@ -47,6 +124,9 @@ class clone_config {
   std::vector<config_entry> entries{};
   fs::path config_path{};
   fs::path log_directory{};
+  fs::path index_directory{};
+  std::size_t max_concurrent_syncs{1};
+  log_format sync_log_format{log_format::text};
 
   auto sanitize(fs::path const&) -> void;
   auto validate() -> void; 
@@ -2,6 +2,17 @@
 
 #include <dropclone/clone_config.hpp>
 #include <dropclone/path_snapshot.hpp>
+#include <dropclone/snapshot_index.hpp>
+#include <dropclone/path_watcher.hpp>
+#include <dropclone/copy_engine.hpp>
+#include <dropclone/content_hash.hpp>
+#include <dropclone/trash_purger.hpp>
+#include <dropclone/transaction_journal.hpp>
+#include <dropclone/durability.hpp>
+#include <dropclone/sync_metrics.hpp>
+#include <memory>
+#include <chrono>
+#include <cstddef>
 
 namespace dropclone {
 
@@ -9,17 +20,58 @@ namespace fs = std::filesystem;
 
 class clone_manager {
  public:
-  clone_manager(config_entry entry);
+  clone_manager(config_entry entry, fs::path const& index_directory);
+  clone_manager(clone_manager&&) = default;
+  auto operator=(clone_manager&&) -> clone_manager& = default;
+  // stores the index if watch cycles changed it since it was last stored
+  ~clone_manager();
 
-  auto sync() -> void;
+  // true if the source changed since the previous cycle
+  auto sync() -> bool;
+  auto watch_descriptor() const noexcept -> int;
   auto copy(path_snapshot const& source_snapshot, fs::path const& destination_root) -> void;
   auto remove(path_snapshot const& source_snapshot, fs::path const& destination_root) -> void;
   auto move(path_snapshot const& source_snapshot, fs::path const& destination_root) -> void;
+  auto metrics() noexcept -> sync_metrics&;
 
  private:
+  // a synchronization that ran out of its time budget is incomplete;
+  // 'applied' then lists the paths that were synchronized before yielding
+  struct sync_result {
+    bool complete{true};
+    path_changes applied{};
+  };
+
+  auto recover_transactions() -> void;
+  auto store_index() -> void;
+  auto store_index_when_due() -> void;
+  auto sync_changes(path_changes const& changes) -> bool;
+  auto log_pruned(path_snapshot const& snapshot) const -> void;
+  auto synchronize(path_snapshot& previous_snapshot, path_snapshot& current_snapshot) -> sync_result;
+  auto synchronize_in_chunks(path_snapshot const& diff_snapshot) -> sync_result;
+  auto log_copy_statistics() const -> void;
+  auto record_metrics() -> void;
+  auto observe_commit_lag(path_snapshot const& source_snapshot) -> void;
+  auto verify_content(path_snapshot& diff_snapshot, path_snapshot const& current_snapshot) -> void;
+
   path_snapshot source_snapshot_;
   path_snapshot destination_snapshot_;
   config_entry entry_;
+  snapshot_index index_;
+  std::unique_ptr<path_watcher> watcher_{};
+  std::unique_ptr<copy_statistics> statistics_{std::make_unique<copy_statistics>()};
+  std::unique_ptr<hash_cache> hashes_{}; // only if digests are compared
+  std::unique_ptr<trash_purger> purger_{std::make_unique<trash_purger>(entry_.copy_workers)};
+  std::unique_ptr<transaction_journal> journal_{}; // next to the index
+  std::unique_ptr<durability_tracker> durability_{
+    std::make_unique<durability_tracker>(entry_.durability, entry_.copy_workers)
+  };
+  std::unique_ptr<sync_metrics> metrics_{std::make_unique<sync_metrics>()};
+  bool rescan_required_{true};
+  // changes of watch cycles that the stored index does not cover yet; the
+  // journal keeps their steps until it does
+  std::size_t unstored_changes_{0};
+  std::chrono::steady_clock::time_point index_stored_{std::chrono::steady_clock::now()};
 };
 
 } // namespace dropclone
\ No newline at end of file
@@ -1,6 +1,11 @@
 #pragma once
 
 #include <dropclone/path_snapshot.hpp>
+#include <dropclone/copy_engine.hpp>
+#include <dropclone/trash_purger.hpp>
+#include <dropclone/transaction_journal.hpp>
+#include <dropclone/durability.hpp>
+#include <dropclone/sync_metrics.hpp>
 #include <concepts>
 #include <variant>
 #include <stack>
@@ -8,6 +13,7 @@
 #include <utility>
 #include <string_view>
 #include <cstdint>
+#include <cstddef>
 #include <functional>
 
 namespace dropclone {
@@ -22,11 +28,35 @@ concept is_clone_command = requires (command_type command) {
 
 enum class command_status {uninitialized, success, failure};
 
+// Files of a command are processed by up to 'workers' threads; directories
+// are always created and removed in order on the calling thread. Copies are
+// counted per copy method in 'statistics' if given. With 'io_uring' (and a 
+// build with DROPCLONE_ENABLE_IO_URING) files and directories are submitted
+// as batches on the calling thread's io_uring instead; 'workers' is ignored
+// then, and plain fs calls remain the fallback if io_uring is unavailable.
+// Trash of committed removals is handed to 'purger' if given and purged
+// right away otherwise. With a 'journal', every file step of execute() is
+// recorded before it runs and again once it wrote its destination, or as
+// abandoned if it kept an existing one; undo steps are not recorded. Every
+// file written gets reported to 'durability' once it holds its final
+// content. With 'metrics', execute() and undo() of a command are timed.
+struct command_options {
+  std::size_t workers{1};
+  copy_statistics* statistics{nullptr};
+  bool io_uring{false};
+  trash_purger* purger{nullptr};
+  transaction_journal* journal{nullptr};
+  durability_tracker* durability{nullptr};
+  sync_metrics* metrics{nullptr};
+};
+
 class clone_transaction;
 
 class command_base {
  protected:
-  command_base(path_snapshot snapshot) : snapshot_{std::move(snapshot)} {}
+  command_base(path_snapshot snapshot, command_options options = {}) 
+    : snapshot_{std::move(snapshot)}, options_{options} 
+  {}
 
   auto execute(std::string_view command_name, std::string_view errorcode,
                std::function<void(void)> execute) -> void;
@@ -34,6 +64,7 @@ class command_base {
                std::function<void(void)> undo) -> void;
 
   path_snapshot snapshot_;
+  command_options options_;
   command_status execute_status_{command_status::uninitialized};
   command_status undo_status_{command_status::uninitialized};
 
@@ -48,8 +79,9 @@ enum class behavior_policies { none, duplicate };
 
 class copy_command : public command_base {
  public:
-  copy_command(path_snapshot snapshot, fs::path destination_root, behavior_policies behavior_policy = {}) 
-    : command_base{std::move(snapshot)}, destination_root_{std::move(destination_root)},
+  copy_command(path_snapshot snapshot, fs::path destination_root, 
+               behavior_policies behavior_policy = {}, command_options options = {}) 
+    : command_base{std::move(snapshot), options}, destination_root_{std::move(destination_root)},
       behavior_policy_{behavior_policy}
   {}
 
@@ -59,12 +91,15 @@ class copy_command : public command_base {
  private:
   fs::path destination_root_;
   behavior_policies behavior_policy_;
+  // files actually written below destination_root_, keyed by their
+  // destination path; undo removes exactly these
+  path_snapshot::snapshot_entries copied_{};
 };
 
 class rename_command : public command_base {
  public:
-  rename_command(path_snapshot snapshot, fs::path destination_root) 
-    : command_base{std::move(snapshot)}, 
+  rename_command(path_snapshot snapshot, fs::path destination_root, command_options options = {}) 
+    : command_base{std::move(snapshot), options}, 
       destination_root_{std::move(destination_root)} 
   {}
 
@@ -73,34 +108,131 @@ class rename_command : public command_base {
 
  private:
   fs::path destination_root_;
+  // files actually moved to destination_root_; undo renames exactly these back
+  path_snapshot::snapshot_entries renamed_{};
 };
 
+// Moves the files to remove into a trash directory below the snapshot root
+// with rename, so undo is a reverse rename. The trash is purged once the
+// transaction commits.
 class remove_command : public command_base {
  public:
-  remove_command(path_snapshot snapshot)
-    : command_base{std::move(snapshot)} 
+  remove_command(path_snapshot snapshot, command_options options = {})
+    : command_base{std::move(snapshot), options} 
+  {}
+
+  auto execute() -> void;
+  auto undo() -> void;
+  auto commit() -> void;
+
+ private:
+  fs::path trash_path_{};
+  // files actually moved into trash_path_
+  path_snapshot::snapshot_entries trashed_{};
+};
+
+// Rewrites existing destination files in place with delta_update. The
+// journals live in destination_root/.delta until the transaction commits;
+// undo restores every rewritten file from its journal.
+class delta_command : public command_base {
+ public:
+  delta_command(path_snapshot snapshot, fs::path destination_root, command_options options = {}) 
+    : command_base{std::move(snapshot), options}, 
+      destination_root_{std::move(destination_root)} 
+  {}
+
+  auto execute() -> void;
+  auto undo() -> void;
+  auto commit() -> void;
+
+  static auto journal_root(fs::path const& destination_root) -> fs::path;
+
+ private:
+  fs::path destination_root_;
+  // files actually rewritten below destination_root_
+  path_snapshot::snapshot_entries updated_{};
+};
+
+// Replaces existing destination files without a second copy: the new
+// content is written to a temporary file next to the destination and
+// swapped in with renameat2(RENAME_EXCHANGE), which leaves the old content
+// under the temporary name. Undo is a single rename back; commit removes
+// the old content. Where the file system cannot exchange, the swap falls
+// back to plain renames through a parked copy of the new content.
+class update_command : public command_base {
+ public:
+  update_command(path_snapshot snapshot, fs::path destination_root, command_options options = {}) 
+    : command_base{std::move(snapshot), options}, 
+      destination_root_{std::move(destination_root)} 
   {}
 
   auto execute() -> void;
   auto undo() -> void;
+  auto commit() -> void;
+
+  static auto temporary_path(fs::path const& destination_path) -> fs::path;
+  // where swap_by_name parks the new content between its renames
+  static auto parked_path(fs::path const& destination_path) -> fs::path;
+
+  // The fallback swap: parks the new content, moves the old content to the
+  // temporary name and the parked content into place. A failing rename puts
+  // the files back as they were.
+  static auto swap_by_name(fs::path const& temporary_path, fs::path const& to_path) -> void;
+
+  // Clears up after a swap that may have stopped anywhere, e.g. in a crash:
+  // a missing destination gets the parked content back, or else the
+  // temporary file; whatever is left of both is removed. True if anything
+  // was left.
+  static auto clean_up(fs::path const& destination_path) -> bool;
+
+ private:
+  fs::path destination_root_;
+  // files actually swapped below destination_root_
+  path_snapshot::snapshot_entries updated_{};
 };
 
 static_assert(is_clone_command<copy_command>);
 static_assert(is_clone_command<rename_command>);
 static_assert(is_clone_command<remove_command>);
-
-using clone_command = std::variant<copy_command, rename_command, remove_command>;
-
+static_assert(is_clone_command<delta_command>);
+static_assert(is_clone_command<update_command>);
+
+using clone_command = std::variant<copy_command, rename_command, remove_command, 
+                                   delta_command, update_command>;
+
+// With a journal, a transaction that rolled back completely drops the
+// journal records it added; the records of a committed transaction stay
+// until the caller resets the journal. With a durability tracker, the
+// journal and then what the commands wrote are flushed before the
+// transaction commits; a failing flush rolls the transaction back. In
+// per_file mode the journal is also synced after every record of a step
+// that is about to run. With metrics, rollbacks are counted
+// and timed.
 class clone_transaction {
  public:
+  explicit clone_transaction(transaction_journal* journal = nullptr, 
+                             durability_tracker* durability = nullptr,
+                             sync_metrics* metrics = nullptr) 
+    : journal_{journal}, durability_{durability}, metrics_{metrics} 
+  {}
+
   inline auto add(clone_command command) -> void;
   auto start() -> void;
 
  private:
+  transaction_journal* journal_;
+  durability_tracker* durability_;
+  sync_metrics* metrics_;
+  std::uint64_t journal_mark_{0};
   std::vector<clone_command> commands_{};
   std::stack<clone_command> processed_commands_{};
 
   auto try_undo(clone_command command, std::uint8_t max_retries) -> void;
+  // lets commands that keep undo data beyond execute() (remove_command,
+  // delta_command, update_command) drop
+  // it once every command of the transaction succeeded
+  auto commit() -> void;
+  auto make_durable() -> void;
   auto log_unrecovered_entries() -> void;
   auto reset_command_statuses() -> void;
   auto rollback() -> void;
@@ -119,30 +251,43 @@ auto remove_directory(fs::path const& directory_path) -> void;
 
 auto create_directories(path_snapshot::snapshot_directories& directories, 
                         fs::path const& destination_root,
-                        bool extract_on_success = false) -> void;
+                        bool extract_on_success = false,
+                        command_options const& command_options = {}) -> void;
 
 auto remove_directories(path_snapshot::snapshot_directories& directories,
                         fs::path const& source_root,
-                        bool extract_on_success = false) -> void;
+                        bool extract_on_success = false,
+                        command_options const& command_options = {}) -> void;
         
+// The file functions record every file they processed in 'processed' (if
+// given) – also when they fail part way – so callers know exactly which
+// files were touched.
 auto copy_files(path_snapshot::snapshot_entries& files, 
                 fs::path const& source_root, 
                 fs::path const& destination_root,
                 bool extract_on_success = false, 
-                fs::copy_options options = {}) -> void;
+                fs::copy_options options = {},
+                command_options const& command_options = {},
+                path_snapshot::snapshot_entries* processed = nullptr) -> void;
 
 auto copy_duplicate(path_snapshot::snapshot_entries& files, 
                 fs::path const& source_root, 
-                fs::path const& destination_root) -> void;
+                fs::path const& destination_root,
+                command_options const& command_options = {},
+                path_snapshot::snapshot_entries* processed = nullptr) -> void;
 
 auto rename_files(path_snapshot::snapshot_entries& files, 
                   fs::path const& source_root, 
                   fs::path const& destination_root,
-                  bool extract_on_success = false) -> void;
+                  bool extract_on_success = false,
+                  command_options const& command_options = {},
+                  path_snapshot::snapshot_entries* processed = nullptr) -> void;
 
 auto remove_files(path_snapshot::snapshot_entries& files, 
                   fs::path const& source_root,
-                  bool extract_on_success = false) -> void;
+                  bool extract_on_success = false,
+                  command_options const& command_options = {},
+                  path_snapshot::snapshot_entries* processed = nullptr) -> void;
 
 } // namespace dropclone
 
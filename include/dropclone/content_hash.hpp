@@ -0,0 +1,85 @@
+#pragma once
+
+#include <xxhash.h>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+
+namespace dropclone {
+
+namespace fs = std::filesystem;
+
+// Streaming XXH3 (64-bit) from xxHash, which picks the widest SIMD path the
+// target supports.
+class xxh3 {
+ public:
+  xxh3();
+
+  auto update(void const* data, std::size_t size) noexcept -> void;
+  auto digest() const noexcept -> std::uint64_t;
+
+ private:
+  struct state_deleter {
+    auto operator()(XXH3_state_t* state) const noexcept -> void;
+  };
+
+  std::unique_ptr<XXH3_state_t, state_deleter> state_;
+};
+
+// Content digest of a file, read through a sequential buffer.
+auto file_digest(fs::path const& path) -> std::uint64_t;
+
+// Remembers file digests by (device, inode, size, mtime, ctime), so a file
+// that was not touched since it was hashed is never read again; a rewrite
+// that restores the mtime still changes the ctime. The cache is persisted
+// next to the snapshot index and may be used from several threads. Every
+// store() drops the files that were not looked up since the previous one, so
+// removed and replaced files do not pile up in the cache.
+//
+// layout (native byte order):
+//   header  | magic "DCHASHES" | version u32 | reserved u32 | entry_count u64
+//   entries | entry_count × { device u64 | inode u64 | size u64 | mtime i64 | ctime i64 | digest u64 }
+class hash_cache {
+ public:
+  static constexpr std::uint32_t version{2};
+
+  explicit hash_cache(fs::path cache_path);
+
+  // std::nullopt if 'path' is not a readable regular file
+  auto digest(fs::path const& path) -> std::optional<std::uint64_t>;
+
+  auto load() -> void;
+  auto store() -> bool;
+
+ private:
+  struct file_key {
+    std::uint64_t device{0};
+    std::uint64_t inode{0};
+    auto operator==(file_key const&) const -> bool = default;
+  };
+
+  struct file_key_hash {
+    auto operator()(file_key const& key) const noexcept -> std::size_t {
+      return std::hash<std::uint64_t>{}(key.inode ^ (key.device << 32 | key.device >> 32));
+    }
+  };
+
+  struct cached_digest {
+    std::uint64_t size{0};
+    std::int64_t modification_time{0};
+    std::int64_t change_time{0};
+    std::uint64_t digest{0};
+    bool looked_up{true};
+  };
+
+  fs::path cache_path_;
+  std::mutex mutex_{};
+  std::unordered_map<file_key, cached_digest, file_key_hash> digests_{};
+  bool modified_{false};
+};
+
+} // namespace dropclone
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <string_view>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+namespace dropclone {
+
+namespace fs = std::filesystem;
+
+// Kernel paths tried by clone_file, cheapest first. 'standard' marks files
+// that are not regular files (e.g. devices, fifos) and go through fs::copy;
+// 'io_uring' marks copies batched by the io_uring backend, 'delta' files
+// rewritten in place by delta_update (bytes: the rewritten bytes only).
+enum class copy_method { reflink, copy_file_range, sendfile, buffered, standard, io_uring, delta };
+
+inline constexpr std::size_t copy_method_count{7};
+
+inline auto to_string(copy_method method) -> std::string_view {
+  switch (method) {
+    case copy_method::reflink:          return "reflink";
+    case copy_method::copy_file_range:  return "copy_file_range";
+    case copy_method::sendfile:         return "sendfile";
+    case copy_method::buffered:         return "buffered";
+    case copy_method::standard:         return "standard";
+    case copy_method::io_uring:         return "io_uring";
+    case copy_method::delta:            return "delta";
+  }
+  return "unknown";
+}
+
+struct copy_result {
+  copy_method method{copy_method::buffered};
+  std::uintmax_t bytes{0};
+};
+
+// Copies 'from' to 'to' with the semantics of fs::copy for the given options:
+// an existing destination is an error unless overwrite_existing, 
+// update_existing or skip_existing is set. The destination gets the
+// permissions of the source. Returns std::nullopt if an existing destination
+// was kept; throws fs::filesystem_error on failure and removes a destination
+// it created itself.
+//
+// A reflink (FICLONE) shares the extents on copy-on-write filesystems (btrfs,
+// xfs) and costs a metadata update only; copy_file_range and sendfile keep 
+// the data inside the kernel; the buffered copy is the fallback for
+// filesystems that support none of them.
+auto clone_file(fs::path const& from, fs::path const& to, 
+                fs::copy_options options = fs::copy_options::none) -> std::optional<copy_result>;
+
+// Per-method file and byte counts, safe to update from several workers.
+class copy_statistics {
+ public:
+  auto record(copy_result const& result) noexcept -> void;
+  auto reset() noexcept -> void;
+
+  auto files(copy_method method) const noexcept -> std::uint64_t;
+  auto bytes(copy_method method) const noexcept -> std::uint64_t;
+  auto total_files() const noexcept -> std::uint64_t;
+  auto total_bytes() const noexcept -> std::uint64_t;
+
+ private:
+  std::array<std::atomic<std::uint64_t>, copy_method_count> files_{};
+  std::array<std::atomic<std::uint64_t>, copy_method_count> bytes_{};
+};
+
+} // namespace dropclone
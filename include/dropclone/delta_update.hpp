@@ -0,0 +1,45 @@
+#pragma once
+
+#include <filesystem>
+#include <cstdint>
+#include <cstddef>
+
+namespace dropclone {
+
+namespace fs = std::filesystem;
+
+// size of the blocks compared and rewritten by delta_update
+inline constexpr std::size_t delta_block_size{64 * 1024};
+
+struct delta_result {
+  std::uintmax_t blocks{0};
+  std::uintmax_t changed_blocks{0};
+  std::uintmax_t bytes_written{0};
+};
+
+// Makes the existing file 'to' equal to 'from' by rewriting only the blocks
+// that differ, truncating or extending it to the size of 'from', and gives
+// it the permissions of 'from'.
+//
+// Before 'to' is touched, the original content of every block that will be
+// overwritten or cut off is written to 'journal' and synced, together with
+// the original size and permissions. If the update fails part way, 'to' is
+// restored from the journal before the error is rethrown as
+// fs::filesystem_error; if even that fails, the journal is left behind for
+// delta_restore / recover_delta_journals. On success 'to' is synced and the
+// journal stays until the caller commits (removes) or undoes it.
+auto delta_update(fs::path const& from, fs::path const& to, fs::path const& journal) -> delta_result;
+
+// Writes the blocks recorded in 'journal' back into 'to', restores its
+// original size and permissions and removes the journal. A journal that was
+// never completed is just removed: 'to' had not been touched yet. Returns
+// whether blocks were written back.
+auto delta_restore(fs::path const& to, fs::path const& journal) -> bool;
+
+// Restores every file below 'destination_root' that has a journal below
+// 'journal_root' (same relative path) and removes 'journal_root'. Returns
+// the number of restored files. Used at startup, after a crash between a
+// delta update and the end of its transaction.
+auto recover_delta_journals(fs::path const& journal_root, fs::path const& destination_root) -> std::size_t;
+
+} // namespace dropclone
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <dropclone/path_snapshot.hpp>
+#include <dropclone/path_info.hpp>
+#include <filesystem>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <vector>
+#include <memory>
+#include <optional>
+#include <exception>
+#include <cstddef>
+#include <cstdint>
+
+namespace dropclone {
+
+namespace fs = std::filesystem;
+
+// Scans a directory tree with a pool of worker threads. Every worker owns a
+// deque of pending directories: it pops from the back of its own deque and,
+// when that runs dry, steals from the front of the other workers' deques.
+// Each worker collects its entries locally; the results are merged once all
+// workers are done, so the hot path never contends on a shared map. Idle
+// workers sleep until a directory is queued or the scan is over. A single
+// thread scans on the calling thread.
+//
+// A subdirectory that cannot be opened for lack of permission becomes an
+// access_denied conflict instead of an entry; the scan goes on. An entry
+// that is gone by the time its metadata is read is left out.
+class directory_scanner {
+ public:
+  struct scan_result {
+    path_snapshot::entry_list entries{};
+    path_snapshot::snapshot_entries conflicts{};
+    std::size_t pruned{0}; // directories not descended into
+  };
+
+  directory_scanner(fs::path root, path_snapshot::path_filter filter, std::size_t thread_count,
+                    path_snapshot::path_filter prune = {});
+
+  // scans the subtree below relative_directory; the entry paths stay
+  // relative to the root
+  auto scan(fs::path relative_directory = {}) -> scan_result;
+
+  // the metadata of a listed entry; none if it could not be read
+  static auto entry_info(fs::directory_entry const& dir_entry) -> std::optional<path_info>;
+
+ private:
+  struct work_queue {
+    std::mutex mutex{};
+    std::deque<fs::path> directories{};
+  };
+
+  auto push(std::size_t worker, fs::path relative_directory) -> void;
+  auto wake_all() -> void;
+  auto pop(std::size_t worker) -> std::optional<fs::path>;
+  auto steal(std::size_t worker) -> std::optional<fs::path>;
+  auto work(std::size_t worker, scan_result& result) -> void;
+  auto scan_directory(std::size_t worker, fs::path const& relative_directory,
+                      scan_result& result) -> void;
+
+  fs::path root_;
+  path_snapshot::path_filter filter_;
+  path_snapshot::path_filter prune_;
+  std::size_t thread_count_;
+  std::vector<std::unique_ptr<work_queue>> queues_{};
+  std::atomic<std::size_t> pending_{0};
+  // bumped whenever there may be something new for idle workers to do
+  std::atomic<std::uint64_t> generation_{0};
+  std::atomic_bool failed_{false};
+  std::once_flag failure_flag_{};
+  std::exception_ptr failure_{};
+};
+
+} // namespace dropclone
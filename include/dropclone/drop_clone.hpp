@@ -2,8 +2,12 @@
 
 #include <dropclone/clone_config.hpp>
 #include <dropclone/clone_manager.hpp>
+#include <dropclone/worker_pool.hpp>
+#include <dropclone/sync_scheduler.hpp>
 #include <filesystem>
 #include <vector>
+#include <chrono>
+#include <memory>
 
 namespace dropclone {
 
@@ -12,14 +16,26 @@ namespace fs = std::filesystem;
 class drop_clone {
  public:
   drop_clone(fs::path config_path, config_parser);
+  // syncs every entry now
   auto sync() -> void;
+  // syncs the entries whose interval has passed
+  auto sync_due() -> void;
+  // waits until the next entry is due, one of the watched entries changes
+  // or 'max_wait' passed, whichever comes first
+  auto wait_until_due(std::chrono::milliseconds max_wait) -> void;
 
  private:
   auto init_config_logger() -> void;
   auto init_sync_logger() -> void;
+  auto export_sync_metrics() -> void;
+  auto sync_entries(std::vector<std::size_t> const& indices) -> void;
 
   clone_config clone_config_;
   std::vector<clone_manager> managers_{};
+  // decayed sync time per manager; the least served managers start first
+  std::vector<std::chrono::duration<double>> usage_{};
+  std::unique_ptr<worker_pool> sync_pool_{};
+  std::unique_ptr<sync_scheduler> scheduler_{};
 };
   
 } // namespace dropclone
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <filesystem>
+#include <unordered_map>
+#include <unordered_set>
+#include <string>
+#include <mutex>
+#include <cstddef>
+
+namespace dropclone {
+
+namespace fs = std::filesystem;
+
+// Hands out free file names below a destination root the way copy_duplicate
+// names its copies: 'name.ext' if it is free, otherwise the first free
+// 'name_1.ext', 'name_2.ext', ... Each directory is listed once, on first
+// use; after that, names are reserved in memory and the next suffix per
+// base name is remembered, so a thousand 'scan.pdf' cost one listing
+// instead of a quadratic number of stat calls. Safe to use from several
+// workers.
+class duplicate_name_index {
+ public:
+  explicit duplicate_name_index(fs::path root);
+
+  // 'relative_path' and the result are relative to the root
+  auto allocate(fs::path const& relative_path) -> fs::path;
+
+ private:
+  struct directory_names {
+    std::unordered_set<std::string> taken{};
+    std::unordered_map<std::string, std::size_t> next_suffix{};
+  };
+
+  auto names_in(fs::path const& relative_directory) -> directory_names&;
+
+  fs::path root_;
+  std::mutex mutex_{};
+  std::unordered_map<std::string, directory_names> directories_{};
+};
+
+} // namespace dropclone
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <filesystem>
+#include <string_view>
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace dropclone {
+
+namespace fs = std::filesystem;
+
+// When written files are forced to stable storage: 'none' leaves it to the
+// kernel; 'per_file' fdatasyncs every file right after it was written;
+// 'per_directory' collects the files of a transaction and syncs them
+// directory by directory before it commits; 'per_transaction' issues one
+// syncfs per file system before it commits.
+enum class durability_mode { none, per_file, per_directory, per_transaction, undefined };
+
+auto to_string(durability_mode mode) noexcept -> std::string_view;
+
+// Makes the files written by commands durable according to its mode and
+// accounts the time spent doing so. written() may be called from any
+// number of threads; flush() runs on the thread committing the transaction.
+//
+// per_directory first starts writeback for every file of a directory
+// (sync_file_range), then waits for each of them and finally syncs the
+// directory itself, so the device sees one batch per directory instead of
+// one flush per file. Directories are synced on up to 'workers' threads.
+class durability_tracker {
+ public:
+  explicit durability_tracker(durability_mode mode, std::size_t workers = 1);
+
+  // 'path' now holds the final content of a written file
+  auto written(fs::path const& path) -> void;
+  auto flush() -> void;
+  // forgets the files written by a transaction that rolled back
+  auto discard() -> void;
+
+  inline auto mode() const noexcept -> durability_mode;
+  inline auto synced_files() const noexcept -> std::uint64_t;
+  inline auto sync_time() const noexcept -> std::chrono::nanoseconds;
+  // discards pending files and clears the counters
+  auto reset() -> void;
+
+ private:
+  auto record_time(std::chrono::steady_clock::time_point started, std::uint64_t files) noexcept -> void;
+
+  durability_mode mode_;
+  std::size_t workers_;
+  std::mutex mutex_{};
+  std::vector<fs::path> pending_{};
+  std::atomic<std::uint64_t> synced_files_{0};
+  std::atomic<std::int64_t> sync_nanoseconds_{0};
+};
+
+auto durability_tracker::mode() const noexcept -> durability_mode { return mode_; }
+auto durability_tracker::synced_files() const noexcept -> std::uint64_t {
+  return synced_files_.load(std::memory_order_relaxed);
+}
+auto durability_tracker::sync_time() const noexcept -> std::chrono::nanoseconds {
+  return std::chrono::nanoseconds{sync_nanoseconds_.load(std::memory_order_relaxed)};
+}
+
+} // namespace dropclone
@@ -17,6 +17,12 @@ struct config {
   static constexpr auto no_entries_defined        = "config_error.009";
   static constexpr auto invalid_field_type        = "config_error.010";
   static constexpr auto conflicting_fields        = "config_error.011";
+  static constexpr auto invalid_update_mode       = "config_error.012";
+  static constexpr auto invalid_compare_strategy  = "config_error.013";
+  static constexpr auto invalid_durability_mode   = "config_error.014";
+  static constexpr auto invalid_log_format        = "config_error.015";
+  static constexpr auto invalid_interval_mode     = "config_error.016";
+  static constexpr auto invalid_sync_interval     = "config_error.017";
   
   static inline std::unordered_map<std::string_view, std::string_view> const messages{
     {file_not_found, "cannot open config file: {}"},
@@ -29,7 +35,13 @@ struct config {
     {missing_required_field, "missing required field: '{}' in config file '{}'"},
     {no_entries_defined, "no entries defined in config file '{}'"},
     {invalid_field_type, "field '{}' has invalid type"},
-    {conflicting_fields, "configuration contains mutually exclusive fields: '{}' and '{}'"}
+    {conflicting_fields, "configuration contains mutually exclusive fields: '{}' and '{}'"},
+    {invalid_update_mode, "'{}' must be (copy or delta)"},
+    {invalid_compare_strategy, "'{}' must be (metadata, metadata_then_hash or hash)"},
+    {invalid_durability_mode, "'{}' must be (none, per_file, per_directory or per_transaction)"},
+    {invalid_log_format, "'{}' must be (text or binary)"},
+    {invalid_interval_mode, "'{}' must be (fixed or adaptive)"},
+    {invalid_sync_interval, "'{}' must be greater than zero and must not exceed 'max_sync_interval_ms'"}
   };
 };
 
@@ -43,15 +55,49 @@ struct filesystem {
   };
 };
 
+struct index {
+  static constexpr auto could_not_open_index  = "index_error.001";
+  static constexpr auto invalid_index         = "index_error.002";
+  static constexpr auto stale_index           = "index_error.003";
+  static constexpr auto could_not_write_index = "index_error.004";
+  static constexpr auto invalid_hash_cache    = "index_error.005";
+  static constexpr auto could_not_write_hash_cache = "index_error.006";
+
+  static inline std::unordered_map<std::string_view, std::string_view> const messages{
+    {could_not_open_index, "could not open snapshot index '{}' |\n↳ origin error:\n\t↳ {}"},
+    {invalid_index, "snapshot index '{}' is invalid ({}) – falling back to a full re-evaluation"},
+    {stale_index, "snapshot index '{}' belongs to '{}' – falling back to a full re-evaluation"},
+    {could_not_write_index, "could not write snapshot index '{}' |\n↳ origin error:\n\t↳ {}"},
+    {invalid_hash_cache, "hash cache '{}' is invalid ({}) – digests are recomputed"},
+    {could_not_write_hash_cache, "could not write hash cache '{}' |\n↳ origin error:\n\t↳ {}"}
+  };
+};
+
+struct watch {
+  static constexpr auto watch_failed = "watch_error.001";
+
+  static inline std::unordered_map<std::string_view, std::string_view> const messages{
+    {watch_failed, "could not watch '{}' – falling back to full rescans |\n↳ origin error:\n\t↳ {}"}
+  };
+};
+
 struct command {
   static constexpr auto copy_command_failed           = "command_error.001";
   static constexpr auto rename_command_failed         = "command_error.002";
   static constexpr auto remove_command_failed         = "command_error.003";
+  static constexpr auto delta_command_failed          = "command_error.004";
+  static constexpr auto delta_recovery_failed         = "command_error.005";
+  static constexpr auto update_command_failed         = "command_error.006";
+  static constexpr auto trash_purge_failed            = "command_error.007";
   
   static inline std::unordered_map<std::string_view, std::string_view> const messages{
     {copy_command_failed, "copy_command::{}: '{}' → '{}' failed |\n↳ origin error:\n\t↳ {}"},
     {rename_command_failed, "rename_command::{}: '{}' → '{}' failed |\n↳ origin error:\n\t↳ {}"},
-    {remove_command_failed, "remove_command::{}: '{}' failed |\n↳ origin error:\n\t↳ {}"}
+    {remove_command_failed, "remove_command::{}: '{}' failed |\n↳ origin error:\n\t↳ {}"},
+    {delta_command_failed, "delta_command::{}: '{}' → '{}' failed |\n↳ origin error:\n\t↳ {}"},
+    {delta_recovery_failed, "could not restore '{}' from its delta journals – they are kept |\n↳ origin error:\n\t↳ {}"},
+    {update_command_failed, "update_command::{}: '{}' → '{}' failed |\n↳ origin error:\n\t↳ {}"},
+    {trash_purge_failed, "could not purge trash '{}' – the rest of it is kept |\n↳ origin error:\n\t↳ {}"}
   };
 };
 
@@ -62,6 +108,7 @@ struct transaction {
   static constexpr auto unrecovered_file        = "transaction_error.004";
   static constexpr auto unrecovered_directory   = "transaction_error.005";
   static constexpr auto transaction_failed      = "transaction_error.006";
+  static constexpr auto sync_failed             = "transaction_error.007";
 
   static inline std::unordered_map<std::string_view, std::string_view> const messages{
     {start_failed, "transaction failed and was rolled back |\n↳ origin error:\n\t↳ {}"},
@@ -69,15 +116,18 @@ struct transaction {
     {unrecovered_entries, "Unrecovered entries remain in snapshot '{}'"},
     {unrecovered_file, "Unrecovered file: '{}'"},
     {unrecovered_directory, "Unrecovered directory: '{}'"},
-    {transaction_failed, "Transaction failed during '{}' operation. Reason: {}"}
+    {transaction_failed, "Transaction failed during '{}' operation. Reason: {}"},
+    {sync_failed, "could not make the transaction durable |\n↳ origin error:\n\t↳ {}"}
   };
 };
 
 struct sync {
-  static constexpr auto sync_failed = "sync_error.001";
+  static constexpr auto sync_failed           = "sync_error.001";
+  static constexpr auto metrics_export_failed = "sync_error.002";
 
   static inline std::unordered_map<std::string_view, std::string_view> const messages{
-    {sync_failed, "Sync operation failed: {}"}
+    {sync_failed, "Sync operation failed: {}"},
+    {metrics_export_failed, "could not export sync metrics to '{}' |\n↳ origin error:\n\t↳ {}"}
   };
 };
 
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <dropclone/copy_engine.hpp>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <span>
+#include <cstddef>
+
+namespace dropclone {
+
+namespace fs = std::filesystem;
+
+// Batches the file operations of one command on an io_uring instance: many
+// files are in flight at once from a single thread, and file data moves
+// through a pool of registered buffers (READ_FIXED / WRITE_FIXED). Built
+// only with DROPCLONE_ENABLE_IO_URING; local() returns nullptr if the kernel
+// lacks io_uring or one of the required operations, and callers stay on the
+// synchronous path.
+//
+// Every batch reports the items it completed through 'on_done' and silently
+// skips items whose operation is unnecessary (existing destination on copy
+// and mkdir, missing source on rename and unlink). The first other failure
+// stops starting new items; it is thrown as fs::filesystem_error once the
+// items in flight have finished.
+class io_uring_backend {
+ public:
+  struct path_pair {
+    fs::path from{};
+    fs::path to{};
+  };
+
+  using completion = std::function<void(std::size_t index)>;
+  using copy_completion = std::function<void(std::size_t index, copy_result const& result)>;
+
+  // one instance per thread, created on first use
+  static auto local() -> io_uring_backend*;
+
+  ~io_uring_backend();
+
+  io_uring_backend(io_uring_backend const&) = delete;
+  auto operator=(io_uring_backend const&) -> io_uring_backend& = delete;
+
+  // without 'overwrite' an existing destination is skipped, like copy_files
+  // does; files that are not regular files are copied by fs::copy
+  auto copy_files(std::span<path_pair const> copies, bool overwrite,
+                  copy_completion const& on_done) -> void;
+  auto rename_files(std::span<path_pair const> renames, completion const& on_done) -> void;
+  auto remove_files(std::span<fs::path const> files, completion const& on_done) -> void;
+
+  // one batch per depth, parents before children
+  auto create_directories(std::span<fs::path const> directories, completion const& on_done) -> void;
+  // one batch per depth, children before parents
+  auto remove_directories(std::span<fs::path const> directories, completion const& on_done) -> void;
+
+ private:
+  struct ring_state;
+
+  io_uring_backend();
+
+  std::unique_ptr<ring_state> ring_;
+};
+
+} // namespace dropclone
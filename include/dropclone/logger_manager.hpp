@@ -4,15 +4,25 @@
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <dropclone/errorcode.hpp>
 #include <dropclone/utility.hpp>
-#include <unordered_map>
+#include <dropclone/operation_log.hpp>
+#include <filesystem>
+#include <format>
+#include <array>
 #include <memory>
+#include <string>
 #include <utility>
-#include <shared_mutex>
+#include <type_traits>
+#include <cstddef>
+#include <cstdint>
 
 namespace dropclone {
 
+namespace fs = std::filesystem;
+
 enum class logger_id {core, config, sync};
 
+inline constexpr std::size_t logger_count{static_cast<std::size_t>(logger_id::sync) + 1};
+
 inline auto to_string(logger_id id) -> std::string {
   switch (id) {
     case logger_id::core:     return "core"; 
@@ -22,48 +32,94 @@ inline auto to_string(logger_id id) -> std::string {
   return "unknown";
 }
 
+// paths are logged by their native string, which needs no conversion
+template <typename value_type>
+constexpr auto log_argument(value_type const& value) noexcept -> value_type const& { return value; }
+inline auto log_argument(fs::path const& path) noexcept -> fs::path::string_type const& { return path.native(); }
+
+// Loggers are added while dropclone starts, before anything logs from a
+// second thread; get() afterwards is a plain array access.
+//
+// log(), debug(), info() and warn() take their message code as template
+// argument: the message is resolved and checked against the arguments
+// while compiling, and formatted only if the logger is enabled for the
+// level at all. Messages of a binary loggable message type are recorded
+// in the operation log instead, once one is set.
 class logger_manager {
  public:
   static inline auto const default_pattern{"[%Y-%m-%d %H:%M:%S.%e] [%n] [%^%l%$] %v"};
 
-  logger_manager() : core_logger_{
-    [] {
+  logger_manager() {
+    loggers_[index(logger_id::core)] = [] {
       auto sink = std::make_shared<spdlog::sinks::stdout_color_sink_st>();
       sink->set_pattern(default_pattern);
       sink->set_level(spdlog::level::trace);
       auto logger = std::make_shared<spdlog::logger>(to_string(logger_id::core), sink);
       logger->set_level(spdlog::level::info);
       return logger;
-    }()
-  } {}
-
-  auto get(logger_id id) -> std::shared_ptr<spdlog::logger> {
-    if (id == logger_id::core) { return core_logger_; }
-    try {
-      std::shared_lock<std::shared_mutex> logger_guard{logger_mutex_};
-      return loggers_.at(id);
-    } catch (std::out_of_range const& e) {
-      core_logger_->warn(
-        utility::formatter<errorcode::logger>::format(
-          errorcode::logger::logger_id_not_found, to_string(id)
-        )
-      );
-      return core_logger_;
-    }
+    }();
+  }
+
+  auto get(logger_id id) -> std::shared_ptr<spdlog::logger> const& {
+    if (auto const& logger = loggers_[index(id)]; logger) { return logger; }
+
+    auto const& core_logger = loggers_[index(logger_id::core)];
+    core_logger->warn(
+      utility::formatter<errorcode::logger>::format(
+        errorcode::logger::logger_id_not_found, to_string(id)
+      )
+    );
+    return core_logger;
   }
 
   auto add(logger_id id, std::shared_ptr<spdlog::logger> logger) -> logger_manager& {
-    std::lock_guard<std::shared_mutex> logger_guard{logger_mutex_};
-    loggers_.emplace(id, logger);
+    if (!loggers_[index(id)]) { loggers_[index(id)] = std::move(logger); }
     return *this;
   }
 
+  auto set_operation_log(std::unique_ptr<operation_log> log) -> void { operation_log_ = std::move(log); }
+
+  template <typename message_type, utility::fixed_string code, typename... args_type>
+  auto log(logger_id id, spdlog::level::level_enum level, args_type const&... args) -> void {
+    auto const& logger = get(id);
+    if (!logger->should_log(level)) { return; }
+
+    if constexpr (requires { message_type::binary_loggable; }) {
+      if (operation_log_) {
+        static constexpr auto number = utility::message_number(code);
+        operation_log_->record(number, static_cast<std::uint8_t>(id), static_cast<std::uint8_t>(level), 
+                               log_argument(args)...);
+        return;
+      }
+    }
+
+    using format_type = std::format_string<decltype(log_argument(args))...>;
+    auto const message = std::format(format_type{utility::message_v<message_type, code>}, log_argument(args)...);
+    logger->log(level, spdlog::string_view_t{message.data(), message.size()});
+  }
+
+  template <typename message_type, utility::fixed_string code, typename... args_type>
+  auto debug(logger_id id, args_type const&... args) -> void {
+    log<message_type, code>(id, spdlog::level::debug, args...);
+  }
+
+  template <typename message_type, utility::fixed_string code, typename... args_type>
+  auto info(logger_id id, args_type const&... args) -> void {
+    log<message_type, code>(id, spdlog::level::info, args...);
+  }
+
+  template <typename message_type, utility::fixed_string code, typename... args_type>
+  auto warn(logger_id id, args_type const&... args) -> void {
+    log<message_type, code>(id, spdlog::level::warn, args...);
+  }
+
  private:
-  std::shared_mutex logger_mutex_;
-  std::shared_ptr<spdlog::logger> core_logger_;
-  std::unordered_map<logger_id, std::shared_ptr<spdlog::logger>> loggers_;
+  static constexpr auto index(logger_id id) noexcept -> std::size_t { return static_cast<std::size_t>(id); }
+
+  std::array<std::shared_ptr<spdlog::logger>, logger_count> loggers_{};
+  std::unique_ptr<operation_log> operation_log_{};
 };
 
 inline logger_manager logger{};
   
-} // namespace dropclone
\ No newline at end of file
+} // namespace dropclone
@@ -1,59 +1,114 @@
 #pragma once
 
-#include <unordered_map>
-#include <string_view>
+#include <dropclone/utility.hpp>
 
 namespace dropclone::messagecode {
   
 struct config {
-  static constexpr auto config_file_parsed  = "config_message.001";
-  static constexpr auto config_validated    = "config_message.002";
-  static constexpr auto logging_ready       = "config_message.003";
+  static constexpr utility::fixed_string config_file_parsed  {"config_message.001"};
+  static constexpr utility::fixed_string config_validated    {"config_message.002"};
+  static constexpr utility::fixed_string logging_ready       {"config_message.003"};
 
-  static inline std::unordered_map<std::string_view, std::string_view> const messages{
+  static constexpr auto messages = utility::make_messages({
     {config_file_parsed, "Configuration file '{}' successfully parsed"},
     {config_validated, "Configuration validated successfully – {} clone entries ready"},
     {logging_ready, "Logging initialized to: {}"}
-  };
+  });
 };
 
+struct index {
+  static constexpr utility::fixed_string index_loaded {"index_message.001"};
+
+  static constexpr auto messages = utility::make_messages({
+    {index_loaded, "Snapshot index '{}' loaded – {} entries"}
+  });
+};
+
+struct watch {
+  static constexpr utility::fixed_string watch_started  {"watch_message.001"};
+  static constexpr utility::fixed_string watch_overflow {"watch_message.002"};
+
+  static constexpr auto messages = utility::make_messages({
+    {watch_started, "Watching '{}' for changes – {} directories"},
+    {watch_overflow, "Change events for '{}' were lost – falling back to a full rescan"}
+  });
+};
+
+struct sync {
+  static constexpr utility::fixed_string sync_yielded {"sync_message.001"};
+  static constexpr utility::fixed_string copy_summary {"sync_message.002"};
+  static constexpr utility::fixed_string delta_recovered {"sync_message.003"};
+  static constexpr utility::fixed_string content_compared {"sync_message.004"};
+  static constexpr utility::fixed_string directories_pruned {"sync_message.005"};
+  static constexpr utility::fixed_string transaction_recovered {"sync_message.006"};
+  static constexpr utility::fixed_string durability_summary {"sync_message.007"};
+  static constexpr utility::fixed_string next_sync {"sync_message.008"};
+
+  static constexpr auto messages = utility::make_messages({
+    {sync_yielded, "Sync budget of {}s for '{}' exhausted – {} of {} changed files synchronized, continuing next cycle"},
+    {copy_summary, "Copied {} files ({} bytes) for '{}' – reflink: {}, copy_file_range: {}, sendfile: {}, buffered: {}, standard: {}, io_uring: {}, delta: {}"},
+    {delta_recovered, "Restored {} files in '{}' from the delta journals of an interrupted sync"},
+    {content_compared, "Compared the content of {} files in '{}' – {} with changed metadata are identical, {} with unchanged metadata differ"},
+    {directories_pruned, "Skipped {} excluded directories with all their content while scanning '{}'"},
+    {transaction_recovered, "Recovered unfinished work for '{}' from its journal – {} steps rolled forward, {} rolled back"},
+    {durability_summary, "Synced {} files for '{}' to stable storage ({}) in {} ms"},
+    {next_sync, "Next sync of '{}' in about {} ms"}
+  });
+};
+
+// with a binary sync log, these go there instead of the text log
 struct command {
-  static constexpr auto enter_command    = "command_message.001";
-  static constexpr auto leave_command    = "command_message.002";
+  static constexpr auto binary_loggable = true;
+
+  static constexpr utility::fixed_string enter_command    {"command_message.001"};
+  static constexpr utility::fixed_string leave_command    {"command_message.002"};
+
+  static constexpr utility::fixed_string copy_file        {"command_message.003"};
+  static constexpr utility::fixed_string rename_file      {"command_message.004"};
+  static constexpr utility::fixed_string remove_file      {"command_message.005"};
+
+  static constexpr utility::fixed_string create_directory {"command_message.006"};
+  static constexpr utility::fixed_string remove_directory {"command_message.007"};
+
+  static constexpr utility::fixed_string execute_skipped  {"command_message.008"};
+  static constexpr utility::fixed_string undo_skipped     {"command_message.009"};
 
-  static constexpr auto copy_file        = "command_message.003";
-  static constexpr auto rename_file      = "command_message.004";
-  static constexpr auto remove_file      = "command_message.005";
+  static constexpr utility::fixed_string delta_file       {"command_message.010"};
+  static constexpr utility::fixed_string restore_file     {"command_message.011"};
 
-  static constexpr auto create_directory = "command_message.006";
-  static constexpr auto remove_directory = "command_message.007";
+  static constexpr utility::fixed_string swap_file        {"command_message.012"};
+  static constexpr utility::fixed_string restore_swapped  {"command_message.013"};
 
-  static constexpr auto execute_skipped  = "command_message.008";
-  static constexpr auto undo_skipped     = "command_message.009";
+  static constexpr utility::fixed_string trash_purged     {"command_message.014"};
 
-  static inline std::unordered_map<std::string_view, std::string_view> const messages{
+  static constexpr auto messages = utility::make_messages({
     {enter_command, "Enter {}::{}:"},
     {leave_command, "Leave {}::{}."},
-    {copy_file, "Copy file '{}' -> '{}'"},
+    {copy_file, "Copy file '{}' -> '{}' ({})"},
     {rename_file, "Rename file: '{}' -> '{}'"},
     {remove_file, "Remove file: '{}'"},
     {create_directory, "Create directory: '{}'"},
     {remove_directory, "Remove directory: '{}'"},
     {execute_skipped, "'{}::execute' skipped due to unsafe state"},
-    {undo_skipped, "'{}::undo' skipped – no recovery required"}
-  };
+    {undo_skipped, "'{}::undo' skipped – no recovery required"},
+    {delta_file, "Delta update '{}' -> '{}' – {} of {} blocks rewritten"},
+    {restore_file, "Restore file from delta journal: '{}'"},
+    {swap_file, "Swap in file: '{}' -> '{}'"},
+    {restore_swapped, "Restore previous version of file: '{}'"},
+    {trash_purged, "Purged trash '{}' – {} entries removed"}
+  });
 };
 
 struct system {
-  static constexpr auto application_starting            = "system_message.001";
-  static constexpr auto application_terminating         = "system_message.002";
-  static constexpr auto termination_requested_by_signal = "system_message.003";
+  static constexpr utility::fixed_string application_starting            {"system_message.001"};
+  static constexpr utility::fixed_string application_terminating         {"system_message.002"};
+  static constexpr utility::fixed_string termination_requested_by_signal {"system_message.003"};
 
-  static inline std::unordered_map<std::string_view, std::string_view> const messages{
+  static constexpr auto messages = utility::make_messages({
     {application_starting, "dropclone starting..."},
     {application_terminating, "dropclone terminated."},
     {termination_requested_by_signal, "Termination requested – dropclone will stop in at most {} seconds"}
-  };
+  });
 };
 
 } // namespace dropclone::messagecode
\ No newline at end of file
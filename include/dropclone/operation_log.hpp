@@ -0,0 +1,140 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <mutex>
+#include <concepts>
+#include <functional>
+#include <type_traits>
+#include <cstdint>
+#include <cstddef>
+
+namespace dropclone {
+
+namespace fs = std::filesystem;
+
+// One logged operation: the number of its message code, the logger and
+// level it was logged with, when it was logged and its arguments – strings
+// as ids into a string table, numbers as they are. 'sequence' is the
+// 1-based position of the record and written last; a slot whose sequence
+// does not match its position is torn or already overwritten.
+struct operation_record {
+  enum class kind : std::uint8_t { none, string, unsigned_number, signed_number };
+  static constexpr std::size_t max_arguments{4};
+
+  std::uint64_t sequence;
+  std::int64_t time; // nanoseconds since the epoch
+  std::uint16_t message;
+  std::uint8_t logger;
+  std::uint8_t level;
+  kind kinds[max_arguments];
+  std::uint64_t arguments[max_arguments];
+  std::uint64_t reserved;
+};
+
+static_assert(sizeof(operation_record) == 64);
+
+// A binary sync log: fixed-size records in a ring file mapped into memory,
+// so logging an operation costs a few stores instead of formatting a line
+// and queueing it. Once the ring is full, the oldest records are
+// overwritten. Strings – mostly paths – are written once to a string table
+// and referenced by id; a table only grows by strings not seen before.
+//
+// The string table lives as long as the records that use it: once the ring
+// has been overwritten completely since a table was started, the next new
+// string starts another one and the table before it is dropped, as no
+// record refers to it any longer. Tables alternate between
+// '<path>.strings.0' and '<path>.strings.1'; an id carries the generation
+// of its table in the upper 32 bits.
+//
+// record() may be called from any number of threads. 'dropclone-logdump'
+// turns the log back into the text format of the sync log.
+class operation_log {
+ public:
+  static constexpr std::size_t default_capacity{1 << 20}; // records, 64 MiB
+
+  // read() turns the string ids of the records into indices into 'strings'
+  struct contents {
+    std::vector<operation_record> records{}; // oldest first
+    std::vector<std::string> strings{};
+  };
+
+  explicit operation_log(fs::path path, std::size_t capacity = default_capacity);
+  ~operation_log();
+
+  operation_log(operation_log const&) = delete;
+  auto operator=(operation_log const&) -> operation_log& = delete;
+
+  template <typename... args_type>
+  auto record(std::uint16_t message, std::uint8_t logger, std::uint8_t level, args_type const&... args) -> void;
+
+  inline auto path() const noexcept -> fs::path const&;
+
+  static auto strings_path(fs::path const& path, std::uint64_t generation) -> fs::path;
+  static auto read(fs::path const& path) -> contents;
+
+ private:
+  template <typename value_type>
+  auto encode(operation_record& record, std::size_t index, value_type const& value) -> void;
+  auto intern(std::string_view value) -> std::uint64_t;
+  auto append(operation_record& record) -> void;
+  auto map_ring() -> bool;
+  auto load_strings() -> void;
+  auto start_strings(std::uint64_t generation) -> void;
+
+  struct string_hash {
+    using is_transparent = void;
+    auto operator()(std::string_view value) const noexcept -> std::size_t {
+      return std::hash<std::string_view>{}(value);
+    }
+  };
+
+  fs::path path_;
+  std::size_t capacity_;
+  int descriptor_{-1};
+  int strings_descriptor_{-1};
+  fs::path strings_path_{};
+  std::byte* mapping_{nullptr};
+  std::size_t mapping_size_{0};
+  std::mutex strings_mutex_{};
+  std::unordered_map<std::string, std::uint32_t, string_hash, std::equal_to<>> string_ids_{};
+};
+
+template <typename... args_type>
+auto operation_log::record(std::uint16_t message, std::uint8_t logger,
+                           std::uint8_t level, args_type const&... args) -> void {
+  static_assert(sizeof...(args_type) <= operation_record::max_arguments);
+
+  operation_record next{};
+  next.message = message;
+  next.logger = logger;
+  next.level = level;
+
+  std::size_t index{0};
+  (encode(next, index++, args), ...);
+  append(next);
+}
+
+template <typename value_type>
+auto operation_log::encode(operation_record& record, std::size_t index, value_type const& value) -> void {
+  if constexpr (std::is_convertible_v<value_type const&, std::string_view>) {
+    record.kinds[index] = operation_record::kind::string;
+    record.arguments[index] = intern(std::string_view{value});
+  } else if constexpr (std::unsigned_integral<value_type>) {
+    record.kinds[index] = operation_record::kind::unsigned_number;
+    record.arguments[index] = static_cast<std::uint64_t>(value);
+  } else if constexpr (std::signed_integral<value_type>) {
+    record.kinds[index] = operation_record::kind::signed_number;
+    record.arguments[index] = static_cast<std::uint64_t>(static_cast<std::int64_t>(value));
+  } else {
+    static_assert(std::is_convertible_v<value_type const&, std::string_view>,
+                  "operation_log records strings and integers only");
+  }
+}
+
+auto operation_log::path() const noexcept -> fs::path const& { return path_; }
+
+} // namespace dropclone
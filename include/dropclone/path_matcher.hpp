@@ -0,0 +1,66 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <regex>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+namespace dropclone {
+
+// Matches relative paths against a list of case-insensitive patterns with the
+// semantics of std::regex_search (ECMAScript | icase) – true if any pattern
+// matches somewhere in the path. Patterns prefixed with 'glob:' are
+// gitignore-style globs: '*', '?' and classes like '[a-z]' stay within one
+// path component, '**' spans components, a leading or inner '/' anchors at
+// the root, a trailing '/' matches the directory and its contents, and a
+// pattern without one matches a component at any depth, including
+// everything below it.
+//
+// All patterns within the supported regex subset (literals, classes,
+// groups, alternation, greedy and lazy quantifiers, '^' and '$') are
+// compiled into a single DFA over byte classes, so a path is matched in
+// one pass independent of the number of patterns. While no pattern is in
+// progress, the DFA skips ahead with memchr to the next byte that can
+// start a match. Patterns outside the subset (backreferences, lookahead,
+// word boundaries) or a DFA exceeding 'max_states' fall back to std::regex.
+class path_matcher {
+ public:
+  static constexpr std::size_t max_states{4096};
+  static constexpr std::string_view glob_prefix{"glob:"};
+
+  path_matcher() = default;
+  explicit path_matcher(std::vector<std::string> const& patterns);
+
+  auto matches(std::string_view path) const -> bool;
+  inline auto empty() const noexcept -> bool;
+
+  static auto glob_to_regex(std::string_view glob) -> std::string;
+
+ private:
+  static constexpr std::int32_t dead_state{-1};
+
+  auto compile(std::vector<std::string> const& patterns) -> bool;
+  auto dfa_matches(std::string_view path) const -> bool;
+
+  std::size_t pattern_count_{0};
+  bool has_dfa_{false};
+
+  // DFA: transitions_[state * class_count_ + byte_classes_[byte]]
+  std::array<std::uint8_t, 256> byte_classes_{};
+  std::size_t class_count_{0};
+  std::vector<std::int32_t> transitions_{};
+  std::vector<bool> accepting_{};        // a pattern matched, whatever follows
+  std::vector<bool> accepting_at_end_{}; // a pattern matches if the path ends here
+  std::int32_t start_state_{dead_state};
+  std::int32_t idle_state_{dead_state};  // no pattern in progress
+  std::vector<unsigned char> idle_exits_{}; // the bytes leaving the idle state, if few
+
+  std::vector<std::regex> fallback_{};
+};
+
+auto path_matcher::empty() const noexcept -> bool { return pattern_count_ == 0; }
+
+} // namespace dropclone
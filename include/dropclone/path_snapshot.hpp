@@ -1,6 +1,7 @@
 #pragma once
 
 #include <dropclone/path_info.hpp>
+#include <dropclone/path_table.hpp>
 #include <unordered_map>
 #include <map>
 #include <filesystem>
@@ -8,32 +9,57 @@
 #include <unordered_set> 
 #include <set>
 #include <chrono>
+#include <cstddef>
+#include <vector>
+#include <utility>
+#include <iterator>
 
 namespace dropclone {
 
   namespace fs = std::filesystem;
   namespace chr = std::chrono;
   
+  struct path_change {
+    fs::path path{};      // relative to the snapshot root
+    bool subtree{false};  // directory whose whole subtree has to be re-evaluated
+  };
+
+  using path_changes = std::vector<path_change>;
+
   class path_snapshot {
    public:
     using snapshot_entries = std::unordered_map<fs::path, path_info>; 
     using snapshot_directories = std::map<fs::path, path_info>;
+    using entry_list = std::vector<std::pair<fs::path, path_info>>;
     // using uncertain_processing_paths = std::unordered_set<fs::path>;
     using path_filter = std::function<bool(fs::path const&)>;
     using entry_filter = std::function<bool(snapshot_entries::value_type const&)>;
+
+    class entry_view;
   
     explicit path_snapshot(fs::path root);
+    path_snapshot(fs::path root, snapshot_entries const& entries);
+    path_snapshot(fs::path root, entry_list const& entries);
   
-    auto make(path_filter filter = {}) -> void;
+    // 'prune' names directories whose whole subtree is filtered out; they
+    // are not descended into and counted in pruned()
+    auto make(path_filter filter = {}, std::size_t thread_count = 1, path_filter prune = {}) -> void;
+    auto make(path_changes const& changes, path_filter filter, path_filter prune = {}) -> void;
+    auto extract(path_changes const& changes) const -> path_snapshot;
+    auto update(path_snapshot const& previous, path_snapshot const& current) -> void;
     auto local_diff(path_snapshot const& other) -> path_snapshot;
 
     // * auto cross_diff(path_snapshot const& other) -> path_snapshot; // for bidirectional sync
 
     inline auto root() const noexcept -> fs::path;
     inline auto hash() const noexcept -> size_t;
+    auto directory_hash(fs::path const& directory) const noexcept -> size_t;
     inline auto has_data() const noexcept -> bool;
+    inline auto pruned() const noexcept -> std::size_t;
+    // directories that could not be read; they are not entries
+    inline auto conflicts() const noexcept -> snapshot_entries const&;
 
-    inline auto entries() const noexcept -> snapshot_entries const&;
+    inline auto entries() const noexcept -> entry_view;
     inline auto files() const noexcept -> snapshot_entries const&;
     inline auto directories() const noexcept -> snapshot_directories const&;
 
@@ -46,22 +72,97 @@ namespace dropclone {
     auto rebase(fs::path const& new_root) -> void;
   
    private:
+    using index_type = path_table::index_type;
+
     fs::path root_;
-    snapshot_entries entries_{};
+    // The scanned entries: every path is interned once in paths_ (which
+    // also holds intermediate directories that are not entries, e.g.
+    // filtered out ones); the metadata lives in arrays indexed by the path.
+    path_table paths_{};
+    std::vector<path_info> infos_{path_info{}};
+    std::vector<bool> present_{false};
+    std::size_t entry_count_{0};
     snapshot_entries conflicts_{};
+    // diff results and command working sets
     snapshot_entries files_{};
     snapshot_directories directories_{};
     chr::time_point<chr::steady_clock> creation_time{};
+    // Merkle tree over the path tree: every directory with entries below it
+    // (including the root and intermediate directories) carries a hash over
+    // the names, metadata and subtree hashes of its children. hash_ is the
+    // hash of the root.
+    std::vector<size_t> directory_hashes_{0};
+    std::vector<bool> has_subtree_{false};
     size_t hash_{};
+    std::size_t pruned_{0};
   
-    auto compute_hash() const -> size_t;
+    auto set_entry(fs::path const& relative_path, path_info const& info, bool overwrite) -> index_type;
+    auto erase_entry(fs::path const& relative_path) -> index_type;
+    auto compact() -> bool;
+    auto compute_hash() -> void;
+    auto compute_directory_hash(index_type directory) -> size_t;
+    auto rehash_ancestors(std::vector<index_type> const& entries) -> void;
+    auto rehash_directory(index_type directory) -> void;
+    inline auto is_live(index_type index) const noexcept -> bool;
+  };
+
+  // Read-only view of the entries of a snapshot in the shape of
+  // snapshot_entries; iterating it builds every path from the path table.
+  class path_snapshot::entry_view {
+   public:
+    using value_type = std::pair<fs::path, path_info>;
+
+    class iterator {
+     public:
+      using iterator_concept = std::forward_iterator_tag;
+      using iterator_category = std::input_iterator_tag;
+      using value_type = entry_view::value_type;
+      using reference = value_type;
+      using difference_type = std::ptrdiff_t;
+
+      iterator() = default;
+      iterator(path_snapshot const* snapshot, index_type index) noexcept;
+
+      auto operator*() const -> value_type;
+      auto operator++() noexcept -> iterator&;
+      auto operator++(int) noexcept -> iterator;
+      auto operator==(iterator const& other) const noexcept -> bool { return index_ == other.index_; }
+
+     private:
+      auto skip_absent() noexcept -> void;
+
+      path_snapshot const* snapshot_{nullptr};
+      std::size_t index_{0};
+    };
+
+    explicit entry_view(path_snapshot const& snapshot) noexcept : snapshot_{&snapshot} {}
+
+    auto begin() const noexcept -> iterator;
+    auto end() const noexcept -> iterator;
+    auto size() const noexcept -> std::size_t { return snapshot_->entry_count_; }
+    auto empty() const noexcept -> bool { return snapshot_->entry_count_ == 0; }
+
+    auto find(fs::path const& relative_path) const -> path_info const*;
+    auto contains(fs::path const& relative_path) const -> bool { return find(relative_path) != nullptr; }
+    auto at(fs::path const& relative_path) const -> path_info const&;
+
+    auto operator==(entry_view const& other) const -> bool;
+
+   private:
+    path_snapshot const* snapshot_;
   };
 
   auto path_snapshot::root() const noexcept -> fs::path { return root_; }
   auto path_snapshot::hash() const noexcept -> size_t { return hash_; }
   auto path_snapshot::has_data() const noexcept -> bool { return !files_.empty() || !directories_.empty(); }
+  auto path_snapshot::pruned() const noexcept -> std::size_t { return pruned_; }
+  auto path_snapshot::conflicts() const noexcept -> snapshot_entries const& { return conflicts_; }
+
+  auto path_snapshot::entries() const noexcept -> entry_view { return entry_view{*this}; }
 
-  auto path_snapshot::entries() const noexcept -> snapshot_entries const& { return entries_; }
+  auto path_snapshot::is_live(index_type index) const noexcept -> bool {
+    return present_[index] || has_subtree_[index];
+  }
 
   auto path_snapshot::files() const noexcept -> snapshot_entries const& { return files_; }
   auto path_snapshot::files() noexcept -> snapshot_entries& { return files_; }
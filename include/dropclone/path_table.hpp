@@ -0,0 +1,72 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <limits>
+#include <cstdint>
+#include <cstddef>
+
+namespace dropclone {
+
+namespace fs = std::filesystem;
+
+// Interns relative paths as a tree of components: every node stores its
+// parent, its first child, its next sibling and the position of its name in
+// one shared character arena. A path below a known directory costs one node
+// and its name, however deep it is. Lookups hash (parent, name) into an
+// open-addressing table of node indices, so no fs::path is built or hashed.
+// Node 0 is the root, the empty relative path. Nodes are never removed.
+class path_table {
+ public:
+  using index_type = std::uint32_t;
+
+  static constexpr index_type root{0};
+  static constexpr index_type npos{std::numeric_limits<index_type>::max()};
+
+  path_table();
+
+  auto find(fs::path const& relative_path) const -> index_type;
+  auto find_child(index_type parent, std::string_view name) const -> index_type;
+  auto insert(fs::path const& relative_path) -> index_type;
+  auto insert_child(index_type parent, std::string_view name) -> index_type;
+
+  auto path(index_type index) const -> fs::path;
+
+  inline auto parent(index_type index) const noexcept -> index_type;
+  inline auto name(index_type index) const noexcept -> std::string_view;
+  inline auto first_child(index_type index) const noexcept -> index_type;
+  inline auto next_sibling(index_type index) const noexcept -> index_type;
+  inline auto size() const noexcept -> std::size_t;
+
+  auto reserve(std::size_t node_count) -> void;
+
+ private:
+  struct node {
+    index_type parent{npos};
+    index_type first_child{npos};
+    index_type next_sibling{npos};
+    std::uint32_t name_length{0};
+    std::uint64_t name_offset{0};
+  };
+
+  auto slot_of(index_type parent, std::string_view name) const noexcept -> std::size_t;
+  auto rehash(std::size_t slot_count) -> void;
+
+  std::vector<node> nodes_{};
+  std::string names_{};
+  std::vector<index_type> slots_{};
+};
+
+auto path_table::parent(index_type index) const noexcept -> index_type { return nodes_[index].parent; }
+
+auto path_table::name(index_type index) const noexcept -> std::string_view {
+  return std::string_view{names_}.substr(nodes_[index].name_offset, nodes_[index].name_length);
+}
+
+auto path_table::first_child(index_type index) const noexcept -> index_type { return nodes_[index].first_child; }
+auto path_table::next_sibling(index_type index) const noexcept -> index_type { return nodes_[index].next_sibling; }
+auto path_table::size() const noexcept -> std::size_t { return nodes_.size(); }
+
+} // namespace dropclone
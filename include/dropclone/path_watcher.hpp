@@ -0,0 +1,51 @@
+#pragma once
+
+#include <dropclone/path_snapshot.hpp>
+#include <filesystem>
+#include <unordered_map>
+
+namespace dropclone {
+
+namespace fs = std::filesystem;
+
+// Subscribes to inotify for every directory below a source root and turns the
+// queued events into path_changes relative to that root. A watcher that could
+// not be set up completely, lost its root or overflowed its event queue
+// reports 'overflow'; the caller then has to fall back to a full rescan.
+// Directories matched by 'prune' are not watched, nor is anything below them.
+class path_watcher {
+ public:
+  struct poll_result {
+    path_changes changes{};
+    bool overflow{false};
+  };
+
+  explicit path_watcher(fs::path root, path_snapshot::path_filter prune = {});
+  ~path_watcher();
+
+  path_watcher(path_watcher const&) = delete;
+  auto operator=(path_watcher const&) -> path_watcher& = delete;
+
+  auto poll() -> poll_result;
+
+  inline auto descriptor() const noexcept -> int;
+  inline auto is_active() const noexcept -> bool;
+
+ private:
+  auto add_watches(fs::path const& relative_directory) -> void;
+  auto add_watch(fs::path const& relative_directory) -> bool;
+  auto remove_watches(fs::path const& relative_directory) -> void;
+
+  fs::path root_;
+  path_snapshot::path_filter prune_;
+  int descriptor_{-1};
+  int root_watch_{-1};
+  bool active_{false};
+  bool overflow_{false};
+  std::unordered_map<int, fs::path> watches_{};
+};
+
+auto path_watcher::descriptor() const noexcept -> int { return descriptor_; }
+auto path_watcher::is_active() const noexcept -> bool { return active_; }
+
+} // namespace dropclone
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <dropclone/path_snapshot.hpp>
+#include <filesystem>
+#include <optional>
+#include <cstdint>
+
+namespace dropclone {
+
+namespace fs = std::filesystem;
+
+// Persists the last committed source snapshot of a clone entry so that a
+// restart diffs against it instead of against an empty snapshot.
+//
+// layout (native byte order):
+//   header  | magic "DCSNAPIX" | version u32 | reserved u32 | entry_count u64
+//           | payload_size u64 | checksum u64
+//   payload | root_length u32 | root bytes
+//           | entry_count × { last_write_time i64 | file_size u64 | perms u32
+//                             | is_directory u8 | reserved u8 | path_length u16 | path bytes }
+class snapshot_index {
+ public:
+  static constexpr std::uint32_t version{1};
+
+  explicit snapshot_index(fs::path index_path);
+
+  auto load(fs::path const& root) const -> std::optional<path_snapshot>;
+  auto store(path_snapshot const& snapshot) const -> bool;
+
+  inline auto path() const noexcept -> fs::path const&;
+
+  static auto index_path(fs::path const& index_directory, fs::path const& source_directory,
+                         fs::path const& destination_directory) -> fs::path;
+
+ private:
+  fs::path index_path_;
+};
+
+auto snapshot_index::path() const noexcept -> fs::path const& { return index_path_; }
+
+} // namespace dropclone
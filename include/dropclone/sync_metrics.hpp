@@ -0,0 +1,115 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace dropclone {
+
+namespace fs = std::filesystem;
+
+// Counters and latency histograms of the sync cycles of one clone entry.
+// Every thread records into one of a fixed set of cache-line aligned
+// shards with relaxed atomic adds – no locks, and threads do not share a
+// cache line unless there are more of them than shards. Reading sums the
+// shards, so a snapshot may be slightly behind recordings still running.
+class sync_metrics {
+ public:
+  enum class counter : std::uint8_t {
+    syncs, sync_failures, files_copied, bytes_copied, rollbacks
+  };
+  static constexpr std::size_t counter_count{5};
+
+  // the 'execute' and 'undo' phases are kept per command
+  enum class histogram : std::uint8_t {
+    sync, scan, hash, diff,
+    copy_execute, rename_execute, remove_execute, delta_execute, update_execute,
+    copy_undo, rename_undo, remove_undo, delta_undo, update_undo,
+    rollback, fsync, commit_lag
+  };
+  static constexpr std::size_t histogram_count{17};
+
+  // upper bounds of the histogram buckets; the last bucket is unbounded
+  static constexpr std::array<std::chrono::nanoseconds, 14> bucket_bounds{
+    std::chrono::microseconds{100}, std::chrono::microseconds{500},
+    std::chrono::milliseconds{1}, std::chrono::milliseconds{5},
+    std::chrono::milliseconds{10}, std::chrono::milliseconds{50},
+    std::chrono::milliseconds{100}, std::chrono::milliseconds{500},
+    std::chrono::seconds{1}, std::chrono::seconds{5},
+    std::chrono::seconds{10}, std::chrono::seconds{30},
+    std::chrono::seconds{60}, std::chrono::seconds{300}
+  };
+  static constexpr std::size_t bucket_count{bucket_bounds.size() + 1};
+
+  struct histogram_values {
+    std::array<std::uint64_t, bucket_count> buckets{}; // not cumulative
+    std::uint64_t count{0};
+    std::chrono::nanoseconds sum{0};
+  };
+
+  struct values {
+    std::array<std::uint64_t, counter_count> counters{};
+    std::array<histogram_values, histogram_count> histograms{};
+  };
+
+  // records the time from its construction to its destruction; does
+  // nothing without metrics
+  class scoped_timer {
+   public:
+    scoped_timer(sync_metrics* metrics, histogram target) noexcept;
+    ~scoped_timer();
+
+    scoped_timer(scoped_timer const&) = delete;
+    auto operator=(scoped_timer const&) -> scoped_timer& = delete;
+
+   private:
+    sync_metrics* metrics_;
+    histogram target_;
+    std::chrono::steady_clock::time_point started_;
+  };
+
+  sync_metrics();
+
+  auto add(counter target, std::uint64_t value = 1) noexcept -> void;
+  auto observe(histogram target, std::chrono::nanoseconds duration) noexcept -> void;
+  auto snapshot() const noexcept -> values;
+
+  // the histogram of 'command_name' ("copy_command", ...)
+  static auto command_histogram(std::string_view command_name, bool undo) noexcept -> histogram;
+
+ private:
+  static constexpr std::size_t shard_count{16};
+
+  struct histogram_shard {
+    std::array<std::atomic<std::uint64_t>, bucket_count> buckets{};
+    std::atomic<std::int64_t> sum{0}; // nanoseconds
+  };
+
+  struct alignas(64) shard {
+    std::array<std::atomic<std::uint64_t>, counter_count> counters{};
+    std::array<histogram_shard, histogram_count> histograms{};
+  };
+
+  auto local_shard() noexcept -> shard&;
+
+  std::unique_ptr<std::array<shard, shard_count>> shards_;
+};
+
+// Writes the metrics of all entries in the Prometheus text format to
+// 'path' – into a temporary file first that is renamed over 'path', so a
+// collector never reads a partial file.
+struct entry_metrics {
+  std::string entry{}; // the source directory
+  sync_metrics const* metrics{nullptr};
+};
+
+auto export_metrics(fs::path const& path, std::vector<entry_metrics> const& entries) -> void;
+
+} // namespace dropclone
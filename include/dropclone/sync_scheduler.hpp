@@ -0,0 +1,51 @@
+#pragma once
+
+#include <dropclone/clone_config.hpp>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace dropclone {
+
+// When each clone entry is synced next. An entry is due once its interval
+// has passed since its last cycle; adaptive entries go back to their
+// sync_interval after a cycle that found changes and double it after every
+// idle cycle, up to max_sync_interval. The first cycle of each entry starts
+// at a random point within its interval, but no later than a few seconds
+// after startup, and every later interval is stretched or shortened by up
+// to a tenth, so entries with equal intervals do not scan the same disk at
+// the same moment.
+class sync_scheduler {
+ public:
+  using clock = std::chrono::steady_clock;
+
+  sync_scheduler(std::vector<config_entry> const& entries, clock::time_point now);
+  sync_scheduler(std::vector<config_entry> const& entries, clock::time_point now, std::uint64_t seed);
+
+  // the entries whose time has come, in entry order
+  auto due(clock::time_point now) const -> std::vector<std::size_t>;
+  auto next_due() const noexcept -> clock::time_point;
+  // 'index' finished a cycle at 'now'; 'changed' if it found changes
+  auto completed(std::size_t index, bool changed, clock::time_point now) -> void;
+  // makes 'index' due at once, e.g. after a watch event
+  auto trigger(std::size_t index, clock::time_point now) noexcept -> void;
+  auto interval(std::size_t index) const noexcept -> std::chrono::milliseconds;
+
+ private:
+  struct schedule {
+    std::chrono::milliseconds base_interval{};
+    std::chrono::milliseconds max_interval{};
+    std::chrono::milliseconds interval{};
+    dropclone::interval_mode mode{dropclone::interval_mode::fixed};
+    clock::time_point next{};
+  };
+
+  auto jittered(std::chrono::milliseconds interval) -> std::chrono::milliseconds;
+
+  std::vector<schedule> schedules_{};
+  std::mt19937_64 random_;
+};
+
+} // namespace dropclone
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <dropclone/path_info.hpp>
+#include <filesystem>
+#include <vector>
+#include <mutex>
+#include <cstdint>
+
+namespace dropclone {
+
+namespace fs = std::filesystem;
+
+// An append-only write-ahead log of the file steps of one clone entry.
+// Every step is recorded before it runs and again once it finished. The
+// records stay until the snapshot index covers them; a transaction that
+// rolled back completely truncates its own records again. Whatever is
+// left at startup belongs to work the process did not finish – replay()
+// returns it, so recovery only needs to look at those files.
+//
+// A step that ended without touching its destination, e.g. a copy that
+// kept an existing file, is abandoned instead of done, so the replay leaves
+// it out rather than rolling the destination back.
+//
+// Records are appended with one write(2) each and carry a checksum, so a
+// record torn by a crash ends the replay instead of corrupting it. sync()
+// makes everything appended so far durable; the caller decides how often.
+class transaction_journal {
+ public:
+  enum class operation : std::uint8_t { copy, update, rename };
+
+  struct step {
+    operation kind{operation::copy};
+    fs::path source{};      // absolute
+    fs::path destination{}; // absolute
+    path_info info{};       // of the source when the step began
+    bool done{false};
+  };
+
+  explicit transaction_journal(fs::path path);
+  ~transaction_journal();
+
+  transaction_journal(transaction_journal const&) = delete;
+  auto operator=(transaction_journal const&) -> transaction_journal& = delete;
+
+  auto begin(operation kind, fs::path const& source, fs::path const& destination,
+             path_info const& info = {}) -> void;
+  auto done(operation kind, fs::path const& source, fs::path const& destination) -> void;
+  auto abandon(operation kind, fs::path const& source, fs::path const& destination) -> void;
+  auto sync() -> void;
+
+  // the journal size; truncate(mark) drops everything recorded after it
+  auto mark() -> std::uint64_t;
+  auto truncate(std::uint64_t mark) -> void;
+  auto reset() -> void;
+
+  auto replay() const -> std::vector<step>;
+  inline auto path() const noexcept -> fs::path const&;
+
+ private:
+  enum class record_state : std::uint8_t { begun, done, abandoned };
+
+  auto append(record_state state, operation kind, fs::path const& source, fs::path const& destination,
+              path_info const& info) -> void;
+  auto open() -> void;
+
+  fs::path path_;
+  std::mutex mutex_{};
+  int descriptor_{-1};
+  std::uint64_t size_{0};
+};
+
+auto transaction_journal::path() const noexcept -> fs::path const& { return path_; }
+
+} // namespace dropclone
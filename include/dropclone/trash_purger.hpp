@@ -0,0 +1,62 @@
+#pragma once
+
+#include <filesystem>
+#include <string_view>
+#include <condition_variable>
+#include <mutex>
+#include <deque>
+#include <thread>
+#include <stop_token>
+#include <cstddef>
+
+namespace dropclone {
+
+namespace fs = std::filesystem;
+
+// Deletes trash directories after the transaction that moved files into
+// them committed. Purges run one after another on a background thread with
+// the lowest CPU priority and the idle I/O class; the top-level entries of
+// a trash directory are unlinked in parallel by up to 'workers' threads.
+// Trash that is still pending when the purger is destroyed is purged before
+// the destructor returns.
+class trash_purger {
+ public:
+  // trash directories live below '<root>/.dropclone-trash', on the same
+  // file system as the files moved into them
+  static constexpr std::string_view directory_name{".dropclone-trash"};
+
+  explicit trash_purger(std::size_t workers = 1);
+  ~trash_purger();
+
+  trash_purger(trash_purger const&) = delete;
+  auto operator=(trash_purger const&) -> trash_purger& = delete;
+
+  // queues 'trash' for purging; afterwards the trash root and 'root' are
+  // removed as well if they are empty then
+  auto purge(fs::path trash, fs::path root = {}) -> void;
+  auto wait() -> void;
+
+  static auto trash_root(fs::path const& root) -> fs::path;
+  // unlinks 'directory' and everything below it on the calling thread (and
+  // up to 'workers' helpers); returns the number of entries removed
+  static auto purge_now(fs::path const& directory, std::size_t workers = 1) -> std::size_t;
+  static auto remove_empty(fs::path const& trash, fs::path const& root) -> void;
+
+ private:
+  struct job {
+    fs::path trash{};
+    fs::path root{};
+  };
+
+  auto run(std::stop_token stop_token) -> void;
+
+  std::size_t workers_;
+  std::mutex mutex_{};
+  std::condition_variable_any job_available_{};
+  std::condition_variable idle_{};
+  std::deque<job> jobs_{};
+  bool busy_{false};
+  std::jthread thread_{}; // started with the first purge
+};
+
+} // namespace dropclone
@@ -3,11 +3,65 @@
 #include <string>
 #include <string_view>
 #include <format>
+#include <array>
+#include <algorithm>
+#include <stdexcept>
+#include <cstddef>
+#include <cstdint>
 
 namespace dropclone::utility {
 
 inline auto to_string(std::string_view code) -> std::string { return std::string{code}; }
 
+// A string literal usable as a template argument, so a message code can
+// select its message at compile time.
+template <std::size_t size>
+struct fixed_string {
+  char value[size]{};
+
+  consteval fixed_string(char const (&text)[size]) { std::copy_n(text, size, value); }
+  constexpr operator std::string_view() const noexcept { return {value, size - 1}; }
+};
+
+struct message {
+  std::string_view code;
+  std::string_view text;
+};
+
+// The messages of a message code type; at() works at compile time as well
+// as at runtime and throws std::out_of_range for an unknown code.
+template <std::size_t size>
+struct message_table {
+  std::array<message, size> entries;
+
+  constexpr auto at(std::string_view code) const -> std::string_view {
+    for (auto const& entry : entries) {
+      if (entry.code == code) { return entry.text; }
+    }
+    throw std::out_of_range{"unknown message code"};
+  }
+};
+
+template <std::size_t size>
+consteval auto make_messages(message const (&entries)[size]) -> message_table<size> {
+  message_table<size> table{};
+  std::copy_n(entries, size, table.entries.begin());
+  return table;
+}
+
+// the number a code ends with, "command_message.003" -> 3
+constexpr auto message_number(std::string_view code) -> std::uint16_t {
+  std::uint16_t number{0};
+  for (auto const digit : code.substr(code.rfind('.') + 1)) {
+    number = static_cast<std::uint16_t>(number * 10 + (digit - '0'));
+  }
+  return number;
+}
+
+// the message of 'code', resolved while compiling
+template <typename message_type, fixed_string code>
+inline constexpr std::string_view message_v = message_type::messages.at(code);
+
 template <typename message_type>
 struct formatter {
   static auto format(auto code, auto const&... args) -> std::string {
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <functional>
+#include <condition_variable>
+#include <mutex>
+#include <deque>
+#include <thread>
+#include <vector>
+#include <cstddef>
+
+namespace dropclone {
+
+// A fixed number of worker threads taking tasks from a shared FIFO queue.
+// Tasks run in submission order, at most thread_count of them at a time;
+// wait() blocks until every submitted task has finished. With a queue
+// capacity, submit() blocks while that many tasks are waiting, so a
+// producer cannot run arbitrarily far ahead of the workers. Tasks must not
+// throw – whatever has to reach the caller is captured by the task itself.
+class worker_pool {
+ public:
+  using task = std::function<void()>;
+
+  explicit worker_pool(std::size_t thread_count, std::size_t queue_capacity = 0);
+  ~worker_pool();
+
+  worker_pool(worker_pool const&) = delete;
+  auto operator=(worker_pool const&) -> worker_pool& = delete;
+
+  auto submit(task work) -> void;
+  auto wait() -> void;
+
+  inline auto size() const noexcept -> std::size_t;
+
+ private:
+  auto work(std::stop_token stop_token) -> void;
+
+  std::mutex mutex_{};
+  std::condition_variable_any task_available_{};
+  std::condition_variable idle_{};
+  std::condition_variable space_available_{};
+  std::deque<task> tasks_{};
+  std::size_t queue_capacity_;
+  std::size_t running_{0};
+  std::vector<std::jthread> workers_{};
+};
+
+auto worker_pool::size() const noexcept -> std::size_t { return workers_.size(); }
+
+} // namespace dropclone
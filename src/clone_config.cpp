@@ -3,33 +3,67 @@
 #include <dropclone/exception.hpp>
 #include <dropclone/errorcode.hpp>
 #include <dropclone/utility.hpp>
+#include <dropclone/trash_purger.hpp>
 #include <string>
 #include <string_view>
 #include <filesystem>
 #include <unordered_map>
 #include <algorithm>
 #include <utility>
-#include <regex>
 #include <ranges>
+#include <thread>
+#include <iterator>
+#include <chrono>
 
 namespace dropclone {
 
 namespace fs = std::filesystem;
 namespace rng = std::ranges;
 
+namespace {
+
+// the trash of a removal below the source root is never synchronized
+auto is_trash(std::string_view relative_path) -> bool {
+  auto const name = trash_purger::directory_name;
+  return relative_path.starts_with(name) && 
+         (relative_path.size() == name.size() || relative_path[name.size()] == '/');
+}
+
+} // namespace
+
 auto config_entry::compile_patterns(raw_patterns_type& raw_patterns) -> patterns_type {
-  patterns_type result{};
-  result.reserve(raw_patterns.size());
-
-  rng::for_each(raw_patterns, [&](auto& pattern) {
-    result.emplace_back(std::move(pattern), 
-      std::regex::ECMAScript 
-      | std::regex_constants::icase 
-      | std::regex::optimize
-    );
-  });
+  return path_matcher{raw_patterns};
+}
 
-  return result;
+// A pattern is prefix-stable if a match in a string is still a match in
+// every extension of that string. regex_search only loses a match when the
+// pattern looks at what follows it: an end anchor, a word boundary or a
+// lookahead. Everything else – including '^' – is unaffected by appended
+// characters. Globs always match a directory together with its content.
+auto config_entry::is_prefix_stable(std::string_view pattern) -> bool {
+  if (pattern.starts_with(path_matcher::glob_prefix)) { return true; }
+
+  bool in_class{false};
+  for (std::size_t index{0}; index < pattern.size(); ++index) {
+    auto const character = pattern[index];
+    if (character == '\\') {
+      if (index + 1 < pattern.size() && !in_class &&
+          (pattern[index + 1] == 'b' || pattern[index + 1] == 'B')) {
+        return false;
+      }
+      ++index;
+    } else if (in_class) {
+      in_class = character != ']';
+    } else if (character == '[') {
+      in_class = true;
+      if (index + 1 < pattern.size() && pattern[index + 1] == ']') { ++index; }
+    } else if (character == '$') {
+      return false;
+    } else if (pattern.substr(index).starts_with("(?=") || pattern.substr(index).starts_with("(?!")) {
+      return false;
+    }
+  }
+  return true;
 }
 
 config_entry::config_entry(fs::path source_directory, fs::path destination_directory)
@@ -48,7 +82,12 @@ config_entry::config_entry(fs::path source_directory, fs::path destination_direc
                            raw_patterns_type& include_patterns)
   : source_directory{std::move(source_directory)}, 
     destination_directory{std::move(destination_directory)},
-    mode{mode}, exclude_patterns{std::move(compile_patterns(exclude_patterns))}, 
+    mode{mode}, prune_patterns{[&] {
+      raw_patterns_type prefix_stable_patterns{};
+      rng::copy_if(exclude_patterns, std::back_inserter(prefix_stable_patterns), is_prefix_stable);
+      return compile_patterns(prefix_stable_patterns);
+    }()},
+    exclude_patterns{std::move(compile_patterns(exclude_patterns))}, 
     include_patterns{std::move(compile_patterns(include_patterns))}
 {}
 
@@ -71,6 +110,40 @@ auto config_entry::sanitize() -> void {
     );
   }
 
+  if (update_mode == dropclone::update_mode::undefined) {
+    throw_exception<errorcode::config>(
+      errorcode::config::invalid_update_mode, "update_mode"
+    );
+  }
+
+  if (compare == compare_strategy::undefined) {
+    throw_exception<errorcode::config>(
+      errorcode::config::invalid_compare_strategy, "compare"
+    );
+  }
+
+  if (durability == durability_mode::undefined) {
+    throw_exception<errorcode::config>(
+      errorcode::config::invalid_durability_mode, "durability"
+    );
+  }
+
+  if (interval_mode == dropclone::interval_mode::undefined) {
+    throw_exception<errorcode::config>(
+      errorcode::config::invalid_interval_mode, "interval_mode"
+    );
+  }
+
+  if (max_sync_interval == std::chrono::milliseconds{0}) {
+    max_sync_interval = sync_interval * 16;
+  }
+
+  if (sync_interval <= std::chrono::milliseconds{0} || sync_interval > max_sync_interval) {
+    throw_exception<errorcode::config>(
+      errorcode::config::invalid_sync_interval, "sync_interval_ms"
+    );
+  }
+
   if (!exclude_patterns.empty() && !include_patterns.empty()) {
     throw_exception<errorcode::config>(
       errorcode::config::conflicting_fields, 
@@ -78,37 +151,61 @@ auto config_entry::sanitize() -> void {
     );
   }
 
+  if (scan_threads == 0) {
+    scan_threads = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+
+  if (copy_workers == 0) {
+    copy_workers = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+
   source_directory = source_directory.lexically_normal();
   destination_directory = destination_directory.lexically_normal();
 }
 
 auto config_entry::filter(fs::path const& path) -> bool {
-  auto absolute_path{path.string()};
-  auto root_path{source_directory.string()};
+  std::string_view const absolute_path{path.native()};
+  std::string_view const root_path{source_directory.native()};
 
   if (!absolute_path.starts_with(root_path)) { return false; }
+
+  auto const relative_offset = root_path.size() + (root_path.ends_with('/') ? 0 : 1);
+  auto const relative_path = absolute_path.substr(std::min(relative_offset, absolute_path.size()));
+
+  if (is_trash(relative_path)) { return false; }
   if (exclude_patterns.empty() && include_patterns.empty()) { 
     return true; 
   }
 
-  if (!root_path.ends_with("/")) { root_path.append("/"); }
-  auto relative_path = absolute_path.substr(root_path.size());
-
   if (!exclude_patterns.empty()) {
-    return !rng::any_of(exclude_patterns, [&](auto const& regex) {
-      return std::regex_search(relative_path, regex);
-    });
+    return !exclude_patterns.matches(relative_path);
   }
 
   if (!include_patterns.empty()) {
-    return rng::any_of(include_patterns, [&](auto const& regex) {
-      return std::regex_search(relative_path, regex);
-    });
+    return include_patterns.matches(relative_path);
   }
 
   return false; 
 } 
 
+// true if 'directory' and everything below it is excluded. Appending the
+// separator also catches patterns that only match inside the directory
+// (e.g. 'cache/'); the directory itself is then kept as an empty entry.
+auto config_entry::prune(fs::path const& directory) -> bool {
+  auto absolute_path{directory.string()};
+  auto root_path{source_directory.string()};
+
+  if (!root_path.ends_with("/")) { root_path.append("/"); }
+  if (!absolute_path.starts_with(root_path)) { return false; }
+  auto relative_path = absolute_path.substr(root_path.size());
+  if (relative_path.empty()) { return false; }
+  if (is_trash(relative_path)) { return true; }
+  if (prune_patterns.empty()) { return false; }
+  if (!relative_path.ends_with("/")) { relative_path.append("/"); }
+
+  return prune_patterns.matches(relative_path);
+}
+
 auto clone_config::has_conflict(path_node& root_node, fs::path const& path) const -> bool {
   path_node* current_node = &root_node;
 
@@ -187,6 +284,28 @@ auto clone_config::sanitize(fs::path const& path) -> void {
       e.what()
     );
   }
+
+  if (sync_log_format == log_format::undefined) {
+    throw_exception<errorcode::config>(
+      errorcode::config::invalid_log_format, "sync_log_format"
+    );
+  }
+
+  if (max_concurrent_syncs == 0) {
+    max_concurrent_syncs = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+
+  index_directory = log_directory / fs::path{"index"};
+
+  try {
+    fs::create_directories(index_directory);
+  } catch (fs::filesystem_error const& e) {
+    throw_exception<errorcode::filesystem>(
+      errorcode::filesystem::could_not_create_directory,
+      index_directory.string(),
+      e.what()
+    );
+  }
 }
   
 } // namespace dropclone
\ No newline at end of file
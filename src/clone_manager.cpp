@@ -6,25 +6,200 @@
 #include <dropclone/exception.hpp>
 #include <dropclone/clone_transaction.hpp>
 #include <dropclone/logger_manager.hpp>
+#include <dropclone/messagecode.hpp>
+#include <dropclone/delta_update.hpp>
+#include <dropclone/worker_pool.hpp>
 #include <filesystem>
 #include <ranges>
 #include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <vector>
+#include <array>
+#include <system_error>
 
 namespace dropclone {
 
 namespace fs = std::filesystem;
 namespace dc = dropclone;
 namespace rng = std::ranges;
+namespace chr = std::chrono;
 
-clone_manager::clone_manager(config_entry entry) 
+// number of files synchronized between two checks of the sync budget
+constexpr std::size_t budget_chunk_size{256};
+
+// watch cycles leave their steps in the journal; the whole index is only
+// rewritten once this many changes piled up or this much time passed
+constexpr std::size_t index_store_changes{4096};
+constexpr chr::seconds index_store_interval{30};
+
+clone_manager::clone_manager(config_entry entry, fs::path const& index_directory) 
   : source_snapshot_{entry.source_directory}, 
     destination_snapshot_{entry.destination_directory}, 
-    entry_{std::move(entry)}
-{}
+    entry_{std::move(entry)},
+    index_{snapshot_index::index_path(
+      index_directory, entry_.source_directory, entry_.destination_directory
+    )}
+{
+  // the watch is set up before the first full scan, so no event that
+  // happens after that scan started can get lost
+  if (entry_.watch) {
+    // the watcher outlives moves of this manager, so it keeps its own entry
+    watcher_ = std::make_unique<path_watcher>(entry_.source_directory, 
+      [entry = entry_](fs::path const& path) mutable { return entry.prune(path); }
+    );
+  }
+
+  // a crash between a delta update and the end of its transaction leaves
+  // journals behind; the files go back to their state before that sync
+  try {
+    if (auto const restored = recover_delta_journals(
+          delta_command::journal_root(entry_.destination_directory), entry_.destination_directory); 
+        restored != 0) {
+      logger.info<messagecode::sync, messagecode::sync::delta_recovered>(
+        logger_id::sync,
+        restored, entry_.destination_directory
+      );
+    }
+  } catch (fs::filesystem_error const& err) {
+    logger.get(logger_id::sync)->warn(
+      utility::formatter<errorcode::command>::format(
+        errorcode::command::delta_recovery_failed,
+        entry_.destination_directory.string(), err.what()
+    ));
+  }
+
+  if (entry_.compare != compare_strategy::metadata && entry_.mode == clone_mode::copy) {
+    auto cache_path = index_.path();
+    cache_path.replace_extension(".hashes");
+    hashes_ = std::make_unique<hash_cache>(cache_path);
+    hashes_->load();
+  }
+
+  if (auto indexed_snapshot = index_.load(entry_.source_directory)) {
+    source_snapshot_ = std::move(*indexed_snapshot);
+  }
+
+  auto journal_path = index_.path();
+  journal_path.replace_extension(".journal");
+  journal_ = std::make_unique<transaction_journal>(journal_path);
+  recover_transactions();
+
+  // trash left behind by a purge that did not finish before the last exit;
+  // only now, as the replay above still looks at renames into the trash
+  rng::for_each(std::array{entry_.source_directory, entry_.destination_directory}, [&](auto const& root) {
+    std::error_code error_code{};
+    if (auto trash = trash_purger::trash_root(root); fs::exists(trash, error_code)) {
+      purger_->purge(std::move(trash));
+    }
+  });
+}
+
+clone_manager::~clone_manager() {
+  // a moved-from manager has no journal and nothing to store
+  if (journal_ && unstored_changes_ != 0) { store_index(); }
+}
+
+// Replays the journal of work the last run did not finish. Steps still in
+// flight are rolled back: a partial copy is removed, and so are the
+// temporary files of an update – after a destination that a swap by name
+// left missing got its content back. Finished steps are rolled forward into the
+// snapshot, so the next sync does not redo them – except for the copy of a
+// move whose source still exists: its removal never happened, so the copy
+// goes and the file is moved again. The journal may span several watch
+// cycles; the last finished step of a path decides its entry.
+auto clone_manager::recover_transactions() -> void {
+  auto const steps = journal_->replay();
+  if (steps.empty()) { return; }
+
+  auto const relative = [&](fs::path const& path) -> fs::path {
+    auto const relative_path = path.lexically_relative(entry_.source_directory);
+    if (!relative_path.empty() && *rng::begin(relative_path) != "..") { return relative_path; }
+    return path.lexically_relative(entry_.destination_directory);
+  };
+
+  auto const is_complete = [](fs::path const& path, std::uintmax_t size) {
+    std::error_code error_code{};
+    return fs::file_size(path, error_code) == size && !error_code;
+  };
+
+  path_snapshot::snapshot_entries forwarded{};
+  path_changes applied{};
+  std::size_t rolled_back{0};
+
+  rng::for_each(steps, [&](auto const& step) {
+    std::error_code error_code{};
+
+    switch (step.kind) {
+      case transaction_journal::operation::copy:
+        if (!step.done || (entry_.mode == clone_mode::move && fs::exists(step.source, error_code))) {
+          if (fs::remove(step.destination, error_code)) { ++rolled_back; }
+        } else if (entry_.mode == clone_mode::copy && is_complete(step.destination, step.info.file_size)) {
+          forwarded.insert_or_assign(relative(step.source), step.info);
+          applied.push_back({relative(step.source), false});
+        }
+        break;
+
+      case transaction_journal::operation::update:
+        if (update_command::clean_up(step.destination) && !step.done) { ++rolled_back; }
+        if (step.done && is_complete(step.destination, step.info.file_size)) {
+          forwarded.insert_or_assign(relative(step.source), step.info);
+          applied.push_back({relative(step.source), false});
+        }
+        break;
+
+      // a rename happened completely or not at all
+      case transaction_journal::operation::rename:
+        if (step.done || (!fs::exists(step.source, error_code) && fs::exists(step.destination, error_code))) {
+          forwarded.erase(relative(step.source));
+          applied.push_back({relative(step.source), false});
+        }
+        break;
+    }
+  });
+
+  if (!applied.empty()) {
+    source_snapshot_.update(source_snapshot_.extract(applied), 
+                            path_snapshot{source_snapshot_.root(), forwarded});
+  }
+
+  logger.info<messagecode::sync, messagecode::sync::transaction_recovered>(
+    logger_id::sync,
+    entry_.source_directory, applied.size(), rolled_back
+  );
+
+  store_index();
+}
+
+// the journal only has to cover what the stored index does not
+auto clone_manager::store_index() -> void {
+  if (!index_.store(source_snapshot_)) { return; }
+  unstored_changes_ = 0;
+  index_stored_ = chr::steady_clock::now();
+
+  try {
+    journal_->reset();
+  } catch (fs::filesystem_error const&) {
+    // stale records are checked against the files on replay
+  }
+}
+
+// a watch cycle covers a few paths; rewriting the whole index for them
+// would cost as much as a full scan, so its journal records stand in for it
+auto clone_manager::store_index_when_due() -> void {
+  if (unstored_changes_ == 0) { return; }
+  if (unstored_changes_ < index_store_changes && 
+      chr::steady_clock::now() - index_stored_ < index_store_interval) { return; }
+  store_index();
+}
 
 auto clone_manager::copy(path_snapshot const& source_snapshot, fs::path const& destination_root) -> void {
   if (!source_snapshot.has_data()) { return; }
 
+  command_options const copy_command_options{entry_.copy_workers, statistics_.get(), entry_.io_uring, 
+                                            nullptr, journal_.get(), durability_.get(), metrics_.get()};
+
   auto const filter_added_path = [](auto const& entry) -> bool { 
       return entry.second.path_status == path_info::status::added || 
              entry.second.path_status == path_info::status::structurally_required;
@@ -33,32 +208,41 @@ auto clone_manager::copy(path_snapshot const& source_snapshot, fs::path const& d
   path_snapshot added_paths{source_snapshot.root()};
   added_paths.add_files(source_snapshot.files(), filter_added_path);
   added_paths.add_directories(source_snapshot.directories(), filter_added_path);
-  copy_command copy_added_paths{added_paths, destination_root};
+  copy_command copy_added_paths{added_paths, destination_root, behavior_policies::none, copy_command_options};
 
   auto const filter_updated_path = [](auto const& entry) -> bool { 
       return entry.second.path_status == path_info::status::updated;
   };
 
+  // large files that already exist in the destination are rewritten in
+  // place; all other updated files are copied next to their destination
+  // and swapped in
+  auto const filter_delta_path = [&](auto const& entry) -> bool { 
+      std::error_code error_code{};
+      return entry_.update_mode == update_mode::delta &&
+             entry.second.path_status == path_info::status::updated &&
+             entry.second.file_size >= entry_.delta_min_size &&
+             fs::is_regular_file(destination_root / entry.first, error_code);
+  };
+
+  path_snapshot delta_paths{source_snapshot.root()};
+  delta_paths.add_files(source_snapshot.files(), filter_delta_path);
+  delta_command update_delta_paths{delta_paths, destination_root, copy_command_options};
+
   path_snapshot updated_paths{source_snapshot.root()};
-  updated_paths.add_files(source_snapshot.files(), filter_updated_path);
+  updated_paths.add_files(source_snapshot.files(), [&](auto const& entry) {
+    return filter_updated_path(entry) && !delta_paths.files().contains(entry.first);
+  });
   updated_paths.add_directories(source_snapshot.directories(), filter_updated_path);
 
-  if (!added_paths.has_data() && !updated_paths.has_data()) { return; }
-
-  path_snapshot renamed_paths = updated_paths;
-  renamed_paths.rebase(destination_root);
-  auto const backup_path = destination_root / fs::path{".backup"};
-  rename_command rename_updated_paths{renamed_paths, backup_path}; 
+  if (!added_paths.has_data() && !updated_paths.has_data() && !delta_paths.has_data()) { return; }
 
-  copy_command copy_updated_paths{updated_paths, destination_root};
-  renamed_paths.rebase(backup_path);
-  remove_command remove_renamed_paths{renamed_paths};
+  update_command update_updated_paths{updated_paths, destination_root, copy_command_options};
 
-  clone_transaction copy_transaction{};
+  clone_transaction copy_transaction{journal_.get(), durability_.get(), metrics_.get()};
   copy_transaction.add(copy_added_paths);
-  copy_transaction.add(rename_updated_paths);
-  copy_transaction.add(copy_updated_paths);
-  copy_transaction.add(remove_renamed_paths);
+  copy_transaction.add(update_delta_paths);
+  copy_transaction.add(update_updated_paths);
 
   try {
     copy_transaction.start();
@@ -69,6 +253,8 @@ auto clone_manager::copy(path_snapshot const& source_snapshot, fs::path const& d
     );
   }
 
+  observe_commit_lag(source_snapshot);
+
   logger.get(logger_id::sync)->flush();
 }
 
@@ -84,8 +270,11 @@ auto clone_manager::remove(path_snapshot const& source_snapshot, fs::path const&
 
   if (!deleted_paths.has_data()) { return; }
 
-  remove_command remove_deleted_paths{deleted_paths};
-  clone_transaction move_transaction{};
+  command_options const options{entry_.copy_workers, nullptr, entry_.io_uring, purger_.get(), journal_.get(),
+                                nullptr, metrics_.get()};
+
+  remove_command remove_deleted_paths{deleted_paths, options};
+  clone_transaction move_transaction{journal_.get(), nullptr, metrics_.get()};
   move_transaction.add(remove_deleted_paths);
 
   try {
@@ -103,6 +292,11 @@ auto clone_manager::remove(path_snapshot const& source_snapshot, fs::path const&
 auto clone_manager::move(path_snapshot const& source_snapshot, fs::path const& destination_root) -> void {
   if (!source_snapshot.has_data()) { return; }
 
+  command_options const options{entry_.copy_workers, nullptr, entry_.io_uring, purger_.get(), journal_.get(),
+                                nullptr, metrics_.get()};
+  command_options const copy_command_options{entry_.copy_workers, statistics_.get(), entry_.io_uring, 
+                                            nullptr, journal_.get(), durability_.get(), metrics_.get()};
+
   auto const filter_added_path = [](auto const& entry) -> bool { 
       return entry.second.path_status == path_info::status::added ||
       entry.second.path_status == path_info::status::updated; 
@@ -111,14 +305,14 @@ auto clone_manager::move(path_snapshot const& source_snapshot, fs::path const& d
   path_snapshot added_paths{source_snapshot.root()};
   added_paths.add_files(source_snapshot.files(), filter_added_path);
   added_paths.add_directories(source_snapshot.directories(), filter_added_path);
-  copy_command copy_added_paths{added_paths, destination_root, behavior_policies::duplicate};
+  copy_command copy_added_paths{added_paths, destination_root, behavior_policies::duplicate, copy_command_options};
 
   rng::for_each(added_paths.directories(), [](auto& directory) {
     directory.second.path_status = path_info::status::structurally_required;
   });
-  remove_command remove_added_paths{added_paths};
+  remove_command remove_added_paths{added_paths, options};
 
-  clone_transaction remove_transaction{};
+  clone_transaction remove_transaction{journal_.get(), durability_.get(), metrics_.get()};
   remove_transaction.add(copy_added_paths);
   remove_transaction.add(remove_added_paths);
 
@@ -131,26 +325,319 @@ auto clone_manager::move(path_snapshot const& source_snapshot, fs::path const& d
     );
   }
 
+  observe_commit_lag(source_snapshot);
+
   logger.get(logger_id::sync)->flush();
 }
 
-auto clone_manager::sync() -> void {
-  auto current_source_snapshot = path_snapshot{source_snapshot_.root()};
-  current_source_snapshot.make([&](fs::path const& path) { return entry_.filter(path); });
-
-  if(source_snapshot_.hash() == current_source_snapshot.hash()) { return; }
-
-  auto diff_snapshot_update = current_source_snapshot.local_diff(source_snapshot_);
+auto clone_manager::watch_descriptor() const noexcept -> int {
+  return watcher_ && watcher_->is_active() ? watcher_->descriptor() : -1;
+}
 
-  if (entry_.mode == clone_mode::copy) { 
+auto clone_manager::synchronize(path_snapshot& previous_snapshot, 
+                                path_snapshot& current_snapshot) -> sync_result {
+  metrics_->add(sync_metrics::counter::syncs);
+
+  auto diff_snapshot_update = [&] {
+    sync_metrics::scoped_timer const timer{metrics_.get(), sync_metrics::histogram::diff};
+    return current_snapshot.local_diff(previous_snapshot);
+  }();
+  statistics_->reset();
+  durability_->reset();
+
+  if (hashes_) { verify_content(diff_snapshot_update, current_snapshot); }
+
+  if (entry_.sync_budget != chr::seconds::zero()) {
+    if (auto result = synchronize_in_chunks(diff_snapshot_update); !result.complete) {
+      record_metrics();
+      log_copy_statistics();
+      return result;
+    }
+  } else if (entry_.mode == clone_mode::copy) { 
     copy(diff_snapshot_update, entry_.destination_directory);
-    auto diff_snapshot_remove = source_snapshot_.local_diff(current_source_snapshot);
-    remove(diff_snapshot_remove, entry_.destination_directory); 
   } else if (entry_.mode == clone_mode::move) {
     move(diff_snapshot_update, entry_.destination_directory);
   }
 
-  source_snapshot_ = std::move(current_source_snapshot);
+  if (entry_.mode == clone_mode::copy) { 
+    auto diff_snapshot_remove = [&] {
+      sync_metrics::scoped_timer const timer{metrics_.get(), sync_metrics::histogram::diff};
+      return previous_snapshot.local_diff(current_snapshot);
+    }();
+    remove(diff_snapshot_remove, entry_.destination_directory); 
+  }
+
+  record_metrics();
+  log_copy_statistics();
+  return {};
+}
+
+auto clone_manager::record_metrics() -> void {
+  metrics_->add(sync_metrics::counter::files_copied, statistics_->total_files());
+  metrics_->add(sync_metrics::counter::bytes_copied, statistics_->total_bytes());
+  if (durability_->synced_files() != 0) { metrics_->observe(sync_metrics::histogram::fsync, durability_->sync_time()); }
+}
+
+// the time from the last change of each copied file to now, right after
+// the transaction that copied it committed
+auto clone_manager::observe_commit_lag(path_snapshot const& source_snapshot) -> void {
+  auto const now = chr::file_clock::now();
+  rng::for_each(source_snapshot.files(), [&](auto const& file) {
+    if (file.second.path_status != path_info::status::added && 
+        file.second.path_status != path_info::status::updated) { 
+      return; 
+    }
+    auto const lag = chr::duration_cast<chr::nanoseconds>(now - file.second.last_write_time);
+    metrics_->observe(sync_metrics::histogram::commit_lag, std::max(lag, chr::nanoseconds::zero()));
+  });
+}
+
+auto clone_manager::metrics() noexcept -> sync_metrics& { return *metrics_; }
+
+auto clone_manager::log_copy_statistics() const -> void {
+  if (statistics_->total_files() == 0) { return; }
+
+  logger.info<messagecode::sync, messagecode::sync::copy_summary>(
+    logger_id::sync,
+    statistics_->total_files(), statistics_->total_bytes(),
+    entry_.source_directory,
+    statistics_->files(copy_method::reflink),
+    statistics_->files(copy_method::copy_file_range),
+    statistics_->files(copy_method::sendfile),
+    statistics_->files(copy_method::buffered),
+    statistics_->files(copy_method::standard),
+    statistics_->files(copy_method::io_uring),
+    statistics_->files(copy_method::delta)
+  );
+
+  if (durability_->synced_files() == 0) { return; }
+
+  logger.info<messagecode::sync, messagecode::sync::durability_summary>(
+    logger_id::sync,
+    durability_->synced_files(), entry_.source_directory,
+    to_string(durability_->mode()),
+    chr::duration_cast<chr::milliseconds>(durability_->sync_time()).count()
+  );
+}
+
+// Decides by content digest instead of metadata which files of the diff
+// really have to be recopied – and, with compare_strategy::hash, which files
+// with unchanged metadata differ from their destination anyway.
+auto clone_manager::verify_content(path_snapshot& diff_snapshot, path_snapshot const& current_snapshot) -> void {
+  sync_metrics::scoped_timer const timer{metrics_.get(), sync_metrics::histogram::hash};
+
+  struct candidate {
+    fs::path path{};
+    bool metadata_changed{false};
+    std::optional<bool> same_content{};
+  };
+
+  std::vector<candidate> candidates{};
+  rng::for_each(diff_snapshot.files(), [&](auto const& file) {
+    if (file.second.path_status == path_info::status::updated) { candidates.push_back({file.first, true}); }
+  });
+
+  if (entry_.compare == compare_strategy::hash) {
+    rng::for_each(current_snapshot.entries(), [&](auto const& entry) {
+      if (!entry.second.is_directory && !diff_snapshot.files().contains(entry.first)) { 
+        candidates.push_back({entry.first, false}); 
+      }
+    });
+  }
+
+  if (candidates.empty()) { return; }
+
+  auto const compare = [&](candidate& file) {
+    auto const source_digest = hashes_->digest(entry_.source_directory / file.path);
+    auto const destination_digest = hashes_->digest(entry_.destination_directory / file.path);
+    if (source_digest && destination_digest) { file.same_content = *source_digest == *destination_digest; }
+  };
+
+  if (entry_.copy_workers <= 1 || candidates.size() < 2) {
+    rng::for_each(candidates, compare);
+  } else {
+    worker_pool pool{std::min(entry_.copy_workers, candidates.size())};
+    rng::for_each(candidates, [&](auto& file) { pool.submit([&] { compare(file); }); });
+    pool.wait();
+  }
+
+  std::size_t unchanged_files{0};
+  std::size_t changed_files{0};
+
+  rng::for_each(candidates, [&](auto const& file) {
+    if (!file.same_content) { return; }
+
+    if (file.metadata_changed && *file.same_content) {
+      // a permission change still needs the copy that carries it over
+      std::error_code error_code{};
+      auto const destination_perms = fs::status(entry_.destination_directory / file.path, error_code).permissions();
+      if (error_code || destination_perms != diff_snapshot.files().at(file.path).file_perms) { return; }
+
+      diff_snapshot.files().erase(file.path);
+      ++unchanged_files;
+    } else if (!file.metadata_changed && !*file.same_content) {
+      auto info = current_snapshot.entries().at(file.path);
+      info.path_status = path_info::status::updated;
+      diff_snapshot.files().insert_or_assign(file.path, info);
+      ++changed_files;
+    }
+  });
+
+  if (unchanged_files != 0 || changed_files != 0) {
+    logger.info<messagecode::sync, messagecode::sync::content_compared>(
+      logger_id::sync,
+      candidates.size(), entry_.source_directory, unchanged_files, changed_files
+    );
+  }
+
+  hashes_->store();
+}
+
+auto clone_manager::synchronize_in_chunks(path_snapshot const& diff_snapshot) -> sync_result {
+  auto const started = chr::steady_clock::now();
+  auto const accept_all = [](auto const&) { return true; };
+
+  sync_result result{};
+  auto const& files = diff_snapshot.files();
+  auto file = rng::begin(files);
+  std::size_t synchronized_files{0};
+
+  // all directories go with the first chunk, so every later chunk finds 
+  // the parent directories of its files in place
+  path_snapshot chunk{diff_snapshot.root()};
+  chunk.add_directories(diff_snapshot.directories(), accept_all);
+
+  for (;;) {
+    for (std::size_t count{0}; count != budget_chunk_size && file != rng::end(files); ++count, ++file) {
+      chunk.files().insert(*file);
+    }
+
+    if (entry_.mode == clone_mode::copy) { 
+      copy(chunk, entry_.destination_directory);
+    } else if (entry_.mode == clone_mode::move) {
+      move(chunk, entry_.destination_directory);
+    }
+
+    rng::for_each(chunk.directories(), [&](auto const& directory) {
+      result.applied.push_back({directory.first, false});
+    });
+    rng::for_each(chunk.files(), [&](auto const& chunk_file) {
+      result.applied.push_back({chunk_file.first, false});
+    });
+    synchronized_files += chunk.files().size();
+
+    if (file == rng::end(files)) { return result; }
+
+    if (chr::steady_clock::now() - started >= entry_.sync_budget) {
+      logger.info<messagecode::sync, messagecode::sync::sync_yielded>(
+        logger_id::sync,
+        entry_.sync_budget.count(), entry_.source_directory,
+        synchronized_files, files.size()
+      );
+
+      result.complete = false;
+      return result;
+    }
+
+    chunk = path_snapshot{diff_snapshot.root()};
+  }
+}
+
+auto clone_manager::log_pruned(path_snapshot const& snapshot) const -> void {
+  if (snapshot.pruned() == 0) { return; }
+
+  logger.debug<messagecode::sync, messagecode::sync::directories_pruned>(
+    logger_id::sync,
+    snapshot.pruned(), snapshot.root()
+  );
+}
+
+auto clone_manager::sync_changes(path_changes const& changes) -> bool {
+  if (changes.empty()) { return false; }
+
+  // if this cycle fails, the drained events are gone – the next cycle
+  // has to rescan to pick them up again
+  rescan_required_ = true;
+
+  auto previous_snapshot = source_snapshot_.extract(changes);
+  auto current_snapshot = path_snapshot{source_snapshot_.root()};
+  {
+    sync_metrics::scoped_timer const timer{metrics_.get(), sync_metrics::histogram::scan};
+    current_snapshot.make(changes, [&](fs::path const& path) { 
+      return entry_.filter(path); 
+    }, [&](fs::path const& path) { 
+      return entry_.prune(path); 
+    });
+  }
+  log_pruned(current_snapshot);
+
+  bool const changed = previous_snapshot.hash() != current_snapshot.hash() ||
+    previous_snapshot.entries().size() != current_snapshot.entries().size();
+  if (changed) {
+    auto const result = synchronize(previous_snapshot, current_snapshot);
+    if (!result.complete) {
+      // commit what was synchronized; the remaining changes are no longer
+      // queued in the watcher, so the next cycle picks them up by a rescan
+      source_snapshot_.update(previous_snapshot.extract(result.applied), 
+                              current_snapshot.extract(result.applied));
+      unstored_changes_ += result.applied.size();
+      return true;
+    }
+
+    source_snapshot_.update(previous_snapshot, current_snapshot);
+    unstored_changes_ += previous_snapshot.entries().size() + current_snapshot.entries().size();
+  }
+
+  rescan_required_ = false;
+  return changed;
+}
+
+auto clone_manager::sync() -> bool {
+  if (watcher_ && !rescan_required_) {
+    if (auto poll_result = watcher_->poll(); !poll_result.overflow) {
+      auto const changed = sync_changes(poll_result.changes);
+      store_index_when_due();
+      return changed;
+    }
+  } else if (watcher_) {
+    watcher_->poll(); // everything queued so far is covered by the full scan
+  }
+
+  rescan_required_ = true;
+
+  auto current_source_snapshot = path_snapshot{source_snapshot_.root()};
+  {
+    sync_metrics::scoped_timer const timer{metrics_.get(), sync_metrics::histogram::scan};
+    current_source_snapshot.make([&](fs::path const& path) { 
+      return entry_.filter(path); 
+    }, entry_.scan_threads, [&](fs::path const& path) { 
+      return entry_.prune(path); 
+    });
+  }
+  log_pruned(current_source_snapshot);
+
+  // compare_strategy::hash looks for content changes that left the
+  // metadata – and so the snapshot hash – untouched
+  bool const snapshot_changed = source_snapshot_.hash() != current_source_snapshot.hash();
+  if (snapshot_changed || (hashes_ && entry_.compare == compare_strategy::hash)) { 
+    auto const result = synchronize(source_snapshot_, current_source_snapshot);
+    if (!result.complete) {
+      // commit what was synchronized; the rest still differs from the next
+      // scan and continues in the next cycle
+      auto const previous_snapshot = source_snapshot_.extract(result.applied);
+      source_snapshot_.update(previous_snapshot, current_source_snapshot.extract(result.applied));
+      store_index();
+      return true;
+    }
+
+    if (snapshot_changed) {
+      source_snapshot_ = std::move(current_source_snapshot);
+      store_index();
+    }
+  }
+
+  rescan_required_ = false;
+  return snapshot_changed;
 }
 
 } // dropclone
\ No newline at end of file
@@ -5,6 +5,15 @@
 #include <dropclone/errorcode.hpp>
 #include <dropclone/messagecode.hpp>
 #include <dropclone/exception.hpp>
+#include <dropclone/worker_pool.hpp>
+#include <dropclone/delta_update.hpp>
+#include <dropclone/duplicate_name_index.hpp>
+#ifdef DROPCLONE_ENABLE_IO_URING
+#include <dropclone/io_uring_backend.hpp>
+#endif
+#include <fcntl.h>
+#include <cstdio>
+#include <cerrno>
 #include <chrono>
 #include <cstdint>
 #include <thread>
@@ -13,6 +22,14 @@
 #include <stdexcept>
 #include <algorithm>
 #include <functional>
+#include <optional>
+#include <mutex>
+#include <atomic>
+#include <exception>
+#include <utility>
+#include <vector>
+#include <string>
+#include <system_error>
 
 namespace dropclone {
 
@@ -22,29 +39,26 @@ namespace dc = dropclone;
 
 auto log_enter_command(std::string_view command_name, 
                        std::string_view function_name) -> void {
-  logger.get(logger_id::sync)->debug(
-    utility::formatter<messagecode::command>::format(
-      messagecode::command::enter_command, 
-      command_name, function_name
-  ));
+  logger.debug<messagecode::command, messagecode::command::enter_command>(
+    logger_id::sync,
+    command_name, function_name
+  );
 }
 
 auto log_leave_command(std::string_view command_name, 
                        std::string_view function_name) -> void {
-  logger.get(logger_id::sync)->debug(
-    utility::formatter<messagecode::command>::format(
-      messagecode::command::leave_command, 
-      command_name, function_name
-  ));
+  logger.debug<messagecode::command, messagecode::command::leave_command>(
+    logger_id::sync,
+    command_name, function_name
+  );
 }
 
 auto create_directory(fs::path const& directory_path) -> void {
   if (!fs::exists(directory_path)) { 
-    logger.get(logger_id::sync)->info(
-      utility::formatter<messagecode::command>::format(
-        messagecode::command::create_directory,
-        directory_path.string()
-    ));
+    logger.info<messagecode::command, messagecode::command::create_directory>(
+      logger_id::sync,
+      directory_path
+    );
 
     fs::create_directory(directory_path); 
   }
@@ -52,181 +66,493 @@ auto create_directory(fs::path const& directory_path) -> void {
 
 auto remove_directory(fs::path const& directory_path) -> void {
   if (fs::exists(directory_path)) { 
-    logger.get(logger_id::sync)->info(
-      utility::formatter<messagecode::command>::format(
-        messagecode::command::remove_directory, 
-        directory_path.string()
-    ));
+    logger.info<messagecode::command, messagecode::command::remove_directory>(
+      logger_id::sync,
+      directory_path
+    );
 
     fs::remove(directory_path);
   }
 }
 
+namespace {
+
+using file_entry = path_snapshot::snapshot_entries::value_type;
+using processed_files = std::vector<std::pair<fs::path, file_entry>>;
+
+auto record_processed(path_snapshot::snapshot_entries& files, processed_files const& done,
+                      bool extract_on_success, path_snapshot::snapshot_entries* processed) -> void {
+  rng::for_each(done, [&](auto const& entry) {
+    if (processed != nullptr) { processed->insert_or_assign(entry.second.first, entry.second.second); }
+    if (extract_on_success) { files.erase(entry.first); }
+  });
+}
+
+// Runs 'process' for every file, on up to options.workers threads. Files for
+// which 'process' returns a processed entry count as done: they are recorded 
+// in 'processed' and, with 'extract_on_success', extracted from 'files'. 
+// The first failure stops handing out further files; it is rethrown once
+// the files already in flight are finished and recorded.
+auto process_files(path_snapshot::snapshot_entries& files,
+                   command_options const& options,
+                   bool extract_on_success,
+                   path_snapshot::snapshot_entries* processed,
+                   std::function<std::optional<file_entry>(file_entry const&)> const& process) -> void {
+  processed_files done{};
+  std::exception_ptr failure{};
+
+  if (options.workers <= 1 || files.size() < 2) {
+    try {
+      rng::for_each(files, [&](auto const& entry) {
+        if (auto result = process(entry)) { done.emplace_back(entry.first, std::move(*result)); }
+      });
+    } catch (...) {
+      failure = std::current_exception();
+    }
+  } else {
+    std::mutex done_mutex{};
+    std::atomic_bool failed{false};
+    auto const workers = std::min(options.workers, files.size());
+    worker_pool pool{workers, 2 * workers};
+
+    for (auto const& entry : files) {
+      if (failed.load(std::memory_order_relaxed)) { break; }
+      pool.submit([&] {
+        if (failed.load(std::memory_order_relaxed)) { return; }
+        try {
+          if (auto result = process(entry)) {
+            std::lock_guard<std::mutex> done_guard{done_mutex};
+            done.emplace_back(entry.first, std::move(*result));
+          }
+        } catch (...) {
+          std::lock_guard<std::mutex> done_guard{done_mutex};
+          if (!failure) { failure = std::current_exception(); }
+          failed.store(true, std::memory_order_relaxed);
+        }
+      });
+    }
+    pool.wait();
+  }
+
+  record_processed(files, done, extract_on_success, processed);
+  if (failure) { std::rethrow_exception(failure); }
+}
+
+auto journal_begin(command_options const& options, transaction_journal::operation kind,
+                   fs::path const& from_path, fs::path const& to_path, path_info const& info) -> void {
+  if (options.journal == nullptr) { return; }
+  options.journal->begin(kind, from_path, to_path, info);
+  // per_file makes every record durable before the step touches the destination
+  if (options.durability != nullptr && options.durability->mode() == durability_mode::per_file) {
+    options.journal->sync();
+  }
+}
+
+auto journal_done(command_options const& options, transaction_journal::operation kind,
+                  fs::path const& from_path, fs::path const& to_path) -> void {
+  if (options.journal != nullptr) { options.journal->done(kind, from_path, to_path); }
+}
+
+auto journal_abandon(command_options const& options, transaction_journal::operation kind,
+                     fs::path const& from_path, fs::path const& to_path) -> void {
+  if (options.journal != nullptr) { options.journal->abandon(kind, from_path, to_path); }
+}
+
+auto track_written(command_options const& options, fs::path const& path) -> void {
+  if (options.durability != nullptr) { options.durability->written(path); }
+}
+
+// undo steps are never journaled; a crash during undo is recovered from the
+// records of the steps being undone
+auto without_journal(command_options options) -> command_options {
+  options.journal = nullptr;
+  return options;
+}
+
+auto log_copied_file(fs::path const& from_path, fs::path const& to_path, 
+                     copy_result const& result, command_options const& command_options) -> void {
+  logger.info<messagecode::command, messagecode::command::copy_file>(
+    logger_id::sync,
+    from_path,
+    to_path,
+    to_string(result.method)
+  );
+
+  if (command_options.statistics != nullptr) { command_options.statistics->record(result); }
+}
+
+// copies one file through the copy engine and reports the kernel path it took
+auto copy_file_entry(fs::path const& from_path, fs::path const& to_path, 
+               fs::copy_options options, command_options const& command_options) -> bool {
+  auto const result = clone_file(from_path, to_path, options);
+  if (!result) { return false; }
+
+  log_copied_file(from_path, to_path, *result, command_options);
+  return true;
+}
+
+// Swaps 'temporary_path' in as 'to_path'; the previous content of 'to_path',
+// if there was one, is left at 'temporary_path'.
+auto swap_in(fs::path const& temporary_path, fs::path const& to_path) -> void {
+  if (::renameat2(AT_FDCWD, temporary_path.c_str(), AT_FDCWD, to_path.c_str(), RENAME_EXCHANGE) == 0) { 
+    return; 
+  }
+
+  auto const error = errno;
+  if (error == ENOENT && !fs::exists(to_path)) { 
+    fs::rename(temporary_path, to_path); 
+    return;
+  }
+  if (error != EINVAL && error != ENOSYS && error != EOPNOTSUPP) {
+    throw fs::filesystem_error{"renameat2", temporary_path, to_path, 
+                               std::error_code{error, std::generic_category()}};
+  }
+
+  // the file system cannot exchange
+  update_command::swap_by_name(temporary_path, to_path);
+}
+
+// every removal gets its own trash directory, so a purge still running in
+// the background never sees files of a later removal
+auto unique_trash_path(fs::path const& root) -> fs::path {
+  static std::atomic<std::uint64_t> sequence{0};
+  auto const stamp = std::chrono::system_clock::now().time_since_epoch().count();
+  return trash_purger::trash_root(root) / 
+         fs::path{std::to_string(stamp) + "-" + std::to_string(sequence.fetch_add(1))};
+}
+
+#ifdef DROPCLONE_ENABLE_IO_URING
+auto io_uring_for(command_options const& options) -> io_uring_backend* {
+  return options.io_uring ? io_uring_backend::local() : nullptr;
+}
+
+// Hands all files to one io_uring batch. 'run' gets the entries in batch
+// order and reports every completed one by its index.
+auto process_files_batched(path_snapshot::snapshot_entries& files,
+                           bool extract_on_success,
+                           path_snapshot::snapshot_entries* processed,
+                           std::function<void(std::vector<file_entry const*> const&, 
+                                              io_uring_backend::completion const&)> const& run) -> void {
+  std::vector<file_entry const*> entries{};
+  entries.reserve(files.size());
+  rng::for_each(files, [&](auto const& entry) { entries.push_back(&entry); });
+
+  processed_files done{};
+  std::exception_ptr failure{};
+  try {
+    run(entries, [&](std::size_t index) { done.emplace_back(entries[index]->first, *entries[index]); });
+  } catch (...) {
+    failure = std::current_exception();
+  }
+
+  record_processed(files, done, extract_on_success, processed);
+  if (failure) { std::rethrow_exception(failure); }
+}
+
+template <typename directories_type>
+auto collect_paths(directories_type const& directories, fs::path const& root) -> std::vector<fs::path> {
+  std::vector<fs::path> paths{};
+  paths.reserve(directories.size());
+  rng::for_each(directories, [&](auto const* directory) { paths.push_back(root / directory->first); });
+  return paths;
+}
+#endif
+
+} // namespace
+
 auto create_directories(path_snapshot::snapshot_directories& directories, 
                         fs::path const& destination_root, 
-                        bool extract_on_success) -> void {
-  rng::for_each(directories, [&](auto const& entry) {
-    if(auto const directory_path = destination_root / entry.first; 
-       !fs::exists(directory_path)) {
-
-      logger.get(logger_id::sync)->info(
-        utility::formatter<messagecode::command>::format(
-          messagecode::command::create_directory, 
-          directory_path.string()
-      ));
+                        bool extract_on_success,
+                        [[maybe_unused]] command_options const& command_options) -> void {
+  auto const log_created = [](fs::path const& directory_path) {
+    logger.info<messagecode::command, messagecode::command::create_directory>(
+      logger_id::sync,
+      directory_path
+    );
+  };
 
-      fs::create_directories(directory_path);
-      if (extract_on_success) { 
-        directories.extract(entry.first); 
+  std::vector<fs::path> created{};
+
+#ifdef DROPCLONE_ENABLE_IO_URING
+  if (auto* const backend = io_uring_for(command_options); backend != nullptr) {
+    std::vector<path_snapshot::snapshot_directories::value_type const*> entries{};
+    rng::for_each(directories, [&](auto const& entry) { entries.push_back(&entry); });
+    auto const paths = collect_paths(entries, destination_root);
+
+    backend->create_directories(paths, [&](std::size_t index) {
+      log_created(paths[index]);
+      created.push_back(entries[index]->first);
+    });
+  } else
+#endif
+  {
+    rng::for_each(directories, [&](auto const& entry) {
+      if(auto const directory_path = destination_root / entry.first; 
+         !fs::exists(directory_path)) {
+        log_created(directory_path);
+        fs::create_directories(directory_path);
+        created.push_back(entry.first);
       }
-    }
-  });
+    });
+  }
+
+  if (extract_on_success) {
+    rng::for_each(created, [&](auto const& directory) { directories.extract(directory); });
+  }
 }
 
 auto remove_directories(path_snapshot::snapshot_directories& directories,
                         fs::path const& source_root,
-                        bool extract_on_success) -> void {
-  rng::for_each(rng::crbegin(directories), rng::crend(directories),
-    [&] (auto const& entry) { 
-      if(auto const directory_path = source_root / entry.first; fs::exists(directory_path) && 
-         entry.second.path_status != path_info::status::structurally_required) {
-
-        logger.get(logger_id::sync)->info(
-          utility::formatter<messagecode::command>::format(
-            messagecode::command::remove_directory, 
-            directory_path.string() 
-        ));
+                        bool extract_on_success,
+                        [[maybe_unused]] command_options const& command_options) -> void {
+  auto const log_removed = [](fs::path const& directory_path) {
+    logger.info<messagecode::command, messagecode::command::remove_directory>(
+      logger_id::sync,
+      directory_path
+    );
+  };
+
+  std::vector<fs::path> removed{};
+
+#ifdef DROPCLONE_ENABLE_IO_URING
+  if (auto* const backend = io_uring_for(command_options); backend != nullptr) {
+    std::vector<path_snapshot::snapshot_directories::value_type const*> entries{};
+    rng::for_each(directories, [&](auto const& entry) {
+      if (entry.second.path_status != path_info::status::structurally_required) { entries.push_back(&entry); }
+    });
+    auto const paths = collect_paths(entries, source_root);
 
-        fs::remove(directory_path);
-        if (extract_on_success) {
-          directories.extract(entry.first);
+    backend->remove_directories(paths, [&](std::size_t index) {
+      log_removed(paths[index]);
+      removed.push_back(entries[index]->first);
+    });
+  } else
+#endif
+  {
+    rng::for_each(rng::crbegin(directories), rng::crend(directories),
+      [&] (auto const& entry) { 
+        if(auto const directory_path = source_root / entry.first; fs::exists(directory_path) && 
+           entry.second.path_status != path_info::status::structurally_required) {
+          log_removed(directory_path);
+          fs::remove(directory_path);
+          removed.push_back(entry.first);
         }
-      }
-  });
+    });
+  }
+
+  if (extract_on_success) {
+    rng::for_each(removed, [&](auto const& directory) { directories.extract(directory); });
+  }
 }
 
 auto copy_files(path_snapshot::snapshot_entries& files, 
                 fs::path const& source_root, 
                 fs::path const& destination_root,
                 bool extract_on_success, 
-                fs::copy_options options) -> void {
-  rng::for_each(files, [&](auto const& entry) {
-    auto const to_path = destination_root / entry.first; 
-
-    bool const not_exists = (options == fs::copy_options::none) && !fs::exists(to_path);
-    bool const is_overwrite = (options & fs::copy_options::overwrite_existing) != fs::copy_options::none;
-    bool const is_update = (options & fs::copy_options::update_existing) != fs::copy_options::none;
-    bool const is_skip = (options & fs::copy_options::skip_existing) != fs::copy_options::none;
+                fs::copy_options options,
+                command_options const& command_options,
+                path_snapshot::snapshot_entries* processed) -> void {
+  bool const is_overwrite = (options & fs::copy_options::overwrite_existing) != fs::copy_options::none;
+  bool const is_update = (options & fs::copy_options::update_existing) != fs::copy_options::none;
+  bool const is_skip = (options & fs::copy_options::skip_existing) != fs::copy_options::none;
+
+#ifdef DROPCLONE_ENABLE_IO_URING
+  if (auto* const backend = io_uring_for(command_options); 
+      backend != nullptr && (options == fs::copy_options::none || options == fs::copy_options::overwrite_existing)) {
+    process_files_batched(files, extract_on_success, processed, [&](auto const& entries, auto const& on_done) {
+      std::vector<io_uring_backend::path_pair> copies{};
+      std::vector<bool> begun(entries.size());
+      std::vector<bool> copied(entries.size());
+      copies.reserve(entries.size());
+      rng::for_each(entries, [&](auto const* entry) {
+        copies.push_back({source_root / entry->first, destination_root / entry->first});
+        // a file that already exists is refused, not written
+        if (is_overwrite || !fs::exists(copies.back().to)) {
+          journal_begin(command_options, transaction_journal::operation::copy, 
+                        copies.back().from, copies.back().to, entry->second);
+          begun[copies.size() - 1] = true;
+        }
+      });
+
+      backend->copy_files(copies, is_overwrite, [&](std::size_t index, copy_result const& result) {
+        log_copied_file(copies[index].from, copies[index].to, result, command_options);
+        journal_done(command_options, transaction_journal::operation::copy, copies[index].from, copies[index].to);
+        track_written(command_options, copies[index].to);
+        copied[index] = true;
+        on_done(index);
+      });
+
+      // a destination that appeared in the meantime was kept
+      for (std::size_t index{0}; index != copies.size(); ++index) {
+        if (begun[index] && !copied[index]) {
+          journal_abandon(command_options, transaction_journal::operation::copy, copies[index].from, copies[index].to);
+        }
+      }
+    });
+    return;
+  }
+#endif
 
-    if (!is_skip && (not_exists || is_overwrite || is_update)) {
-      auto const from_path = source_root / entry.first; 
+  process_files(files, command_options, extract_on_success, processed, 
+    [&](auto const& entry) -> std::optional<file_entry> {
+      auto const to_path = destination_root / entry.first; 
+      bool const not_exists = (options == fs::copy_options::none) && !fs::exists(to_path);
 
-      logger.get(logger_id::sync)->info(
-        utility::formatter<messagecode::command>::format(
-          messagecode::command::copy_file, 
-          from_path.string(), 
-          to_path.string()
-      ));
+      if (is_skip || !(not_exists || is_overwrite || is_update)) { return std::nullopt; }
 
-      fs::copy(from_path, to_path, options);
-      if (extract_on_success) {
-        files.extract(entry.first);
+      auto const from_path = source_root / entry.first; 
+      journal_begin(command_options, transaction_journal::operation::copy, from_path, to_path, entry.second);
+      if (!copy_file_entry(from_path, to_path, options, command_options)) {
+        journal_abandon(command_options, transaction_journal::operation::copy, from_path, to_path);
+        return std::nullopt;
       }
+      journal_done(command_options, transaction_journal::operation::copy, from_path, to_path);
+      track_written(command_options, to_path);
+      return entry;
     }
-  });
+  );
 }
 
 auto copy_duplicate(path_snapshot::snapshot_entries& files, 
                     fs::path const& source_root, 
-                    fs::path const& destination_root) -> void {
-  auto const files_copy = files; // copy because original modified in loop
-  rng::for_each(files_copy, [&](auto const& entry) {
-    auto file_name = entry.first.filename();
-    auto const stem = file_name.stem().string(); 
-    auto const extension = file_name.extension().string();
-
-    auto to_path = destination_root / entry.first;
-    auto const file_parent_path = entry.first.parent_path();
-
-    for (auto num{1}; fs::exists(to_path); ++num) {
-      file_name = fs::path{stem + "_" + std::to_string(num) + extension};
-      to_path = destination_root / file_parent_path / file_name;
-    }
-
-    auto const from_path = source_root / entry.first; 
-
-    logger.get(logger_id::sync)->info(
-      utility::formatter<messagecode::command>::format(
-        messagecode::command::copy_file, 
-        from_path.string(), 
-        to_path.string()
-    ));
+                    fs::path const& destination_root,
+                    command_options const& command_options,
+                    path_snapshot::snapshot_entries* processed) -> void {
+  // names are reserved in the index before copying, so the files of one
+  // batch never compete for the same free name and may be copied in parallel
+  duplicate_name_index names{destination_root};
+  path_snapshot::snapshot_entries copied{};
+
+  auto const record_copied = [&] {
+    rng::for_each(copied, [&](auto const& entry) {
+      files.try_emplace(entry.first, entry.second);
+      if (processed != nullptr) { processed->try_emplace(entry.first, entry.second); }
+    });
+  };
 
-    fs::copy(from_path, to_path);
+  try {
+    process_files(files, command_options, false, &copied, 
+      [&](auto const& entry) -> std::optional<file_entry> {
+        auto const to_relative_path = names.allocate(entry.first);
+        auto const from_path = source_root / entry.first;
+        auto const to_path = destination_root / to_relative_path;
+        journal_begin(command_options, transaction_journal::operation::copy, from_path, to_path, entry.second);
+        if (!copy_file_entry(from_path, to_path, fs::copy_options::none, command_options)) {
+          journal_abandon(command_options, transaction_journal::operation::copy, from_path, to_path);
+          return std::nullopt;
+        }
+        journal_done(command_options, transaction_journal::operation::copy, from_path, to_path);
+        track_written(command_options, to_path);
+        return file_entry{to_relative_path, entry.second};
+      }
+    );
+  } catch (...) {
+    record_copied();
+    throw;
+  }
 
-    files.try_emplace(file_parent_path / file_name, entry.second);
-  });
+  record_copied();
 }
 
 auto rename_files(path_snapshot::snapshot_entries& files, 
                   fs::path const& source_root, 
                   fs::path const& destination_root,
-                  bool extract_on_success) -> void {
-  rng::for_each(files, [&](auto const& entry) {
-    if (auto const from_path = source_root / entry.first; 
-        fs::exists(from_path)) {
+                  bool extract_on_success,
+                  command_options const& command_options,
+                  path_snapshot::snapshot_entries* processed) -> void {
+#ifdef DROPCLONE_ENABLE_IO_URING
+  if (auto* const backend = io_uring_for(command_options); backend != nullptr) {
+    process_files_batched(files, extract_on_success, processed, [&](auto const& entries, auto const& on_done) {
+      std::vector<io_uring_backend::path_pair> renames{};
+      renames.reserve(entries.size());
+      rng::for_each(entries, [&](auto const* entry) {
+        renames.push_back({source_root / entry->first, destination_root / entry->first});
+        journal_begin(command_options, transaction_journal::operation::rename, 
+                      renames.back().from, renames.back().to, entry->second);
+      });
+
+      backend->rename_files(renames, [&](std::size_t index) {
+        logger.info<messagecode::command, messagecode::command::rename_file>(
+          logger_id::sync,
+          renames[index].from,
+          renames[index].to
+        );
+        journal_done(command_options, transaction_journal::operation::rename, renames[index].from, renames[index].to);
+        on_done(index);
+      });
+    });
+    return;
+  }
+#endif
+
+  process_files(files, command_options, extract_on_success, processed, 
+    [&](auto const& entry) -> std::optional<file_entry> {
+      auto const from_path = source_root / entry.first; 
+      if (!fs::exists(from_path)) { return std::nullopt; }
 
       auto const to_path = destination_root / entry.first;
 
-      logger.get(logger_id::sync)->info(
-        utility::formatter<messagecode::command>::format(
-          messagecode::command::rename_file, 
-          from_path.string(), 
-          to_path.string() 
-      ));
+      logger.info<messagecode::command, messagecode::command::rename_file>(
+        logger_id::sync,
+        from_path,
+        to_path
+      );
 
+      journal_begin(command_options, transaction_journal::operation::rename, from_path, to_path, entry.second);
       fs::rename(from_path, to_path);
-      if (extract_on_success) {
-        files.extract(entry.first);
-      }
+      journal_done(command_options, transaction_journal::operation::rename, from_path, to_path);
+      return entry;
     }
-  });
+  );
 }
 
 auto remove_files(path_snapshot::snapshot_entries& files, 
                   fs::path const& source_root,
-                  bool extract_on_success) -> void {
-  rng::for_each(files, [&](auto const& entry) {
-    if (auto const entry_path = source_root / entry.first; 
-        fs::exists(entry_path)) {
-
-      logger.get(logger_id::sync)->info(
-        utility::formatter<messagecode::command>::format(
-          messagecode::command::remove_file, 
-          entry_path.string() 
-      ));
+                  bool extract_on_success,
+                  command_options const& command_options,
+                  path_snapshot::snapshot_entries* processed) -> void {
+#ifdef DROPCLONE_ENABLE_IO_URING
+  if (auto* const backend = io_uring_for(command_options); backend != nullptr) {
+    process_files_batched(files, extract_on_success, processed, [&](auto const& entries, auto const& on_done) {
+      std::vector<fs::path> paths{};
+      paths.reserve(entries.size());
+      rng::for_each(entries, [&](auto const* entry) { paths.push_back(source_root / entry->first); });
+
+      backend->remove_files(paths, [&](std::size_t index) {
+        logger.info<messagecode::command, messagecode::command::remove_file>(logger_id::sync, paths[index]);
+        on_done(index);
+      });
+    });
+    return;
+  }
+#endif
+
+  process_files(files, command_options, extract_on_success, processed, 
+    [&](auto const& entry) -> std::optional<file_entry> {
+      auto const entry_path = source_root / entry.first; 
+      if (!fs::exists(entry_path)) { return std::nullopt; }
+
+      logger.info<messagecode::command, messagecode::command::remove_file>(logger_id::sync, entry_path);
 
       fs::remove(entry_path);
-      if (extract_on_success) {
-        files.extract(entry.first);
-      }
+      return entry;
     }
-  });
+  );
 }
 
 auto command_base::execute(std::string_view command_name, 
                            std::string_view errorcode, 
                            std::function<void(void)> execute) -> void {
+  sync_metrics::scoped_timer const timer{
+    options_.metrics, sync_metrics::command_histogram(command_name, false)
+  };
+
   try {
     log_enter_command(command_name, "execute");
 
     if (execute_status_ == command_status::failure ||
         undo_status_ == command_status::failure) {
-      logger.get(logger_id::sync)->warn(
-        utility::formatter<messagecode::command>::format(
-          messagecode::command::execute_skipped,
-          command_name
-      ));
+      logger.warn<messagecode::command, messagecode::command::execute_skipped>(logger_id::sync, command_name);
   
       log_leave_command(command_name, "execute");
 
@@ -271,16 +597,16 @@ auto command_base::execute(std::string_view command_name,
 auto command_base::undo(std::string_view command_name, 
                         std::string_view errorcode,
                         std::function<void(void)> undo) -> void {
+  sync_metrics::scoped_timer const timer{
+    options_.metrics, sync_metrics::command_histogram(command_name, true)
+  };
+
   try {
     log_enter_command(command_name, "undo");
 
     if (execute_status_ == command_status::uninitialized ||
         undo_status_ == command_status::success) {
-      logger.get(logger_id::sync)->warn(
-        utility::formatter<messagecode::command>::format(
-          messagecode::command::undo_skipped,
-          command_name
-      ));
+      logger.warn<messagecode::command, messagecode::command::undo_skipped>(logger_id::sync, command_name);
 
       log_leave_command(command_name, "undo");
 
@@ -315,11 +641,12 @@ auto command_base::undo(std::string_view command_name,
 auto copy_command::execute() -> void {
   command_base::execute("copy_command", errorcode::command::copy_command_failed, 
     [&] {
-      create_directories(snapshot_.directories(), destination_root_);
+      create_directories(snapshot_.directories(), destination_root_, false, options_);
       if (behavior_policy_ == behavior_policies::none) {
-        copy_files(snapshot_.files(), snapshot_.root(), destination_root_);
+        copy_files(snapshot_.files(), snapshot_.root(), destination_root_, 
+                   false, fs::copy_options::none, options_, &copied_);
       } else if (behavior_policy_ == behavior_policies::duplicate) { 
-        copy_duplicate(snapshot_.files(), snapshot_.root(), destination_root_);
+        copy_duplicate(snapshot_.files(), snapshot_.root(), destination_root_, options_, &copied_);
       }
     }
   );
@@ -328,8 +655,8 @@ auto copy_command::execute() -> void {
 auto copy_command::undo() -> void {
   command_base::undo("copy_command", errorcode::command::copy_command_failed,
     [&] {
-      remove_files(snapshot_.files(), destination_root_, true);
-      remove_directories(snapshot_.directories(), destination_root_, true);
+      remove_files(copied_, destination_root_, true, options_);
+      remove_directories(snapshot_.directories(), destination_root_, true, options_);
     }
   );
 }
@@ -341,18 +668,17 @@ auto rename_command::execute() -> void {
       auto& directories = snapshot_.directories();
   
       if (files.empty() && directories.empty()) { 
-        logger.get(logger_id::sync)->debug(
-          utility::formatter<messagecode::command>::format(
-            messagecode::command::leave_command, 
-            "rename_command", "execute"
-        ));
+        logger.debug<messagecode::command, messagecode::command::leave_command>(
+          logger_id::sync,
+          "rename_command", "execute"
+        );
   
         return; 
       }
   
       dc::create_directory(destination_root_);
-      create_directories(directories, destination_root_);
-      rename_files(files, snapshot_.root(), destination_root_);
+      create_directories(directories, destination_root_, false, options_);
+      rename_files(files, snapshot_.root(), destination_root_, false, options_, &renamed_);
     }
   );
 }
@@ -360,8 +686,8 @@ auto rename_command::execute() -> void {
 auto rename_command::undo() -> void {
   command_base::undo("rename_command", errorcode::command::rename_command_failed,
     [&] {
-      rename_files(snapshot_.files(), destination_root_, snapshot_.root(), true);
-      remove_directories(snapshot_.directories(), destination_root_, true);
+      rename_files(renamed_, destination_root_, snapshot_.root(), true, without_journal(options_));
+      remove_directories(snapshot_.directories(), destination_root_, true, options_);
       remove_directory(destination_root_);
     }
   );
@@ -371,44 +697,21 @@ auto remove_command::execute() -> void {
   command_base::execute("remove_command", errorcode::command::remove_command_failed, 
     [&] {
       if (!fs::exists(snapshot_.root())) { 
-        logger.get(logger_id::sync)->debug(
-          utility::formatter<messagecode::command>::format(
-            messagecode::command::leave_command, 
-            "remove_command", "execute"
-        ));
+        logger.debug<messagecode::command, messagecode::command::leave_command>(
+          logger_id::sync,
+          "remove_command", "execute"
+        );
   
         return; 
       }
     
       auto const& source_root = snapshot_.root();
-      auto const trash_path = source_root / fs::path{".trash"};
-  
-      dc::create_directory(trash_path);
-      create_directories(snapshot_.directories(), trash_path);
-      copy_files(snapshot_.files(), source_root, trash_path, 
-                false, fs::copy_options::overwrite_existing);
-      remove_files(snapshot_.files(), snapshot_.root());
-      remove_directories(snapshot_.directories(), snapshot_.root());
+      trash_path_ = unique_trash_path(source_root);
   
-      execute_status_ = command_status::success; 
-  
-      logger.get(logger_id::sync)->info(
-        utility::formatter<messagecode::command>::format(
-          messagecode::command::remove_directory,
-          trash_path.string()
-      ));
-
-      fs::remove_all(trash_path);
-
-      if (fs::is_empty(source_root)) {
-        logger.get(logger_id::sync)->info(
-          utility::formatter<messagecode::command>::format(
-            messagecode::command::remove_directory,
-            source_root.string()
-        ));
-
-        fs::remove(source_root);
-      }
+      fs::create_directories(trash_path_);
+      create_directories(snapshot_.directories(), trash_path_, false, options_);
+      rename_files(snapshot_.files(), source_root, trash_path_, false, options_, &trashed_);
+      remove_directories(snapshot_.directories(), source_root, false, options_);
     }
   );
 }
@@ -416,32 +719,237 @@ auto remove_command::execute() -> void {
 auto remove_command::undo() -> void {
   command_base::undo("remove_command", errorcode::command::remove_command_failed,
     [&] {
-      auto const& trash_path = snapshot_.root() / fs::path{".trash"};
-
-      if (!fs::exists(trash_path)) {
-        logger.get(logger_id::sync)->debug(
-          utility::formatter<messagecode::command>::format(
-            messagecode::command::leave_command, 
-            "remove_command", "undo"
-        ));
+      if (trash_path_.empty() || !fs::exists(trash_path_)) {
+        logger.debug<messagecode::command, messagecode::command::leave_command>(
+          logger_id::sync,
+          "remove_command", "undo"
+        );
   
         return;
       }
   
-      create_directories(snapshot_.directories(), snapshot_.root(), true);
-      copy_files(snapshot_.files(), trash_path, snapshot_.root(), true);
+      create_directories(snapshot_.directories(), snapshot_.root(), true, options_);
+      rename_files(trashed_, trash_path_, snapshot_.root(), true, without_journal(options_));
   
-      logger.get(logger_id::sync)->info(
-        utility::formatter<messagecode::command>::format(
-          messagecode::command::remove_directory,
-          trash_path.string()
+      // only the directory skeleton is left in the trash
+      fs::remove_all(trash_path_);
+      trash_purger::remove_empty(trash_path_, {});
+    }
+  );
+}
+
+auto remove_command::commit() -> void {
+  if (trash_path_.empty()) { return; }
+
+  if (options_.purger != nullptr) {
+    options_.purger->purge(trash_path_, snapshot_.root());
+  } else {
+    try {
+      auto const removed = trash_purger::purge_now(trash_path_, options_.workers);
+      trash_purger::remove_empty(trash_path_, snapshot_.root());
+
+      logger.info<messagecode::command, messagecode::command::trash_purged>(
+        logger_id::sync,
+        trash_path_, removed
+      );
+    } catch (fs::filesystem_error const& err) {
+      logger.get(logger_id::sync)->error(
+        utility::formatter<errorcode::command>::format(
+          errorcode::command::trash_purge_failed,
+          trash_path_.string(), err.what()
       ));
-  
-      fs::remove_all(trash_path);
+    }
+  }
+
+  trash_path_.clear();
+  trashed_.clear();
+}
+
+auto delta_command::journal_root(fs::path const& destination_root) -> fs::path {
+  return destination_root / fs::path{".delta"};
+}
+
+auto delta_command::execute() -> void {
+  command_base::execute("delta_command", errorcode::command::delta_command_failed, 
+    [&] {
+      auto const journals = journal_root(destination_root_);
+
+      process_files(snapshot_.files(), options_, false, &updated_, 
+        [&](auto const& entry) -> std::optional<file_entry> {
+          auto const from_path = snapshot_.root() / entry.first;
+          auto const to_path = destination_root_ / entry.first;
+          auto const journal_path = journals / entry.first;
+          fs::create_directories(journal_path.parent_path());
+
+          auto const result = delta_update(from_path, to_path, journal_path);
+          track_written(options_, to_path);
+
+          logger.info<messagecode::command, messagecode::command::delta_file>(
+            logger_id::sync,
+            from_path,
+            to_path,
+            result.changed_blocks,
+            result.blocks
+          );
+
+          if (options_.statistics != nullptr) { 
+            options_.statistics->record({copy_method::delta, result.bytes_written}); 
+          }
+          return entry;
+        }
+      );
+    }
+  );
+}
+
+auto delta_command::undo() -> void {
+  command_base::undo("delta_command", errorcode::command::delta_command_failed,
+    [&] {
+      rng::for_each(updated_, [&](auto const& entry) {
+        logger.info<messagecode::command, messagecode::command::restore_file>(
+          logger_id::sync,
+          (destination_root_ / entry.first)
+        );
+      });
+
+      // also covers a file whose update failed and could not be restored
+      // right away
+      recover_delta_journals(journal_root(destination_root_), destination_root_);
+    }
+  );
+}
+
+auto delta_command::commit() -> void {
+  std::error_code error_code{};
+  fs::remove_all(journal_root(destination_root_), error_code);
+}
+
+auto update_command::temporary_path(fs::path const& destination_path) -> fs::path {
+  return destination_path.parent_path() / 
+         fs::path{"." + destination_path.filename().string() + ".dctmp"};
+}
+
+auto update_command::parked_path(fs::path const& destination_path) -> fs::path {
+  return temporary_path(destination_path).concat(".new");
+}
+
+auto update_command::swap_by_name(fs::path const& temporary_path, fs::path const& to_path) -> void {
+  auto const parked = parked_path(to_path);
+  fs::rename(temporary_path, parked);
+
+  try {
+    fs::rename(to_path, temporary_path);
+  } catch (fs::filesystem_error const&) {
+    std::error_code error_code{};
+    fs::rename(parked, temporary_path, error_code);
+    throw;
+  }
+
+  try {
+    fs::rename(parked, to_path);
+  } catch (fs::filesystem_error const&) {
+    std::error_code error_code{};
+    fs::rename(temporary_path, to_path, error_code);
+    if (!error_code) { fs::rename(parked, temporary_path, error_code); }
+    throw;
+  }
+}
+
+auto update_command::clean_up(fs::path const& destination_path) -> bool {
+  auto const swap_path = temporary_path(destination_path);
+  auto const parked = parked_path(destination_path);
+  bool left{false};
+
+  std::error_code error_code{};
+  if (!fs::exists(destination_path, error_code)) {
+    for (auto const& candidate : {parked, swap_path}) {
+      if (fs::exists(candidate, error_code)) {
+        fs::rename(candidate, destination_path, error_code);
+        left = true;
+        break;
+      }
+    }
+  }
+  if (fs::remove(parked, error_code)) { left = true; }
+  if (fs::remove(swap_path, error_code)) { left = true; }
+  return left;
+}
+
+auto update_command::execute() -> void {
+  command_base::execute("update_command", errorcode::command::update_command_failed, 
+    [&] {
+      create_directories(snapshot_.directories(), destination_root_, false, options_);
+
+      process_files(snapshot_.files(), options_, false, &updated_, 
+        [&](auto const& entry) -> std::optional<file_entry> {
+          auto const from_path = snapshot_.root() / entry.first;
+          auto const to_path = destination_root_ / entry.first;
+          auto const swap_path = temporary_path(to_path);
+
+          journal_begin(options_, transaction_journal::operation::update, from_path, to_path, entry.second);
+          if (!copy_file_entry(from_path, swap_path, fs::copy_options::overwrite_existing, options_)) { 
+            return std::nullopt; 
+          }
+
+          try {
+            // per file, the new content is on disk before it replaces the old
+            if (options_.durability != nullptr && options_.durability->mode() == durability_mode::per_file) {
+              options_.durability->written(swap_path);
+            }
+            swap_in(swap_path, to_path);
+          } catch (...) {
+            // a swap that could not restore the destination leaves its old content at swap_path
+            std::error_code error_code{};
+            fs::remove(parked_path(to_path), error_code);
+            if (fs::exists(to_path, error_code)) { fs::remove(swap_path, error_code); }
+            throw;
+          }
+          journal_done(options_, transaction_journal::operation::update, from_path, to_path);
+          if (options_.durability != nullptr && options_.durability->mode() != durability_mode::per_file) {
+            options_.durability->written(to_path);
+          }
+
+          logger.info<messagecode::command, messagecode::command::swap_file>(
+            logger_id::sync,
+            swap_path,
+            to_path
+          );
+          return entry;
+        }
+      );
     }
   );
 }
 
+auto update_command::undo() -> void {
+  command_base::undo("update_command", errorcode::command::update_command_failed,
+    [&] {
+      // restored files are dropped right away, so a retried undo does not
+      // touch them again
+      for (auto entry = std::begin(updated_); entry != std::end(updated_); entry = updated_.erase(entry)) {
+        auto const to_path = destination_root_ / entry->first;
+        auto const swap_path = temporary_path(to_path);
+
+        logger.info<messagecode::command, messagecode::command::restore_swapped>(logger_id::sync, to_path);
+
+        if (fs::exists(swap_path)) { 
+          fs::rename(swap_path, to_path); 
+        } else { 
+          fs::remove(to_path); 
+        }
+      }
+    }
+  );
+}
+
+auto update_command::commit() -> void {
+  rng::for_each(updated_, [&](auto const& entry) {
+    std::error_code error_code{};
+    fs::remove(temporary_path(destination_root_ / entry.first), error_code);
+  });
+  updated_.clear();
+}
+
 auto clone_transaction::try_undo(clone_command command, 
                                  std::uint8_t max_retries) -> void {
   std::visit([&](auto& cmd) { 
@@ -501,6 +1009,8 @@ auto clone_transaction::reset_command_statuses() -> void {
 auto clone_transaction::start() -> void {
   if (commands_.empty()) { return; }
 
+  if (journal_ != nullptr) { journal_mark_ = journal_->mark(); }
+
   try {
     rng::for_each(commands_, [&](auto& command) {
       try {
@@ -513,6 +1023,9 @@ auto clone_transaction::start() -> void {
         throw;
       }
     });
+
+    if (durability_ != nullptr) { make_durable(); }
+    commit();
   } catch (dc::exception const& err) {
     rollback();
 
@@ -540,6 +1053,11 @@ auto clone_transaction::start() -> void {
     
     reset_command_statuses();
 
+    // everything this transaction did is undone, so are its journal records
+    if (journal_ != nullptr) {
+      try { journal_->truncate(journal_mark_); } catch (fs::filesystem_error const&) {}
+    }
+
     throw_exception<errorcode::transaction>(
       errorcode::transaction::start_failed,
       err.what()
@@ -547,7 +1065,35 @@ auto clone_transaction::start() -> void {
   }
 }
 
+auto clone_transaction::commit() -> void {
+  rng::for_each(commands_, [](auto& command) {
+    std::visit([](auto& cmd) {
+      if constexpr (requires { cmd.commit(); }) {
+        if (cmd.execute_status_ == command_status::success) { cmd.commit(); }
+      }
+    }, command);
+  });
+}
+
+auto clone_transaction::make_durable() -> void {
+  try {
+    // the journal first, so no step reaches the disk without its record
+    if (journal_ != nullptr && durability_->mode() != durability_mode::none) { journal_->sync(); }
+    durability_->flush();
+  } catch (fs::filesystem_error const& err) {
+    throw_exception<errorcode::transaction>(
+      errorcode::transaction::sync_failed,
+      err.what()
+    );
+  }
+}
+
 auto clone_transaction::rollback() -> void {
+  sync_metrics::scoped_timer const timer{metrics_, sync_metrics::histogram::rollback};
+  if (metrics_ != nullptr) { metrics_->add(sync_metrics::counter::rollbacks); }
+  // nothing this transaction wrote is kept, so nothing of it is synced later
+  if (durability_ != nullptr) { durability_->discard(); }
+
   while (!processed_commands_.empty()) {
     auto command = processed_commands_.top();
     try_undo(command, 1);
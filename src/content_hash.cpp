@@ -0,0 +1,219 @@
+#include <dropclone/content_hash.hpp>
+#include <dropclone/logger_manager.hpp>
+#include <dropclone/errorcode.hpp>
+#include <dropclone/utility.hpp>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <system_error>
+#include <new>
+#include <cstring>
+#include <cerrno>
+#include <cstdint>
+
+namespace dropclone {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr std::size_t read_buffer_size{256 * 1024};
+
+constexpr char cache_magic[8]{'D', 'C', 'H', 'A', 'S', 'H', 'E', 'S'};
+
+struct cache_header {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t reserved;
+  std::uint64_t entry_count;
+};
+
+struct cache_record {
+  std::uint64_t device;
+  std::uint64_t inode;
+  std::uint64_t size;
+  std::int64_t modification_time;
+  std::int64_t change_time;
+  std::uint64_t digest;
+};
+
+auto nanoseconds(struct timespec const& time) noexcept -> std::int64_t {
+  return static_cast<std::int64_t>(time.tv_sec) * 1'000'000'000 + time.tv_nsec;
+}
+
+} // namespace
+
+xxh3::xxh3() : state_{XXH3_createState()} {
+  if (!state_) { throw std::bad_alloc{}; }
+  XXH3_64bits_reset(state_.get());
+}
+
+auto xxh3::update(void const* data, std::size_t size) noexcept -> void {
+  XXH3_64bits_update(state_.get(), data, size);
+}
+
+auto xxh3::digest() const noexcept -> std::uint64_t {
+  return XXH3_64bits_digest(state_.get());
+}
+
+auto xxh3::state_deleter::operator()(XXH3_state_t* state) const noexcept -> void {
+  XXH3_freeState(state);
+}
+
+auto file_digest(fs::path const& path) -> std::uint64_t {
+  auto const descriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (descriptor == -1) {
+    throw fs::filesystem_error{"file_digest", path, std::error_code{errno, std::generic_category()}};
+  }
+  ::posix_fadvise(descriptor, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+  alignas(4096) static thread_local char buffer[read_buffer_size];
+  xxh3 hasher{};
+  for (;;) {
+    auto const read = ::read(descriptor, buffer, sizeof(buffer));
+    if (read == -1 && errno == EINTR) { continue; }
+    if (read == -1) {
+      auto const error = errno;
+      ::close(descriptor);
+      throw fs::filesystem_error{"file_digest", path, std::error_code{error, std::generic_category()}};
+    }
+    if (read == 0) { break; }
+    hasher.update(buffer, static_cast<std::size_t>(read));
+  }
+
+  ::close(descriptor);
+  return hasher.digest();
+}
+
+hash_cache::hash_cache(fs::path cache_path) : cache_path_{std::move(cache_path)} {}
+
+auto hash_cache::digest(fs::path const& path) -> std::optional<std::uint64_t> {
+  struct stat status{};
+  if (::stat(path.c_str(), &status) == -1 || !S_ISREG(status.st_mode)) { return std::nullopt; }
+
+  file_key const key{static_cast<std::uint64_t>(status.st_dev), static_cast<std::uint64_t>(status.st_ino)};
+  cached_digest entry{
+    static_cast<std::uint64_t>(status.st_size), nanoseconds(status.st_mtim), nanoseconds(status.st_ctim), 0
+  };
+
+  {
+    std::lock_guard<std::mutex> cache_guard{mutex_};
+    if (auto const found = digests_.find(key); found != std::end(digests_) &&
+        found->second.size == entry.size &&
+        found->second.modification_time == entry.modification_time &&
+        found->second.change_time == entry.change_time) {
+      found->second.looked_up = true;
+      return found->second.digest;
+    }
+  }
+
+  try {
+    entry.digest = file_digest(path);
+  } catch (fs::filesystem_error const&) {
+    return std::nullopt;
+  }
+
+  std::lock_guard<std::mutex> cache_guard{mutex_};
+  digests_.insert_or_assign(key, entry);
+  modified_ = true;
+  return entry.digest;
+}
+
+auto hash_cache::load() -> void {
+  std::error_code error_code{};
+  if (!fs::exists(cache_path_, error_code)) { return; }
+
+  auto const log_invalid = [&](std::string_view reason) {
+    logger.get(logger_id::sync)->warn(
+      utility::formatter<errorcode::index>::format(
+        errorcode::index::invalid_hash_cache,
+        cache_path_.string(), reason
+    ));
+  };
+
+  std::ifstream cache_stream{cache_path_, std::ios::binary};
+  cache_header header{};
+  if (!cache_stream.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+    log_invalid("truncated header");
+    return;
+  }
+
+  if (std::memcmp(header.magic, cache_magic, sizeof(cache_magic)) != 0 || header.version != version) {
+    log_invalid("bad magic or version");
+    return;
+  }
+
+  auto const file_size = fs::file_size(cache_path_, error_code);
+  if (error_code || file_size != sizeof(header) + header.entry_count * sizeof(cache_record)) {
+    log_invalid("size mismatch");
+    return;
+  }
+
+  std::lock_guard<std::mutex> cache_guard{mutex_};
+  digests_.reserve(header.entry_count);
+  for (std::uint64_t index{0}; index != header.entry_count; ++index) {
+    cache_record record{};
+    if (!cache_stream.read(reinterpret_cast<char*>(&record), sizeof(record))) {
+      log_invalid("truncated entry");
+      digests_.clear();
+      return;
+    }
+    digests_.insert_or_assign(file_key{record.device, record.inode},
+      cached_digest{record.size, record.modification_time, record.change_time, record.digest, false});
+  }
+}
+
+auto hash_cache::store() -> bool {
+  std::lock_guard<std::mutex> cache_guard{mutex_};
+  if (std::erase_if(digests_, [](auto const& digest) { return !digest.second.looked_up; }) != 0) {
+    modified_ = true;
+  }
+  for (auto& [key, entry] : digests_) { entry.looked_up = false; }
+  if (!modified_) { return true; }
+
+  auto temporary_path = cache_path_;
+  temporary_path += ".tmp";
+
+  try {
+    std::ofstream cache_stream{temporary_path, std::ios::binary | std::ios::trunc};
+    if (!cache_stream.is_open()) {
+      throw std::system_error{errno, std::generic_category(), temporary_path.string()};
+    }
+    cache_stream.exceptions(std::ios::failbit | std::ios::badbit);
+
+    cache_header header{};
+    std::memcpy(header.magic, cache_magic, sizeof(cache_magic));
+    header.version = version;
+    header.entry_count = digests_.size();
+    cache_stream.write(reinterpret_cast<char const*>(&header), sizeof(header));
+
+    for (auto const& [key, entry] : digests_) {
+      cache_record const record{
+        key.device, key.inode, entry.size, entry.modification_time, entry.change_time, entry.digest
+      };
+      cache_stream.write(reinterpret_cast<char const*>(&record), sizeof(record));
+    }
+    cache_stream.close();
+
+    fs::rename(temporary_path, cache_path_);
+  } catch (std::exception const& e) {
+    logger.get(logger_id::sync)->warn(
+      utility::formatter<errorcode::index>::format(
+        errorcode::index::could_not_write_hash_cache,
+        cache_path_.string(), e.what()
+    ));
+
+    std::error_code error_code{};
+    fs::remove(temporary_path, error_code);
+    return false;
+  }
+
+  modified_ = false;
+  return true;
+}
+
+} // namespace dropclone
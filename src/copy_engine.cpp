@@ -0,0 +1,196 @@
+#include <dropclone/copy_engine.hpp>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <linux/fs.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <filesystem>
+#include <system_error>
+#include <optional>
+#include <algorithm>
+#include <numeric>
+#include <cerrno>
+#include <cstdint>
+
+namespace dropclone {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr std::size_t buffered_chunk_size{128 * 1024};
+constexpr std::size_t kernel_chunk_size{1024 * 1024 * 1024};
+
+class file_descriptor {
+ public:
+  explicit file_descriptor(int descriptor) noexcept : descriptor_{descriptor} {}
+  file_descriptor(file_descriptor const&) = delete;
+  auto operator=(file_descriptor const&) -> file_descriptor& = delete;
+  ~file_descriptor() { if (descriptor_ != -1) { ::close(descriptor_); } }
+
+  auto get() const noexcept -> int { return descriptor_; }
+
+ private:
+  int descriptor_;
+};
+
+// errors that only say 'this kernel path is not available here' – the next 
+// method is tried instead of failing the copy
+auto is_unsupported(int error) noexcept -> bool {
+  return error == EOPNOTSUPP || error == ENOTSUP || error == EXDEV || error == EINVAL ||
+         error == ENOSYS || error == ENOTTY || error == EBADF || error == EPERM;
+}
+
+enum class attempt { done, unsupported };
+
+auto try_reflink(int source, int destination) -> attempt {
+  if (::ioctl(destination, FICLONE, source) == 0) { return attempt::done; }
+  if (is_unsupported(errno)) { return attempt::unsupported; }
+  throw std::system_error{errno, std::generic_category()};
+}
+
+// copy_file_range and sendfile share the loop: both advance the file offsets
+// themselves and return 0 at the end of the source
+template <typename transfer_type>
+auto try_transfer(std::uintmax_t size, transfer_type transfer) -> attempt {
+  std::uintmax_t copied{0};
+  while (copied < size) {
+    auto const chunk = static_cast<std::size_t>(std::min<std::uintmax_t>(size - copied, kernel_chunk_size));
+    auto const result = transfer(chunk);
+    if (result == -1) {
+      if (errno == EINTR) { continue; }
+      if (copied == 0 && is_unsupported(errno)) { return attempt::unsupported; }
+      throw std::system_error{errno, std::generic_category()};
+    }
+    // some pseudo filesystems report 0 for files that do have content
+    if (result == 0) { 
+      if (copied == 0) { return attempt::unsupported; }
+      break; 
+    }
+    copied += static_cast<std::uintmax_t>(result);
+  }
+  return attempt::done;
+}
+
+auto buffered_copy(int source, int destination) -> void {
+  alignas(4096) static thread_local char buffer[buffered_chunk_size];
+  for (;;) {
+    auto const read = ::read(source, buffer, sizeof(buffer));
+    if (read == -1 && errno == EINTR) { continue; }
+    if (read == -1) { throw std::system_error{errno, std::generic_category()}; }
+    if (read == 0) { return; }
+
+    for (ssize_t written{0}; written < read; ) {
+      auto const result = ::write(destination, buffer + written, static_cast<std::size_t>(read - written));
+      if (result == -1 && errno == EINTR) { continue; }
+      if (result == -1) { throw std::system_error{errno, std::generic_category()}; }
+      written += result;
+    }
+  }
+}
+
+} // namespace
+
+auto clone_file(fs::path const& from, fs::path const& to, 
+                fs::copy_options options) -> std::optional<copy_result> {
+  auto const fail = [&](int error) {
+    throw fs::filesystem_error{"clone_file", from, to, std::error_code{error, std::generic_category()}};
+  };
+
+  file_descriptor source{::open(from.c_str(), O_RDONLY | O_CLOEXEC)};
+  if (source.get() == -1) { fail(errno); }
+
+  struct stat source_status{};
+  if (::fstat(source.get(), &source_status) == -1) { fail(errno); }
+
+  if (!S_ISREG(source_status.st_mode)) {
+    fs::copy(from, to, options);
+    return copy_result{copy_method::standard, 0};
+  }
+
+  struct stat destination_status{};
+  bool const exists = ::stat(to.c_str(), &destination_status) == 0;
+  if (exists) {
+    auto const has = [&](fs::copy_options option) { return (options & option) != fs::copy_options::none; };
+
+    if (destination_status.st_dev == source_status.st_dev && 
+        destination_status.st_ino == source_status.st_ino) { fail(EEXIST); }
+    if (has(fs::copy_options::skip_existing)) { return std::nullopt; }
+    if (has(fs::copy_options::update_existing)) {
+      auto const source_time = source_status.st_mtim;
+      auto const destination_time = destination_status.st_mtim;
+      if (source_time.tv_sec < destination_time.tv_sec || 
+          (source_time.tv_sec == destination_time.tv_sec && source_time.tv_nsec <= destination_time.tv_nsec)) {
+        return std::nullopt;
+      }
+    } else if (!has(fs::copy_options::overwrite_existing)) { 
+      fail(EEXIST); 
+    }
+  }
+
+  auto const permissions = source_status.st_mode & 07777;
+  file_descriptor destination{::open(to.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, permissions)};
+  if (destination.get() == -1) { fail(errno); }
+
+  auto const size = static_cast<std::uintmax_t>(source_status.st_size);
+  copy_result result{copy_method::reflink, size};
+
+  try {
+    if (try_reflink(source.get(), destination.get()) == attempt::unsupported) {
+      result.method = copy_method::copy_file_range;
+      if (try_transfer(size, [&](std::size_t chunk) { 
+            return ::copy_file_range(source.get(), nullptr, destination.get(), nullptr, chunk, 0); 
+          }) == attempt::unsupported) {
+        result.method = copy_method::sendfile;
+        if (try_transfer(size, [&](std::size_t chunk) { 
+              return ::sendfile(destination.get(), source.get(), nullptr, chunk); 
+            }) == attempt::unsupported) {
+          result.method = copy_method::buffered;
+          buffered_copy(source.get(), destination.get());
+        }
+      }
+    }
+
+    // an existing destination keeps its mode on open(); match fs::copy_file
+    if (::fchmod(destination.get(), permissions) == -1) {
+      throw std::system_error{errno, std::generic_category()};
+    }
+  } catch (std::system_error const& e) {
+    if (!exists) { ::unlink(to.c_str()); }
+    fail(e.code().value());
+  }
+
+  return result;
+}
+
+auto copy_statistics::record(copy_result const& result) noexcept -> void {
+  auto const method = static_cast<std::size_t>(result.method);
+  files_[method].fetch_add(1, std::memory_order_relaxed);
+  bytes_[method].fetch_add(result.bytes, std::memory_order_relaxed);
+}
+
+auto copy_statistics::reset() noexcept -> void {
+  for (auto& files : files_) { files.store(0, std::memory_order_relaxed); }
+  for (auto& bytes : bytes_) { bytes.store(0, std::memory_order_relaxed); }
+}
+
+auto copy_statistics::files(copy_method method) const noexcept -> std::uint64_t {
+  return files_[static_cast<std::size_t>(method)].load(std::memory_order_relaxed);
+}
+
+auto copy_statistics::bytes(copy_method method) const noexcept -> std::uint64_t {
+  return bytes_[static_cast<std::size_t>(method)].load(std::memory_order_relaxed);
+}
+
+auto copy_statistics::total_files() const noexcept -> std::uint64_t {
+  return std::accumulate(files_.begin(), files_.end(), std::uint64_t{0}, 
+    [](auto sum, auto const& files) { return sum + files.load(std::memory_order_relaxed); });
+}
+
+auto copy_statistics::total_bytes() const noexcept -> std::uint64_t {
+  return std::accumulate(bytes_.begin(), bytes_.end(), std::uint64_t{0}, 
+    [](auto sum, auto const& bytes) { return sum + bytes.load(std::memory_order_relaxed); });
+}
+
+} // namespace dropclone
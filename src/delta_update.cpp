@@ -0,0 +1,296 @@
+#include <dropclone/delta_update.hpp>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <filesystem>
+#include <system_error>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <cstdint>
+
+namespace dropclone {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// blocks are compared in chunks of this size to keep the syscall count low
+constexpr std::size_t read_chunk_size{16 * delta_block_size};
+
+constexpr char journal_magic[8]{'D', 'C', 'D', 'E', 'L', 'T', 'A', '1'};
+constexpr char journal_end_magic[8]{'D', 'C', 'D', 'E', 'L', 'E', 'N', 'D'};
+
+struct journal_header {
+  char magic[8];
+  std::uint64_t original_size;
+  std::uint32_t original_mode;
+  std::uint32_t block_size;
+};
+
+struct journal_record {
+  std::uint64_t offset;
+  std::uint64_t length;
+};
+
+// written and synced only after all records are on disk; a journal without
+// it was interrupted before the destination was touched
+struct journal_trailer {
+  char magic[8];
+  std::uint64_t record_count;
+};
+
+class file_descriptor {
+ public:
+  explicit file_descriptor(int descriptor) noexcept : descriptor_{descriptor} {}
+  file_descriptor(file_descriptor const&) = delete;
+  auto operator=(file_descriptor const&) -> file_descriptor& = delete;
+  ~file_descriptor() { if (descriptor_ != -1) { ::close(descriptor_); } }
+
+  auto get() const noexcept -> int { return descriptor_; }
+
+ private:
+  int descriptor_;
+};
+
+[[noreturn]] auto throw_error(int error, fs::path const& path1, fs::path const& path2 = {}) -> void {
+  throw fs::filesystem_error{"delta_update", path1, path2, std::error_code{error, std::generic_category()}};
+}
+
+auto open_file(fs::path const& path, int flags, mode_t mode = 0) -> int {
+  auto const descriptor = ::open(path.c_str(), flags | O_CLOEXEC, mode);
+  if (descriptor == -1) { throw_error(errno, path); }
+  return descriptor;
+}
+
+auto file_status(int descriptor, fs::path const& path) -> struct stat {
+  struct stat status{};
+  if (::fstat(descriptor, &status) == -1) { throw_error(errno, path); }
+  return status;
+}
+
+// reads up to 'size' bytes; less only at the end of the file
+auto read_at(int descriptor, char* buffer, std::size_t size, std::uint64_t offset, fs::path const& path) -> std::size_t {
+  std::size_t done{0};
+  while (done < size) {
+    auto const result = ::pread(descriptor, buffer + done, size - done, static_cast<off_t>(offset + done));
+    if (result == -1 && errno == EINTR) { continue; }
+    if (result == -1) { throw_error(errno, path); }
+    if (result == 0) { break; }
+    done += static_cast<std::size_t>(result);
+  }
+  return done;
+}
+
+auto write_at(int descriptor, char const* buffer, std::size_t size, std::uint64_t offset, fs::path const& path) -> void {
+  std::size_t done{0};
+  while (done < size) {
+    auto const result = ::pwrite(descriptor, buffer + done, size - done, static_cast<off_t>(offset + done));
+    if (result == -1 && errno == EINTR) { continue; }
+    if (result == -1) { throw_error(errno, path); }
+    done += static_cast<std::size_t>(result);
+  }
+}
+
+auto sync_file(int descriptor, fs::path const& path) -> void {
+  if (::fsync(descriptor) == -1) { throw_error(errno, path); }
+}
+
+// makes a newly created journal survive a crash of the directory entry too
+auto sync_directory(fs::path const& directory) -> void {
+  file_descriptor descriptor{open_file(directory, O_RDONLY | O_DIRECTORY)};
+  sync_file(descriptor.get(), directory);
+}
+
+class journal_writer {
+ public:
+  journal_writer(fs::path path, struct stat const& original)
+    : path_{std::move(path)}, descriptor_{open_file(path_, O_WRONLY | O_CREAT | O_TRUNC, 0600)}
+  {
+    journal_header header{};
+    std::memcpy(header.magic, journal_magic, sizeof(journal_magic));
+    header.original_size = static_cast<std::uint64_t>(original.st_size);
+    header.original_mode = static_cast<std::uint32_t>(original.st_mode & 07777);
+    header.block_size = static_cast<std::uint32_t>(delta_block_size);
+    append(&header, sizeof(header));
+  }
+
+  auto record(std::uint64_t offset, char const* data, std::size_t length) -> void {
+    journal_record const record{offset, length};
+    append(&record, sizeof(record));
+    append(data, length);
+    ++record_count_;
+  }
+
+  auto seal() -> void {
+    sync_file(descriptor_.get(), path_);
+
+    journal_trailer trailer{};
+    std::memcpy(trailer.magic, journal_end_magic, sizeof(journal_end_magic));
+    trailer.record_count = record_count_;
+    append(&trailer, sizeof(trailer));
+    sync_file(descriptor_.get(), path_);
+    sync_directory(path_.parent_path());
+  }
+
+ private:
+  auto append(void const* data, std::size_t size) -> void {
+    write_at(descriptor_.get(), static_cast<char const*>(data), size, size_, path_);
+    size_ += size;
+  }
+
+  fs::path path_;
+  file_descriptor descriptor_;
+  std::uint64_t size_{0};
+  std::uint64_t record_count_{0};
+};
+
+} // namespace
+
+auto delta_update(fs::path const& from, fs::path const& to, fs::path const& journal) -> delta_result {
+  file_descriptor source{open_file(from, O_RDONLY)};
+  file_descriptor destination{open_file(to, O_RDWR)};
+  auto const source_status = file_status(source.get(), from);
+  auto const destination_status = file_status(destination.get(), to);
+  auto const source_size = static_cast<std::uint64_t>(source_status.st_size);
+  auto const destination_size = static_cast<std::uint64_t>(destination_status.st_size);
+
+  delta_result result{};
+  std::vector<std::uint64_t> changed{};
+
+  // 1. compare block by block and journal the original of every block that
+  //    is going to change; the destination is not written yet
+  try {
+    journal_writer journal_file{journal, destination_status};
+    std::vector<char> source_chunk(read_chunk_size);
+    std::vector<char> destination_chunk(read_chunk_size);
+
+    for (std::uint64_t chunk{0}; chunk < std::max(source_size, destination_size); chunk += read_chunk_size) {
+      auto const source_length = read_at(source.get(), source_chunk.data(), read_chunk_size, chunk, from);
+      auto const destination_length = read_at(destination.get(), destination_chunk.data(), read_chunk_size, chunk, to);
+
+      for (std::size_t block{0}; block < std::max(source_length, destination_length); block += delta_block_size) {
+        auto const length_in = [&](std::size_t length) {
+          return block < length ? std::min(delta_block_size, length - block) : std::size_t{0};
+        };
+        auto const source_block = length_in(source_length);
+        auto const destination_block = length_in(destination_length);
+        ++result.blocks;
+
+        if (source_block == destination_block &&
+            std::memcmp(source_chunk.data() + block, destination_chunk.data() + block, source_block) == 0) {
+          continue;
+        }
+
+        if (destination_block != 0) {
+          journal_file.record(chunk + block, destination_chunk.data() + block, destination_block);
+        }
+        changed.push_back(chunk + block);
+      }
+    }
+
+    journal_file.seal();
+  } catch (fs::filesystem_error const&) {
+    std::error_code error_code{};
+    fs::remove(journal, error_code);
+    throw;
+  }
+
+  result.changed_blocks = changed.size();
+
+  // 2. rewrite the changed blocks; blocks past the end of the source are
+  //    cut off by the truncation
+  try {
+    std::vector<char> block_data(delta_block_size);
+    for (auto const offset : changed) {
+      if (offset >= source_size) { continue; }
+      auto const length = read_at(source.get(), block_data.data(), delta_block_size, offset, from);
+      write_at(destination.get(), block_data.data(), length, offset, to);
+      result.bytes_written += length;
+    }
+
+    if (source_size != destination_size && ::ftruncate(destination.get(), static_cast<off_t>(source_size)) == -1) {
+      throw_error(errno, to);
+    }
+    if (::fchmod(destination.get(), source_status.st_mode & 07777) == -1) { throw_error(errno, to); }
+    sync_file(destination.get(), to);
+  } catch (fs::filesystem_error const&) {
+    try {
+      delta_restore(to, journal);
+    } catch (fs::filesystem_error const&) {
+      // the journal stays for recover_delta_journals
+    }
+    throw;
+  }
+
+  return result;
+}
+
+auto delta_restore(fs::path const& to, fs::path const& journal) -> bool {
+  auto const descriptor = ::open(journal.c_str(), O_RDONLY | O_CLOEXEC);
+  if (descriptor == -1) {
+    if (errno == ENOENT) { return false; }
+    throw_error(errno, journal);
+  }
+  file_descriptor journal_file{descriptor};
+  auto const journal_size = static_cast<std::uint64_t>(file_status(journal_file.get(), journal).st_size);
+
+  journal_header header{};
+  journal_trailer trailer{};
+  bool const is_complete =
+    journal_size >= sizeof(header) + sizeof(trailer) &&
+    read_at(journal_file.get(), reinterpret_cast<char*>(&header), sizeof(header), 0, journal) == sizeof(header) &&
+    read_at(journal_file.get(), reinterpret_cast<char*>(&trailer), sizeof(trailer),
+            journal_size - sizeof(trailer), journal) == sizeof(trailer) &&
+    std::memcmp(header.magic, journal_magic, sizeof(journal_magic)) == 0 &&
+    std::memcmp(trailer.magic, journal_end_magic, sizeof(journal_end_magic)) == 0;
+
+  if (is_complete) {
+    file_descriptor destination{open_file(to, O_RDWR)};
+    std::vector<char> block_data(delta_block_size);
+    std::uint64_t position{sizeof(header)};
+
+    for (std::uint64_t record_index{0}; record_index != trailer.record_count; ++record_index) {
+      journal_record record{};
+      if (read_at(journal_file.get(), reinterpret_cast<char*>(&record), sizeof(record), position, journal) != sizeof(record) ||
+          record.length > block_data.size()) {
+        throw_error(EILSEQ, journal, to);
+      }
+      position += sizeof(record);
+
+      if (read_at(journal_file.get(), block_data.data(), record.length, position, journal) != record.length) {
+        throw_error(EILSEQ, journal, to);
+      }
+      position += record.length;
+      write_at(destination.get(), block_data.data(), record.length, record.offset, to);
+    }
+
+    if (::ftruncate(destination.get(), static_cast<off_t>(header.original_size)) == -1) { throw_error(errno, to); }
+    if (::fchmod(destination.get(), static_cast<mode_t>(header.original_mode)) == -1) { throw_error(errno, to); }
+    sync_file(destination.get(), to);
+  }
+
+  fs::remove(journal);
+  return is_complete;
+}
+
+auto recover_delta_journals(fs::path const& journal_root, fs::path const& destination_root) -> std::size_t {
+  std::error_code error_code{};
+  if (!fs::exists(journal_root, error_code)) { return 0; }
+
+  std::vector<fs::path> journals{};
+  for (auto const& entry : fs::recursive_directory_iterator{journal_root}) {
+    if (entry.is_regular_file()) { journals.push_back(entry.path()); }
+  }
+
+  std::size_t restored{0};
+  for (auto const& journal : journals) {
+    if (delta_restore(destination_root / journal.lexically_relative(journal_root), journal)) { ++restored; }
+  }
+
+  fs::remove_all(journal_root);
+  return restored;
+}
+
+} // namespace dropclone
@@ -0,0 +1,187 @@
+#include <dropclone/directory_scanner.hpp>
+#include <dropclone/path_snapshot.hpp>
+#include <dropclone/path_info.hpp>
+#include <filesystem>
+#include <system_error>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <mutex>
+#include <utility>
+#include <algorithm>
+#include <ranges>
+#include <iterator>
+
+namespace dropclone {
+
+namespace fs = std::filesystem;
+namespace rng = std::ranges;
+
+directory_scanner::directory_scanner(fs::path root, path_snapshot::path_filter filter,
+                                     std::size_t thread_count, path_snapshot::path_filter prune)
+  : root_{std::move(root)}, filter_{std::move(filter)}, prune_{std::move(prune)},
+    thread_count_{std::max<std::size_t>(thread_count, 1)}
+{
+  queues_.reserve(thread_count_);
+  for (std::size_t worker{0}; worker != thread_count_; ++worker) {
+    queues_.push_back(std::make_unique<work_queue>());
+  }
+}
+
+auto directory_scanner::push(std::size_t worker, fs::path relative_directory) -> void {
+  pending_.fetch_add(1, std::memory_order_acq_rel);
+  {
+    std::lock_guard<std::mutex> queue_guard{queues_[worker]->mutex};
+    queues_[worker]->directories.push_back(std::move(relative_directory));
+  }
+  generation_.fetch_add(1, std::memory_order_release);
+  generation_.notify_one();
+}
+
+auto directory_scanner::wake_all() -> void {
+  generation_.fetch_add(1, std::memory_order_release);
+  generation_.notify_all();
+}
+
+auto directory_scanner::pop(std::size_t worker) -> std::optional<fs::path> {
+  std::lock_guard<std::mutex> queue_guard{queues_[worker]->mutex};
+  auto& directories = queues_[worker]->directories;
+  if (directories.empty()) { return std::nullopt; }
+  auto directory = std::move(directories.back());
+  directories.pop_back();
+  return directory;
+}
+
+auto directory_scanner::steal(std::size_t worker) -> std::optional<fs::path> {
+  for (std::size_t offset{1}; offset != thread_count_; ++offset) {
+    auto& victim = *queues_[(worker + offset) % thread_count_];
+    std::lock_guard<std::mutex> queue_guard{victim.mutex};
+    if (victim.directories.empty()) { continue; }
+    auto directory = std::move(victim.directories.front());
+    victim.directories.pop_front();
+    return directory;
+  }
+  return std::nullopt;
+}
+
+auto directory_scanner::scan_directory(std::size_t worker, fs::path const& relative_directory,
+                                       scan_result& result) -> void {
+  std::error_code error_code{};
+  fs::directory_iterator directory_iterator{
+    root_ / relative_directory, fs::directory_options::none, error_code
+  };
+
+  if (error_code) {
+    if (error_code == std::errc::permission_denied && !relative_directory.empty()) {
+      path_info info{};
+      info.conflict = path_conflict_t::access_denied;
+      result.conflicts.emplace(relative_directory, info);
+    }
+    return;
+  }
+
+  for (; !error_code && directory_iterator != fs::directory_iterator{}; directory_iterator.increment(error_code)) {
+    auto const& dir_entry = *directory_iterator;
+    // e.g. removed since it was listed
+    auto info = entry_info(dir_entry);
+    if (!info) { continue; }
+
+    auto relative_entry_path = relative_directory / dir_entry.path().filename();
+
+    // same recursion rule as fs::recursive_directory_iterator with
+    // directory_options::none: directory symlinks are listed, never followed
+    std::error_code symlink_error{};
+    if (info->is_directory && !dir_entry.is_symlink(symlink_error) && !symlink_error) {
+      if (prune_ && prune_(dir_entry.path())) {
+        ++result.pruned;
+      } else {
+        push(worker, relative_entry_path);
+      }
+    }
+
+    if (filter_ && !filter_(dir_entry.path())) { continue; }
+
+    result.entries.emplace_back(std::move(relative_entry_path), *info);
+  }
+
+  if (error_code) {
+    throw fs::filesystem_error{"directory_scanner::scan_directory", root_ / relative_directory, error_code};
+  }
+}
+
+auto directory_scanner::entry_info(fs::directory_entry const& dir_entry) -> std::optional<path_info> {
+  std::error_code error_code{};
+  auto const status = dir_entry.status(error_code);
+  if (error_code) { return std::nullopt; }
+
+  path_info info{};
+  info.is_directory = fs::is_directory(status);
+  info.file_perms = status.permissions();
+  info.last_write_time = dir_entry.last_write_time(error_code);
+  if (error_code) { return std::nullopt; }
+
+  if (!info.is_directory) {
+    info.file_size = dir_entry.file_size(error_code);
+    if (error_code) { return std::nullopt; }
+  }
+  return info;
+}
+
+auto directory_scanner::work(std::size_t worker, scan_result& result) -> void {
+  while (!failed_.load(std::memory_order_acquire)) {
+    auto const generation = generation_.load(std::memory_order_acquire);
+    auto directory = pop(worker);
+    if (!directory) { directory = steal(worker); }
+
+    if (!directory) {
+      if (pending_.load(std::memory_order_acquire) == 0) { break; }
+      // a push after 'generation' was read changes it, so this returns
+      generation_.wait(generation, std::memory_order_acquire);
+      continue;
+    }
+
+    try {
+      scan_directory(worker, *directory, result);
+    } catch (...) {
+      std::call_once(failure_flag_, [&] { failure_ = std::current_exception(); });
+      failed_.store(true, std::memory_order_release);
+      wake_all();
+    }
+
+    if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) { wake_all(); }
+  }
+}
+
+auto directory_scanner::scan(fs::path relative_directory) -> scan_result {
+  std::vector<scan_result> results(thread_count_);
+  push(0, std::move(relative_directory));
+
+  {
+    std::vector<std::jthread> workers{};
+    workers.reserve(thread_count_ - 1);
+    for (std::size_t worker{1}; worker != thread_count_; ++worker) {
+      workers.emplace_back([&, worker] { work(worker, results[worker]); });
+    }
+    work(0, results[0]);
+  }
+
+  if (failure_) { std::rethrow_exception(failure_); }
+
+  scan_result merged{std::move(results[0])};
+  rng::for_each(results | std::views::drop(1), [&](auto& result) {
+    merged.entries.insert(std::end(merged.entries), 
+      std::make_move_iterator(std::begin(result.entries)), std::make_move_iterator(std::end(result.entries)));
+    merged.conflicts.merge(result.conflicts);
+    merged.pruned += result.pruned;
+  });
+
+  // an unreadable directory was listed by its parent before it failed to
+  // open; it is a conflict only
+  if (!merged.conflicts.empty()) {
+    std::erase_if(merged.entries, [&](auto const& entry) { return merged.conflicts.contains(entry.first); });
+  }
+
+  return merged;
+}
+
+} // namespace dropclone
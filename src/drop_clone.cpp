@@ -11,43 +11,65 @@
 #include <dropclone/utility.hpp>
 #include <dropclone/exception.hpp>
 #include <dropclone/messagecode.hpp>
+#include <dropclone/operation_log.hpp>
+#include <dropclone/sync_metrics.hpp>
 #include <utility>
 #include <filesystem>
 #include <string>
+#include <string_view>
 #include <ranges>
 #include <vector>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <numeric>
+#include <exception>
+#include <algorithm>
+#include <poll.h>
 
 namespace dropclone {
 
 namespace rng = std::ranges;
 namespace dc = dropclone;
+namespace chr = std::chrono;
+
+// events usually arrive in bursts (an editor saving, an archive being
+// unpacked); waiting a moment lets one sync cycle pick up the whole burst
+constexpr chr::milliseconds watch_debounce{250};
+
+// weight of the usage history in the fair-share order; the sync time of
+// older cycles halves with every new cycle
+constexpr double usage_decay{0.5};
+
+// Prometheus textfile, rewritten after every sync cycle
+constexpr std::string_view metrics_file_name{"dropclone.prom"};
 
 drop_clone::drop_clone(fs::path config_path, config_parser parser) { 
   try {
     init_config_logger();
 
     clone_config_ = parser(config_path);
-    logger.get(logger_id::config)->info(
-      utility::formatter<messagecode::config>::format(
-        messagecode::config::config_file_parsed,
-        config_path.string()
-    ));
+    logger.info<messagecode::config, messagecode::config::config_file_parsed>(logger_id::config, config_path);
 
     clone_config_.sanitize(config_path);
     clone_config_.validate();
-    logger.get(logger_id::config)->info(
-      utility::formatter<messagecode::config>::format(
-        messagecode::config::config_validated,
-        clone_config_.entries.size()
-    ));
-
-    rng::for_each(clone_config_.entries, [&](auto const& entry) {
-      managers_.emplace_back(entry);
-    });
+    logger.info<messagecode::config, messagecode::config::config_validated>(
+      logger_id::config,
+      clone_config_.entries.size()
+    );
 
     spdlog::init_thread_pool(8192, 1);
     init_sync_logger();
 
+    rng::for_each(clone_config_.entries, [&](auto const& entry) {
+      managers_.emplace_back(entry, clone_config_.index_directory);
+    });
+    usage_.resize(managers_.size());
+    sync_pool_ = std::make_unique<worker_pool>(
+      std::min(clone_config_.max_concurrent_syncs, managers_.size())
+    );
+    scheduler_ = std::make_unique<sync_scheduler>(clone_config_.entries, sync_scheduler::clock::now());
+
     logger.get(logger_id::config)->info("ready for use.");
 
   } catch (dropclone::exception const& e) {
@@ -88,7 +110,7 @@ auto drop_clone::init_config_logger() -> void {
     console_sink->set_pattern(logger_manager::default_pattern);
     console_sink->set_level(spdlog::level::info);
     auto logger = std::make_shared<spdlog::logger>(to_string(logger_id::config), console_sink);
-    logger->set_level(spdlog::level::trace);
+    logger->set_level(console_sink->level());
     return logger;
   }());
 }
@@ -114,32 +136,138 @@ auto drop_clone::init_sync_logger() -> void {
     auto logger = std::make_shared<spdlog::async_logger>(
       to_string(logger_id::sync), spdlog::sinks_init_list{rotating_sink, console_sink}, 
       spdlog::thread_pool(), spdlog::async_overflow_policy::block);
-    logger->set_level(spdlog::level::trace);
+    // no sink takes less than this, so nothing below it is even formatted
+    logger->set_level(std::min(rotating_sink->level(), console_sink->level()));
     spdlog::register_logger(logger);
 
     return logger;
   }()); 
 
-  logger.get(logger_id::config)->info(
-    utility::formatter<messagecode::config>::format(
-      messagecode::config::logging_ready,
-      log_file.string()
-  ));
+  logger.info<messagecode::config, messagecode::config::logging_ready>(logger_id::config, log_file);
+
+  if (clone_config_.sync_log_format == log_format::binary) {
+    auto const operation_file = clone_config_.log_directory / "sync_log.bin";
+
+    try {
+      logger.set_operation_log(std::make_unique<operation_log>(operation_file));
+    } catch (fs::filesystem_error const& e) {
+      throw_exception<errorcode::logger>(
+        errorcode::logger::initialization_failed,
+        to_string(logger_id::sync), e.what()
+      );
+    }
+
+    logger.info<messagecode::config, messagecode::config::logging_ready>(logger_id::config, operation_file);
+  }
+}
+
+auto drop_clone::wait_until_due(chr::milliseconds max_wait) -> void {
+  std::vector<pollfd> descriptors{};
+  std::vector<std::size_t> watched{};
+  for (std::size_t index{0}; index != managers_.size(); ++index) {
+    if (auto const descriptor = managers_[index].watch_descriptor(); descriptor != -1) {
+      descriptors.push_back({descriptor, POLLIN, 0});
+      watched.push_back(index);
+    }
+  }
+
+  auto const until_due = chr::ceil<chr::milliseconds>(scheduler_->next_due() - sync_scheduler::clock::now());
+  auto const timeout = std::clamp(until_due, chr::milliseconds{0}, max_wait);
+
+  // returns early on a change and on signals (EINTR), so termination
+  // requests are not delayed by the full timeout
+  if (::poll(descriptors.data(), descriptors.size(), static_cast<int>(timeout.count())) > 0) {
+    std::this_thread::sleep_for(watch_debounce);
+
+    auto const now = sync_scheduler::clock::now();
+    for (std::size_t position{0}; position != descriptors.size(); ++position) {
+      if (descriptors[position].revents & POLLIN) { scheduler_->trigger(watched[position], now); }
+    }
+  }
+}
+
+// a metrics file that cannot be written costs the metrics of this cycle,
+// not the sync
+auto drop_clone::export_sync_metrics() -> void {
+  std::vector<entry_metrics> entries{};
+  entries.reserve(managers_.size());
+  for (std::size_t index{0}; index != managers_.size(); ++index) {
+    entries.push_back({clone_config_.entries[index].source_directory.string(), &managers_[index].metrics()});
+  }
+
+  try {
+    export_metrics(clone_config_.log_directory / metrics_file_name, entries);
+  } catch (fs::filesystem_error const& e) {
+    logger.get(logger_id::sync)->warn(
+      utility::formatter<errorcode::sync>::format(
+        errorcode::sync::metrics_export_failed, 
+        e.path1().string(), e.what()
+    ));
+  }
 }
 
 auto drop_clone::sync() -> void {
+  std::vector<std::size_t> indices(managers_.size());
+  std::iota(rng::begin(indices), rng::end(indices), std::size_t{0});
+  sync_entries(indices);
+}
+
+auto drop_clone::sync_due() -> void {
+  if (auto const indices = scheduler_->due(sync_scheduler::clock::now()); !indices.empty()) {
+    sync_entries(indices);
+  }
+}
+
+auto drop_clone::sync_entries(std::vector<std::size_t> const& indices) -> void {
   try {
-    rng::for_each(managers_, [&](auto& clone_manager) { 
-      try {
-        clone_manager.sync(); 
-      } catch (dc::exception const& err) {
-        logger.get(logger_id::sync)->error(
-          utility::formatter<errorcode::sync>::format(
-            errorcode::sync::sync_failed, 
-            err.what()
-        ));
-      }
+    // fair share: managers that used the least sync time recently are 
+    // queued first, so a huge entry cannot keep small ones waiting
+    auto order = indices;
+    rng::stable_sort(order, [&](auto lhs, auto rhs) { return usage_[lhs] < usage_[rhs]; });
+
+    std::mutex failure_mutex{};
+    std::exception_ptr failure{};
+    // a failed cycle counts as a change, so it is retried soon
+    std::vector<char> changed(managers_.size(), false);
+
+    rng::for_each(order, [&](auto index) {
+      sync_pool_->submit([&, index] {
+        auto const started = chr::steady_clock::now();
+        auto& metrics = managers_[index].metrics();
+        try {
+          changed[index] = managers_[index].sync(); 
+        } catch (dc::exception const& err) {
+          changed[index] = true;
+          metrics.add(sync_metrics::counter::sync_failures);
+          logger.get(logger_id::sync)->error(
+            utility::formatter<errorcode::sync>::format(
+              errorcode::sync::sync_failed, 
+              err.what()
+          ));
+        } catch (...) {
+          std::lock_guard<std::mutex> failure_guard{failure_mutex};
+          if (!failure) { failure = std::current_exception(); }
+        }
+        auto const elapsed = chr::steady_clock::now() - started;
+        metrics.observe(sync_metrics::histogram::sync, elapsed);
+        usage_[index] = usage_[index] * usage_decay + elapsed;
+      });
     });
+
+    sync_pool_->wait();
+    if (failure) { std::rethrow_exception(failure); }
+
+    auto const now = sync_scheduler::clock::now();
+    rng::for_each(order, [&](auto index) {
+      scheduler_->completed(index, changed[index], now);
+      logger.debug<messagecode::sync, messagecode::sync::next_sync>(
+        logger_id::sync,
+        clone_config_.entries[index].source_directory,
+        scheduler_->interval(index).count()
+      );
+    });
+
+    export_sync_metrics();
   } catch (std::exception const& e) {
       logger.get(logger_id::config)->error(
         utility::formatter<errorcode::system>::format(
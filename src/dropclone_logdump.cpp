@@ -0,0 +1,114 @@
+#include <dropclone/operation_log.hpp>
+#include <dropclone/logger_manager.hpp>
+#include <dropclone/messagecode.hpp>
+#include <dropclone/utility.hpp>
+#include <filesystem>
+#include <iostream>
+#include <format>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <ctime>
+#include <cstdint>
+#include <cstdlib>
+
+// Prints a binary sync log ('sync_log_format': "binary") in the format of
+// the text sync log:
+//
+//   dropclone-logdump <log_directory>/sync_log.bin
+
+namespace fs = std::filesystem;
+namespace dc = dropclone;
+
+namespace {
+
+using message_table = dc::messagecode::command;
+
+auto message_text(std::uint16_t number) -> std::string_view {
+  for (auto const& message : message_table::messages.entries) {
+    if (dc::utility::message_number(message.code) == number) { return message.text; }
+  }
+  return {};
+}
+
+auto argument(dc::operation_record const& record, std::size_t index,
+              std::vector<std::string> const& strings) -> std::string {
+  using kind = dc::operation_record::kind;
+
+  switch (record.kinds[index]) {
+    case kind::string:
+      return record.arguments[index] < strings.size()
+        ? strings[record.arguments[index]]
+        : std::string{"<missing string>"};
+    case kind::unsigned_number: return std::to_string(record.arguments[index]);
+    case kind::signed_number: return std::to_string(static_cast<std::int64_t>(record.arguments[index]));
+    case kind::none: break;
+  }
+  return {};
+}
+
+auto format_message(dc::operation_record const& record, std::vector<std::string> const& strings) -> std::string {
+  auto const text = message_text(record.message);
+  if (text.empty()) { return std::format("[missing_message_code: {}]", record.message); }
+
+  std::vector<std::string> arguments{};
+  for (std::size_t index{0}; index != dc::operation_record::max_arguments; ++index) {
+    if (record.kinds[index] == dc::operation_record::kind::none) { break; }
+    arguments.push_back(argument(record, index, strings));
+  }
+
+  // the arguments are strings by now; every placeholder of the messages is a plain '{}'
+  try {
+    switch (arguments.size()) {
+      case 0: return std::string{text};
+      case 1: return std::vformat(text, std::make_format_args(arguments[0]));
+      case 2: return std::vformat(text, std::make_format_args(arguments[0], arguments[1]));
+      case 3: return std::vformat(text, std::make_format_args(arguments[0], arguments[1], arguments[2]));
+      default:
+        return std::vformat(text, std::make_format_args(arguments[0], arguments[1], arguments[2], arguments[3]));
+    }
+  } catch (std::format_error const& e) {
+    return std::format("[format_error: {} ] for code {}", e.what(), record.message);
+  }
+}
+
+// "[%Y-%m-%d %H:%M:%S.%e]" of logger_manager::default_pattern, in local time
+auto format_time(std::int64_t nanoseconds) -> std::string {
+  auto const seconds = static_cast<std::time_t>(nanoseconds / 1'000'000'000);
+  auto const milliseconds = (nanoseconds / 1'000'000) % 1000;
+
+  std::tm local{};
+  ::localtime_r(&seconds, &local);
+
+  char buffer[32]{};
+  std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &local);
+  return std::format("{}.{:03}", buffer, milliseconds);
+}
+
+} // namespace
+
+auto main(int argc, char const* argv[]) -> int {
+  if (argc != 2) {
+    std::cerr << "usage: dropclone-logdump <sync_log.bin>\n";
+    return EXIT_FAILURE;
+  }
+
+  try {
+    auto const log = dc::operation_log::read(fs::path{argv[1]});
+
+    for (auto const& record : log.records) {
+      auto const level = spdlog::level::to_string_view(static_cast<spdlog::level::level_enum>(record.level));
+      std::cout << std::format("[{}] [{}] [{}] {}\n",
+        format_time(record.time),
+        dc::to_string(static_cast<dc::logger_id>(record.logger)),
+        std::string_view{level.data(), level.size()},
+        format_message(record, log.strings)
+      );
+    }
+  } catch (fs::filesystem_error const& e) {
+    std::cerr << e.what() << '\n';
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,48 @@
+#include <dropclone/duplicate_name_index.hpp>
+#include <filesystem>
+#include <system_error>
+#include <string>
+
+namespace dropclone {
+
+namespace fs = std::filesystem;
+
+duplicate_name_index::duplicate_name_index(fs::path root) : root_{std::move(root)} {}
+
+auto duplicate_name_index::names_in(fs::path const& relative_directory) -> directory_names& {
+  auto [directory, inserted] = directories_.try_emplace(relative_directory.string());
+  if (!inserted) { return directory->second; }
+
+  // a directory that does not exist yet has no names taken
+  std::error_code error_code{};
+  for (fs::directory_iterator iterator{root_ / relative_directory, error_code}, end{};
+       !error_code && iterator != end; iterator.increment(error_code)) {
+    directory->second.taken.insert(iterator->path().filename().string());
+  }
+
+  return directory->second;
+}
+
+auto duplicate_name_index::allocate(fs::path const& relative_path) -> fs::path {
+  auto const parent_path = relative_path.parent_path();
+  auto file_name = relative_path.filename().string();
+
+  std::lock_guard<std::mutex> index_guard{mutex_};
+  auto& names = names_in(parent_path);
+
+  if (names.taken.insert(file_name).second) { return relative_path; }
+
+  auto const stem = relative_path.stem().string();
+  auto const extension = relative_path.extension().string();
+  auto& suffix = names.next_suffix.try_emplace(file_name, 1).first->second;
+
+  for (;; ++suffix) {
+    auto candidate = stem + "_" + std::to_string(suffix) + extension;
+    if (names.taken.insert(candidate).second) {
+      ++suffix;
+      return parent_path / fs::path{std::move(candidate)};
+    }
+  }
+}
+
+} // namespace dropclone
@@ -0,0 +1,169 @@
+#include <dropclone/durability.hpp>
+#include <dropclone/worker_pool.hpp>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <filesystem>
+#include <string_view>
+#include <system_error>
+#include <algorithm>
+#include <exception>
+#include <map>
+#include <set>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include <cerrno>
+
+namespace dropclone {
+
+namespace fs = std::filesystem;
+namespace chr = std::chrono;
+
+namespace {
+
+class descriptor {
+ public:
+  explicit descriptor(int value) noexcept : value_{value} {}
+  descriptor(descriptor const&) = delete;
+  auto operator=(descriptor const&) -> descriptor& = delete;
+  ~descriptor() { if (value_ != -1) { ::close(value_); } }
+
+  auto get() const noexcept -> int { return value_; }
+
+ private:
+  int value_;
+};
+
+[[noreturn]] auto fail(fs::path const& path, int error) -> void {
+  throw fs::filesystem_error{"durability", path, std::error_code{error, std::generic_category()}};
+}
+
+// a file that is gone or a symlink copied as such has nothing to sync
+auto open_written(fs::path const& path, int flags = 0) -> int {
+  auto const file = ::open(path.c_str(), O_RDONLY | O_NOFOLLOW | O_CLOEXEC | flags);
+  if (file == -1 && errno != ENOENT && errno != ELOOP) { fail(path, errno); }
+  return file;
+}
+
+auto sync_file(fs::path const& path) -> void {
+  descriptor const file{open_written(path)};
+  if (file.get() != -1 && ::fdatasync(file.get()) == -1) { fail(path, errno); }
+}
+
+auto sync_directory(fs::path const& directory, std::vector<fs::path> const& files) -> void {
+  // start writeback for the whole directory before waiting for any file
+  for (auto const& path : files) {
+    descriptor const file{open_written(path)};
+    if (file.get() != -1) { ::sync_file_range(file.get(), 0, 0, SYNC_FILE_RANGE_WRITE); }
+  }
+  for (auto const& path : files) { sync_file(path); }
+
+  descriptor const entries{open_written(directory, O_DIRECTORY)};
+  if (entries.get() != -1 && ::fsync(entries.get()) == -1) { fail(directory, errno); }
+}
+
+} // namespace
+
+auto to_string(durability_mode mode) noexcept -> std::string_view {
+  switch (mode) {
+    case durability_mode::none: return "none";
+    case durability_mode::per_file: return "per_file";
+    case durability_mode::per_directory: return "per_directory";
+    case durability_mode::per_transaction: return "per_transaction";
+    case durability_mode::undefined: break;
+  }
+  return "undefined";
+}
+
+durability_tracker::durability_tracker(durability_mode mode, std::size_t workers)
+  : mode_{mode}, workers_{std::max<std::size_t>(workers, 1)}
+{}
+
+auto durability_tracker::record_time(chr::steady_clock::time_point started, std::uint64_t files) noexcept -> void {
+  auto const elapsed = chr::duration_cast<chr::nanoseconds>(chr::steady_clock::now() - started);
+  sync_nanoseconds_.fetch_add(elapsed.count(), std::memory_order_relaxed);
+  synced_files_.fetch_add(files, std::memory_order_relaxed);
+}
+
+auto durability_tracker::written(fs::path const& path) -> void {
+  if (mode_ == durability_mode::none) { return; }
+
+  if (mode_ == durability_mode::per_file) {
+    auto const started = chr::steady_clock::now();
+    sync_file(path);
+    record_time(started, 1);
+    return;
+  }
+
+  std::lock_guard<std::mutex> durability_guard{mutex_};
+  pending_.push_back(path);
+}
+
+auto durability_tracker::flush() -> void {
+  std::vector<fs::path> pending{};
+  {
+    std::lock_guard<std::mutex> durability_guard{mutex_};
+    pending.swap(pending_);
+  }
+  if (pending.empty()) { return; }
+
+  auto const started = chr::steady_clock::now();
+
+  if (mode_ == durability_mode::per_directory) {
+    std::map<fs::path, std::vector<fs::path>> directories{};
+    for (auto& path : pending) { directories[path.parent_path()].push_back(std::move(path)); }
+
+    if (workers_ <= 1 || directories.size() < 2) {
+      for (auto const& [directory, files] : directories) { sync_directory(directory, files); }
+    } else {
+      std::mutex failure_mutex{};
+      std::exception_ptr failure{};
+      worker_pool pool{std::min(workers_, directories.size())};
+
+      for (auto const& [directory, files] : directories) {
+        pool.submit([&] {
+          try {
+            sync_directory(directory, files);
+          } catch (...) {
+            std::lock_guard<std::mutex> failure_guard{failure_mutex};
+            if (!failure) { failure = std::current_exception(); }
+          }
+        });
+      }
+      pool.wait();
+
+      if (failure) { std::rethrow_exception(failure); }
+    }
+  } else if (mode_ == durability_mode::per_transaction) {
+    std::set<fs::path> parents{};
+    for (auto const& path : pending) { parents.insert(path.parent_path()); }
+
+    std::set<dev_t> synced_devices{};
+    for (auto const& parent : parents) {
+      descriptor const directory{open_written(parent, O_DIRECTORY)};
+      if (directory.get() == -1) { continue; }
+
+      struct stat directory_status{};
+      if (::fstat(directory.get(), &directory_status) == -1) { fail(parent, errno); }
+      if (!synced_devices.insert(directory_status.st_dev).second) { continue; }
+
+      if (::syncfs(directory.get()) == -1) { fail(parent, errno); }
+    }
+  }
+
+  record_time(started, pending.size());
+}
+
+auto durability_tracker::discard() -> void {
+  std::lock_guard<std::mutex> durability_guard{mutex_};
+  pending_.clear();
+}
+
+auto durability_tracker::reset() -> void {
+  discard();
+  synced_files_.store(0, std::memory_order_relaxed);
+  sync_nanoseconds_.store(0, std::memory_order_relaxed);
+}
+
+} // namespace dropclone
@@ -0,0 +1,554 @@
+#include <dropclone/io_uring_backend.hpp>
+#include <dropclone/copy_engine.hpp>
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <filesystem>
+#include <system_error>
+#include <functional>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <map>
+#include <atomic>
+#include <algorithm>
+#include <iterator>
+#include <cerrno>
+#include <cstring>
+#include <cstdint>
+
+namespace dropclone {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr unsigned ring_entries{128};
+constexpr std::size_t buffer_count{32};
+constexpr std::size_t buffer_size{256 * 1024};
+
+constexpr std::uint8_t required_operations[]{
+  IORING_OP_OPENAT, IORING_OP_STATX, IORING_OP_READ, IORING_OP_WRITE,
+  IORING_OP_READ_FIXED, IORING_OP_WRITE_FIXED, IORING_OP_CLOSE,
+  IORING_OP_RENAMEAT, IORING_OP_UNLINKAT, IORING_OP_MKDIRAT
+};
+
+auto io_uring_setup(unsigned entries, io_uring_params* params) -> int {
+  return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+auto io_uring_enter(int descriptor, unsigned to_submit, unsigned min_complete, unsigned flags) -> int {
+  return static_cast<int>(::syscall(__NR_io_uring_enter, descriptor, to_submit, min_complete, flags, nullptr, 0));
+}
+
+auto io_uring_register(int descriptor, unsigned opcode, void const* argument, unsigned count) -> int {
+  return static_cast<int>(::syscall(__NR_io_uring_register, descriptor, opcode, argument, count));
+}
+
+auto load_acquire(unsigned const* value) -> unsigned {
+  return std::atomic_ref<unsigned const>{*value}.load(std::memory_order_acquire);
+}
+
+auto store_release(unsigned* value, unsigned new_value) -> void {
+  std::atomic_ref<unsigned>{*value}.store(new_value, std::memory_order_release);
+}
+
+auto depth_batches(std::span<fs::path const> paths) -> std::map<std::size_t, std::vector<std::size_t>> {
+  std::map<std::size_t, std::vector<std::size_t>> batches{};
+  for (std::size_t index{0}; index != paths.size(); ++index) {
+    auto const depth = static_cast<std::size_t>(std::distance(paths[index].begin(), paths[index].end()));
+    batches[depth].push_back(index);
+  }
+  return batches;
+}
+
+} // namespace
+
+struct io_uring_backend::ring_state {
+  using cqe_handler = std::function<void(std::uint64_t user_data, int result)>;
+  using failure = std::optional<std::pair<std::size_t, int>>;
+
+  int descriptor{-1};
+  void* sq_ring{MAP_FAILED};
+  std::size_t sq_ring_size{0};
+  void* cq_ring{MAP_FAILED};
+  std::size_t cq_ring_size{0};
+  void* sqe_memory{MAP_FAILED};
+  std::size_t sqe_memory_size{0};
+  void* buffer_memory{MAP_FAILED};
+
+  io_uring_sqe* sqes{nullptr};
+  unsigned* sq_head{nullptr};
+  unsigned* sq_tail{nullptr};
+  unsigned* sq_array{nullptr};
+  unsigned sq_mask{0};
+  unsigned sq_entries{0};
+  unsigned* cq_head{nullptr};
+  unsigned* cq_tail{nullptr};
+  io_uring_cqe* cqes{nullptr};
+  unsigned cq_mask{0};
+
+  unsigned to_submit{0};
+  unsigned in_flight{0};
+  bool fixed_buffers{false};
+
+  ~ring_state() {
+    if (buffer_memory != MAP_FAILED) { ::munmap(buffer_memory, buffer_count * buffer_size); }
+    if (sqe_memory != MAP_FAILED) { ::munmap(sqe_memory, sqe_memory_size); }
+    if (cq_ring != MAP_FAILED && cq_ring != sq_ring) { ::munmap(cq_ring, cq_ring_size); }
+    if (sq_ring != MAP_FAILED) { ::munmap(sq_ring, sq_ring_size); }
+    if (descriptor != -1) { ::close(descriptor); }
+  }
+
+  auto setup() -> bool {
+    io_uring_params params{};
+    descriptor = io_uring_setup(ring_entries, &params);
+    if (descriptor == -1) { return false; }
+
+    sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+      sq_ring_size = cq_ring_size = std::max(sq_ring_size, cq_ring_size);
+    }
+
+    sq_ring = ::mmap(nullptr, sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                     descriptor, IORING_OFF_SQ_RING);
+    if (sq_ring == MAP_FAILED) { return false; }
+
+    cq_ring = (params.features & IORING_FEAT_SINGLE_MMAP) ? sq_ring
+            : ::mmap(nullptr, cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                     descriptor, IORING_OFF_CQ_RING);
+    if (cq_ring == MAP_FAILED) { return false; }
+
+    sqe_memory_size = params.sq_entries * sizeof(io_uring_sqe);
+    sqe_memory = ::mmap(nullptr, sqe_memory_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        descriptor, IORING_OFF_SQES);
+    if (sqe_memory == MAP_FAILED) { return false; }
+
+    auto* const sq_base = static_cast<char*>(sq_ring);
+    auto* const cq_base = static_cast<char*>(cq_ring);
+    sq_head = reinterpret_cast<unsigned*>(sq_base + params.sq_off.head);
+    sq_tail = reinterpret_cast<unsigned*>(sq_base + params.sq_off.tail);
+    sq_array = reinterpret_cast<unsigned*>(sq_base + params.sq_off.array);
+    sq_mask = *reinterpret_cast<unsigned*>(sq_base + params.sq_off.ring_mask);
+    sq_entries = params.sq_entries;
+    cq_head = reinterpret_cast<unsigned*>(cq_base + params.cq_off.head);
+    cq_tail = reinterpret_cast<unsigned*>(cq_base + params.cq_off.tail);
+    cqes = reinterpret_cast<io_uring_cqe*>(cq_base + params.cq_off.cqes);
+    cq_mask = *reinterpret_cast<unsigned*>(cq_base + params.cq_off.ring_mask);
+    sqes = static_cast<io_uring_sqe*>(sqe_memory);
+
+    return supports_required_operations() && setup_buffers();
+  }
+
+  auto supports_required_operations() const -> bool {
+    constexpr unsigned probe_operations{256};
+    std::vector<std::byte> storage(sizeof(io_uring_probe) + probe_operations * sizeof(io_uring_probe_op));
+    auto* const probe = reinterpret_cast<io_uring_probe*>(storage.data());
+    if (io_uring_register(descriptor, IORING_REGISTER_PROBE, probe, probe_operations) == -1) { return false; }
+
+    return std::ranges::all_of(required_operations, [&](auto operation) {
+      return operation <= probe->last_op && (probe->ops[operation].flags & IO_URING_OP_SUPPORTED);
+    });
+  }
+
+  auto setup_buffers() -> bool {
+    buffer_memory = ::mmap(nullptr, buffer_count * buffer_size, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buffer_memory == MAP_FAILED) { return false; }
+
+    std::vector<iovec> buffers(buffer_count);
+    for (std::size_t index{0}; index != buffer_count; ++index) {
+      buffers[index] = iovec{buffer(index), buffer_size};
+    }
+
+    // registration pins the pages; if the memlock limit forbids it, the same
+    // buffers are used with plain READ / WRITE
+    fixed_buffers = io_uring_register(descriptor, IORING_REGISTER_BUFFERS,
+                                      buffers.data(), buffer_count) == 0;
+    return true;
+  }
+
+  auto buffer(std::size_t index) const -> char* {
+    return static_cast<char*>(buffer_memory) + index * buffer_size;
+  }
+
+  // callers keep in_flight below sq_entries, so the queue never runs full
+  auto get_sqe(std::uint8_t opcode, int descriptor_argument, void const* address,
+               std::uint32_t length, std::uint64_t offset, std::uint64_t user_data) -> io_uring_sqe* {
+    auto const tail = *sq_tail;
+    auto const index = tail & sq_mask;
+    auto* const sqe = &sqes[index];
+    std::memset(sqe, 0, sizeof(io_uring_sqe));
+    sqe->opcode = opcode;
+    sqe->fd = descriptor_argument;
+    sqe->addr = reinterpret_cast<std::uint64_t>(address);
+    sqe->len = length;
+    sqe->off = offset;
+    sqe->user_data = user_data;
+    sq_array[index] = index;
+    store_release(sq_tail, tail + 1);
+    ++to_submit;
+    ++in_flight;
+    return sqe;
+  }
+
+  auto submit_and_wait(unsigned min_complete) -> void {
+    for (;;) {
+      auto const result = io_uring_enter(descriptor, to_submit, min_complete,
+                                         min_complete != 0 ? IORING_ENTER_GETEVENTS : 0);
+      if (result >= 0) {
+        to_submit -= static_cast<unsigned>(result);
+        return;
+      }
+      if (errno == EINTR || errno == EAGAIN || errno == EBUSY) { continue; }
+      throw std::system_error{errno, std::generic_category(), "io_uring_enter"};
+    }
+  }
+
+  auto wait(cqe_handler const& handle) -> void {
+    submit_and_wait(1);
+
+    auto head = *cq_head;
+    auto const tail = load_acquire(cq_tail);
+    for (; head != tail; ++head) {
+      auto const& cqe = cqes[head & cq_mask];
+      --in_flight;
+      handle(cqe.user_data, cqe.res);
+    }
+    store_release(cq_head, head);
+  }
+
+  // One operation per item with at most sq_entries in flight. 'complete'
+  // returns the errno that fails the batch, or 0; no item is started after
+  // the first failure.
+  auto run_batch(std::size_t count,
+                 std::function<void(std::size_t index)> const& prepare,
+                 std::function<int(std::size_t index, int result)> const& complete) -> failure {
+    failure first_failure{};
+    std::size_t next{0};
+
+    auto const fill = [&] {
+      for (; !first_failure && next != count && in_flight < sq_entries; ++next) { prepare(next); }
+    };
+
+    fill();
+    while (in_flight > 0) {
+      wait([&](std::uint64_t user_data, int result) {
+        auto const index = static_cast<std::size_t>(user_data);
+        if (auto const error = complete(index, result); error != 0 && !first_failure) {
+          first_failure.emplace(index, error);
+        }
+      });
+      fill();
+    }
+
+    return first_failure;
+  }
+};
+
+io_uring_backend::io_uring_backend() : ring_{std::make_unique<ring_state>()} {}
+
+io_uring_backend::~io_uring_backend() = default;
+
+auto io_uring_backend::local() -> io_uring_backend* {
+  thread_local std::unique_ptr<io_uring_backend> const backend = [] {
+    std::unique_ptr<io_uring_backend> created{new io_uring_backend{}};
+    if (!created->ring_->setup()) { created.reset(); }
+    return created;
+  }();
+  return backend.get();
+}
+
+auto io_uring_backend::copy_files(std::span<path_pair const> copies, bool overwrite,
+                                  copy_completion const& on_done) -> void {
+  enum class stage : std::uint8_t { open_source, status, open_destination, read, write, close };
+
+  struct copy_slot {
+    std::size_t item{0};
+    int source{-1};
+    int destination{-1};
+    struct statx status{};
+    std::uint64_t size{0};
+    std::uint64_t offset{0};
+    std::uint32_t length{0};
+    std::uint32_t written{0};
+    unsigned pending{0};
+    int error{0};
+    bool created{false};
+    bool skipped{false};
+    bool not_regular{false};
+  };
+
+  auto& ring = *ring_;
+  std::vector<copy_slot> slots(std::min(buffer_count, copies.size()));
+  std::vector<std::size_t> not_regular_items{};
+  ring_state::failure first_failure{};
+  std::size_t next_item{0};
+
+  auto const user_data = [](std::size_t slot, stage step) -> std::uint64_t {
+    return (static_cast<std::uint64_t>(slot) << 8) | static_cast<std::uint8_t>(step);
+  };
+
+  auto const submit_read = [&](std::size_t index) {
+    auto& slot = slots[index];
+    slot.length = static_cast<std::uint32_t>(std::min<std::uint64_t>(buffer_size, slot.size - slot.offset));
+    slot.written = 0;
+    auto* sqe = ring.get_sqe(ring.fixed_buffers ? IORING_OP_READ_FIXED : IORING_OP_READ, slot.source,
+                             ring.buffer(index), slot.length, slot.offset, user_data(index, stage::read));
+    if (ring.fixed_buffers) { sqe->buf_index = static_cast<std::uint16_t>(index); }
+  };
+
+  auto const submit_write = [&](std::size_t index) {
+    auto& slot = slots[index];
+    auto* sqe = ring.get_sqe(ring.fixed_buffers ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE, slot.destination,
+                             ring.buffer(index) + slot.written, slot.length - slot.written,
+                             slot.offset + slot.written, user_data(index, stage::write));
+    if (ring.fixed_buffers) { sqe->buf_index = static_cast<std::uint16_t>(index); }
+  };
+
+  std::function<void(std::size_t)> start_next{};
+
+  auto const complete = [&](std::size_t index) {
+    auto& slot = slots[index];
+    auto const& copy = copies[slot.item];
+
+    if (slot.error != 0) {
+      if (slot.created) { ::unlink(copy.to.c_str()); }
+      if (!first_failure) { first_failure.emplace(slot.item, slot.error); }
+    } else if (slot.not_regular) {
+      not_regular_items.push_back(slot.item);
+    } else if (!slot.skipped) {
+      on_done(slot.item, copy_result{copy_method::io_uring, slot.size});
+    }
+
+    start_next(index);
+  };
+
+  auto const finish = [&](std::size_t index) {
+    auto& slot = slots[index];
+    // io_uring has no fchmod; the umask must not narrow the copied mode
+    if (slot.error == 0 && slot.destination != -1 &&
+        ::fchmod(slot.destination, slot.status.stx_mode & 07777) == -1) {
+      slot.error = errno;
+    }
+
+    slot.pending = 0;
+    for (auto descriptor : {slot.source, slot.destination}) {
+      if (descriptor == -1) { continue; }
+      ring.get_sqe(IORING_OP_CLOSE, descriptor, nullptr, 0, 0, user_data(index, stage::close));
+      ++slot.pending;
+    }
+    slot.source = slot.destination = -1;
+    if (slot.pending == 0) { complete(index); }
+  };
+
+  auto const next_chunk = [&](std::size_t index) {
+    auto& slot = slots[index];
+    if (slot.offset >= slot.size) { finish(index); } else { submit_read(index); }
+  };
+
+  auto const opened_source = [&](std::size_t index) {
+    auto& slot = slots[index];
+    if (slot.error != 0) { finish(index); return; }
+    if (!S_ISREG(slot.status.stx_mode)) {
+      slot.not_regular = true;
+      finish(index);
+      return;
+    }
+
+    slot.size = slot.status.stx_size;
+    auto const flags = O_WRONLY | O_CREAT | O_CLOEXEC | (overwrite ? O_TRUNC : O_EXCL);
+    auto* sqe = ring.get_sqe(IORING_OP_OPENAT, AT_FDCWD, copies[slot.item].to.c_str(),
+                             slot.status.stx_mode & 07777, 0, user_data(index, stage::open_destination));
+    sqe->open_flags = static_cast<std::uint32_t>(flags);
+  };
+
+  start_next = [&](std::size_t index) {
+    if (first_failure || next_item == copies.size()) { return; }
+
+    auto& slot = slots[index];
+    slot = copy_slot{};
+    slot.item = next_item++;
+    slot.pending = 2;
+
+    auto const& from = copies[slot.item].from;
+    auto* open_sqe = ring.get_sqe(IORING_OP_OPENAT, AT_FDCWD, from.c_str(), 0, 0,
+                                  user_data(index, stage::open_source));
+    open_sqe->open_flags = O_RDONLY | O_CLOEXEC;
+    auto* status_sqe = ring.get_sqe(IORING_OP_STATX, AT_FDCWD, from.c_str(), STATX_TYPE | STATX_MODE | STATX_SIZE,
+                                    reinterpret_cast<std::uint64_t>(&slot.status), user_data(index, stage::status));
+    status_sqe->statx_flags = 0;
+  };
+
+  auto const handle = [&](std::uint64_t data, int result) {
+    auto const index = static_cast<std::size_t>(data >> 8);
+    auto& slot = slots[index];
+
+    switch (static_cast<stage>(data & 0xff)) {
+      case stage::open_source:
+      case stage::status:
+        if (result < 0) {
+          if (slot.error == 0) { slot.error = -result; }
+        } else if (static_cast<stage>(data & 0xff) == stage::open_source) {
+          slot.source = result;
+        }
+        if (--slot.pending == 0) { opened_source(index); }
+        break;
+
+      case stage::open_destination:
+        if (result == -EEXIST && !overwrite) {
+          slot.skipped = true;
+          finish(index);
+        } else if (result < 0) {
+          slot.error = -result;
+          finish(index);
+        } else {
+          slot.destination = result;
+          slot.created = !overwrite;
+          next_chunk(index);
+        }
+        break;
+
+      case stage::read:
+        if (result < 0) { slot.error = -result; finish(index); break; }
+        // the source shrank since statx – copy what is there
+        if (result == 0) { slot.size = slot.offset; finish(index); break; }
+        slot.length = static_cast<std::uint32_t>(result);
+        submit_write(index);
+        break;
+
+      case stage::write:
+        if (result <= 0) { slot.error = result < 0 ? -result : EIO; finish(index); break; }
+        slot.written += static_cast<std::uint32_t>(result);
+        if (slot.written < slot.length) { submit_write(index); break; }
+        slot.offset += slot.length;
+        next_chunk(index);
+        break;
+
+      case stage::close:
+        if (result < 0 && slot.error == 0) { slot.error = -result; }
+        if (--slot.pending == 0) { complete(index); }
+        break;
+    }
+  };
+
+  for (std::size_t index{0}; index != slots.size(); ++index) { start_next(index); }
+  while (ring.in_flight > 0) { ring.wait(handle); }
+
+  if (first_failure) {
+    auto const& copy = copies[first_failure->first];
+    throw fs::filesystem_error{"io_uring_backend::copy_files", copy.from, copy.to,
+                               std::error_code{first_failure->second, std::generic_category()}};
+  }
+
+  for (auto item : not_regular_items) {
+    auto const& copy = copies[item];
+    if (auto const result = clone_file(copy.from, copy.to,
+          overwrite ? fs::copy_options::overwrite_existing : fs::copy_options::skip_existing)) {
+      on_done(item, *result);
+    }
+  }
+}
+
+auto io_uring_backend::rename_files(std::span<path_pair const> renames, completion const& on_done) -> void {
+  auto& ring = *ring_;
+  auto const failure = ring.run_batch(renames.size(),
+    [&](std::size_t index) {
+      auto* sqe = ring.get_sqe(IORING_OP_RENAMEAT, AT_FDCWD, renames[index].from.c_str(),
+                               static_cast<std::uint32_t>(AT_FDCWD),
+                               reinterpret_cast<std::uint64_t>(renames[index].to.c_str()), index);
+      sqe->rename_flags = 0;
+    },
+    [&](std::size_t index, int result) {
+      if (result == 0) { on_done(index); return 0; }
+      // ENOENT is a missing source (skipped) or a missing target directory
+      std::error_code error_code{};
+      if (result == -ENOENT && !fs::exists(renames[index].from, error_code)) { return 0; }
+      return -result;
+    }
+  );
+
+  if (failure) {
+    auto const& rename = renames[failure->first];
+    throw fs::filesystem_error{"io_uring_backend::rename_files", rename.from, rename.to,
+                               std::error_code{failure->second, std::generic_category()}};
+  }
+}
+
+auto io_uring_backend::remove_files(std::span<fs::path const> files, completion const& on_done) -> void {
+  auto& ring = *ring_;
+  auto const failure = ring.run_batch(files.size(),
+    [&](std::size_t index) {
+      auto* sqe = ring.get_sqe(IORING_OP_UNLINKAT, AT_FDCWD, files[index].c_str(), 0, 0, index);
+      sqe->unlink_flags = 0;
+    },
+    [&](std::size_t index, int result) {
+      if (result == 0) { on_done(index); return 0; }
+      return result == -ENOENT ? 0 : -result;
+    }
+  );
+
+  if (failure) {
+    throw fs::filesystem_error{"io_uring_backend::remove_files", files[failure->first],
+                               std::error_code{failure->second, std::generic_category()}};
+  }
+}
+
+auto io_uring_backend::create_directories(std::span<fs::path const> directories,
+                                          completion const& on_done) -> void {
+  auto& ring = *ring_;
+  for (auto const& [depth, batch] : depth_batches(directories)) {
+    auto const failure = ring.run_batch(batch.size(),
+      [&](std::size_t index) {
+        ring.get_sqe(IORING_OP_MKDIRAT, AT_FDCWD, directories[batch[index]].c_str(), 0777, 0, index);
+      },
+      [&](std::size_t index, int result) {
+        if (result == 0) { on_done(batch[index]); return 0; }
+        if (result == -EEXIST) { return 0; }
+        if (result != -ENOENT) { return -result; }
+
+        // a parent that is not part of the batch is missing
+        std::error_code error_code{};
+        fs::create_directories(directories[batch[index]], error_code);
+        if (!error_code) { on_done(batch[index]); }
+        return error_code.value();
+      }
+    );
+
+    if (failure) {
+      throw fs::filesystem_error{"io_uring_backend::create_directories", directories[batch[failure->first]],
+                                 std::error_code{failure->second, std::generic_category()}};
+    }
+  }
+}
+
+auto io_uring_backend::remove_directories(std::span<fs::path const> directories,
+                                          completion const& on_done) -> void {
+  auto& ring = *ring_;
+  auto const batches = depth_batches(directories);
+  for (auto batch_iterator = batches.rbegin(); batch_iterator != batches.rend(); ++batch_iterator) {
+    auto const& batch = batch_iterator->second;
+    auto const failure = ring.run_batch(batch.size(),
+      [&](std::size_t index) {
+        auto* sqe = ring.get_sqe(IORING_OP_UNLINKAT, AT_FDCWD, directories[batch[index]].c_str(), 0, 0, index);
+        sqe->unlink_flags = AT_REMOVEDIR;
+      },
+      [&](std::size_t index, int result) {
+        if (result == 0) { on_done(batch[index]); return 0; }
+        return result == -ENOENT ? 0 : -result;
+      }
+    );
+
+    if (failure) {
+      throw fs::filesystem_error{"io_uring_backend::remove_directories", directories[batch[failure->first]],
+                                 std::error_code{failure->second, std::generic_category()}};
+    }
+  }
+}
+
+} // namespace dropclone
@@ -11,6 +11,8 @@
 #include <vector>
 #include <string_view>
 #include <string>
+#include <cstddef>
+#include <chrono>
 
 namespace dropclone {
 
@@ -60,6 +62,24 @@ auto nlohmann_json_parser::operator()(fs::path config_path) -> clone_config {
       );
     }
 
+    if (json_config.contains("max_concurrent_syncs")) {
+      if (!json_config["max_concurrent_syncs"].is_number_unsigned()) {
+        throw_exception<errorcode::config>(
+          errorcode::config::invalid_field_type, "max_concurrent_syncs"
+        );
+      }
+      config.max_concurrent_syncs = json_config["max_concurrent_syncs"].get<std::size_t>();
+    }
+
+    if (json_config.contains("sync_log_format")) {
+      if (!json_config["sync_log_format"].is_string()) {
+        throw_exception<errorcode::config>(
+          errorcode::config::invalid_field_type, "sync_log_format"
+        );
+      }
+      config.sync_log_format = json_config["sync_log_format"].get<log_format>();
+    }
+
     if (json_config["clone_config"].empty()) {
       throw_exception<errorcode::config>(
         errorcode::config::no_entries_defined, "clone_config"
@@ -93,13 +113,121 @@ auto nlohmann_json_parser::operator()(fs::path config_path) -> clone_config {
       auto exclude_patterns = get_patterns("exclude");
       auto include_patterns = get_patterns("include");
 
-      config.entries.emplace_back(
+      auto& entry = config.entries.emplace_back(
         elem["source_directory"],
         elem["destination_directory"],
         elem["mode"],
         exclude_patterns,
         include_patterns
       );
+
+      if (elem.contains("scan_threads")) {
+        if (!elem["scan_threads"].is_number_unsigned()) {
+          throw_exception<errorcode::config>(
+            errorcode::config::invalid_field_type, "scan_threads"
+          );
+        }
+        entry.scan_threads = elem["scan_threads"].get<std::size_t>();
+      }
+
+      if (elem.contains("copy_workers")) {
+        if (!elem["copy_workers"].is_number_unsigned()) {
+          throw_exception<errorcode::config>(
+            errorcode::config::invalid_field_type, "copy_workers"
+          );
+        }
+        entry.copy_workers = elem["copy_workers"].get<std::size_t>();
+      }
+
+      if (elem.contains("watch")) {
+        if (!elem["watch"].is_boolean()) {
+          throw_exception<errorcode::config>(
+            errorcode::config::invalid_field_type, "watch"
+          );
+        }
+        entry.watch = elem["watch"].get<bool>();
+      }
+
+      if (elem.contains("io_uring")) {
+        if (!elem["io_uring"].is_boolean()) {
+          throw_exception<errorcode::config>(
+            errorcode::config::invalid_field_type, "io_uring"
+          );
+        }
+        entry.io_uring = elem["io_uring"].get<bool>();
+      }
+
+      if (elem.contains("update_mode")) {
+        if (!elem["update_mode"].is_string()) {
+          throw_exception<errorcode::config>(
+            errorcode::config::invalid_field_type, "update_mode"
+          );
+        }
+        entry.update_mode = elem["update_mode"].get<update_mode>();
+      }
+
+      if (elem.contains("delta_min_size")) {
+        if (!elem["delta_min_size"].is_number_unsigned()) {
+          throw_exception<errorcode::config>(
+            errorcode::config::invalid_field_type, "delta_min_size"
+          );
+        }
+        entry.delta_min_size = elem["delta_min_size"].get<std::uintmax_t>();
+      }
+
+      if (elem.contains("compare")) {
+        if (!elem["compare"].is_string()) {
+          throw_exception<errorcode::config>(
+            errorcode::config::invalid_field_type, "compare"
+          );
+        }
+        entry.compare = elem["compare"].get<compare_strategy>();
+      }
+
+      if (elem.contains("durability")) {
+        if (!elem["durability"].is_string()) {
+          throw_exception<errorcode::config>(
+            errorcode::config::invalid_field_type, "durability"
+          );
+        }
+        entry.durability = elem["durability"].get<durability_mode>();
+      }
+
+      if (elem.contains("sync_budget_seconds")) {
+        if (!elem["sync_budget_seconds"].is_number_unsigned()) {
+          throw_exception<errorcode::config>(
+            errorcode::config::invalid_field_type, "sync_budget_seconds"
+          );
+        }
+        entry.sync_budget = std::chrono::seconds{elem["sync_budget_seconds"].get<std::size_t>()};
+      }
+
+      if (elem.contains("sync_interval_ms")) {
+        if (!elem["sync_interval_ms"].is_number_unsigned()) {
+          throw_exception<errorcode::config>(
+            errorcode::config::invalid_field_type, "sync_interval_ms"
+          );
+        }
+        entry.sync_interval = std::chrono::milliseconds{elem["sync_interval_ms"].get<std::size_t>()};
+      }
+
+      if (elem.contains("max_sync_interval_ms")) {
+        if (!elem["max_sync_interval_ms"].is_number_unsigned()) {
+          throw_exception<errorcode::config>(
+            errorcode::config::invalid_field_type, "max_sync_interval_ms"
+          );
+        }
+        entry.max_sync_interval = std::chrono::milliseconds{elem["max_sync_interval_ms"].get<std::size_t>()};
+      }
+
+      if (elem.contains("interval_mode")) {
+        if (!elem["interval_mode"].is_string()) {
+          throw_exception<errorcode::config>(
+            errorcode::config::invalid_field_type, "interval_mode"
+          );
+        }
+        entry.interval_mode = elem["interval_mode"].get<interval_mode>();
+      }
     }
   } catch (json::exception const& e) {
     throw_exception<errorcode::config>(
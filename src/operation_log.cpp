@@ -0,0 +1,304 @@
+#include <dropclone/operation_log.hpp>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <algorithm>
+#include <optional>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <cerrno>
+
+namespace dropclone {
+
+namespace fs = std::filesystem;
+namespace chr = std::chrono;
+namespace rng = std::ranges;
+
+namespace {
+
+constexpr char ring_magic[8]{'D', 'C', 'O', 'P', 'L', 'O', 'G', '2'};
+constexpr char strings_magic[8]{'D', 'C', 'S', 'T', 'R', 'N', 'G', '1'};
+
+struct ring_header {
+  char magic[8];
+  std::uint64_t capacity;
+  std::uint64_t next;             // records appended so far
+  std::uint64_t generation;       // of the string table new strings go to
+  std::uint64_t generation_start; // 'next' when that table was started
+  std::uint64_t reserved[3];
+};
+
+static_assert(sizeof(ring_header) == sizeof(operation_record));
+
+struct strings_header {
+  char magic[8];
+  std::uint64_t generation;
+};
+
+constexpr std::uint64_t missing_string{~std::uint64_t{0}};
+
+auto string_id(std::uint64_t generation, std::uint64_t index) noexcept -> std::uint64_t {
+  return generation << 32 | index;
+}
+
+[[noreturn]] auto fail(fs::path const& path, int error) -> void {
+  throw fs::filesystem_error{"operation_log", path, std::error_code{error, std::generic_category()}};
+}
+
+auto write_all(int descriptor, std::string_view data, fs::path const& path) -> void {
+  while (!data.empty()) {
+    auto const written = ::write(descriptor, data.data(), data.size());
+    if (written == -1 && errno == EINTR) { continue; }
+    if (written == -1) { fail(path, errno); }
+    data.remove_prefix(static_cast<std::size_t>(written));
+  }
+}
+
+auto read_file(fs::path const& path) -> std::string {
+  std::ifstream file_stream{path, std::ios::binary};
+  return std::string{std::istreambuf_iterator<char>{file_stream}, std::istreambuf_iterator<char>{}};
+}
+
+// the generation a string table was started for, std::nullopt if 'content'
+// is no string table
+auto table_generation(std::string_view content) -> std::optional<std::uint64_t> {
+  strings_header header{};
+  if (content.size() < sizeof(header)) { return std::nullopt; }
+  std::memcpy(&header, content.data(), sizeof(header));
+  if (std::memcmp(header.magic, strings_magic, sizeof(strings_magic)) != 0) { return std::nullopt; }
+  return header.generation;
+}
+
+// strings are stored as a 32-bit length followed by the bytes; returns the
+// strings and how many bytes of 'data' they cover
+auto parse_strings(std::string_view data) -> std::pair<std::vector<std::string>, std::size_t> {
+  std::vector<std::string> strings{};
+  std::size_t consumed{0};
+
+  while (data.size() - consumed >= sizeof(std::uint32_t)) {
+    std::uint32_t length{0};
+    std::memcpy(&length, data.data() + consumed, sizeof(length));
+    if (data.size() - consumed - sizeof(length) < length) { break; }
+
+    strings.emplace_back(data.substr(consumed + sizeof(length), length));
+    consumed += sizeof(length) + length;
+  }
+  return {std::move(strings), consumed};
+}
+
+} // namespace
+
+operation_log::operation_log(fs::path path, std::size_t capacity)
+  : path_{std::move(path)}, capacity_{std::max<std::size_t>(capacity, 1)}
+{
+  if (map_ring()) {
+    load_strings();
+  } else {
+    std::error_code error_code{};
+    fs::remove(strings_path(path_, 1), error_code);
+    start_strings(0);
+  }
+}
+
+operation_log::~operation_log() {
+  if (mapping_ != nullptr) { ::munmap(mapping_, mapping_size_); }
+  if (descriptor_ != -1) { ::close(descriptor_); }
+  if (strings_descriptor_ != -1) { ::close(strings_descriptor_); }
+}
+
+auto operation_log::strings_path(fs::path const& path, std::uint64_t generation) -> fs::path {
+  auto strings = path;
+  strings += generation % 2 == 0 ? ".strings.0" : ".strings.1";
+  return strings;
+}
+
+// true if an existing ring is continued
+auto operation_log::map_ring() -> bool {
+  descriptor_ = ::open(path_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  if (descriptor_ == -1) { fail(path_, errno); }
+
+  mapping_size_ = sizeof(ring_header) + capacity_ * sizeof(operation_record);
+
+  struct stat ring_status{};
+  if (::fstat(descriptor_, &ring_status) == -1) { fail(path_, errno); }
+
+  ring_header existing{};
+  auto const reusable = static_cast<std::size_t>(ring_status.st_size) == mapping_size_ &&
+    ::pread(descriptor_, &existing, sizeof(existing), 0) == sizeof(existing) &&
+    std::memcmp(existing.magic, ring_magic, sizeof(ring_magic)) == 0 &&
+    existing.capacity == capacity_;
+
+  // a ring of another size (or none at all) is started over
+  if (!reusable) {
+    if (::ftruncate(descriptor_, 0) == -1 ||
+        ::ftruncate(descriptor_, static_cast<off_t>(mapping_size_)) == -1) {
+      fail(path_, errno);
+    }
+  }
+
+  auto* const mapping = ::mmap(nullptr, mapping_size_, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor_, 0);
+  if (mapping == MAP_FAILED) { fail(path_, errno); }
+  mapping_ = static_cast<std::byte*>(mapping);
+
+  if (!reusable) {
+    auto* const header = reinterpret_cast<ring_header*>(mapping_);
+    std::memcpy(header->magic, ring_magic, sizeof(ring_magic));
+    header->capacity = capacity_;
+    header->next = 0;
+    header->generation = 0;
+    header->generation_start = 0;
+  }
+  return reusable;
+}
+
+auto operation_log::load_strings() -> void {
+  auto const* const header = reinterpret_cast<ring_header const*>(mapping_);
+  strings_path_ = strings_path(path_, header->generation);
+  auto const content = read_file(strings_path_);
+
+  // a table of another generation was left behind by a crash while starting one
+  if (table_generation(content) != header->generation) {
+    start_strings(header->generation + 1);
+    return;
+  }
+  auto [strings, consumed] = parse_strings(std::string_view{content}.substr(sizeof(strings_header)));
+
+  strings_descriptor_ = ::open(strings_path_.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+  if (strings_descriptor_ == -1) { fail(strings_path_, errno); }
+
+  // drop a string torn by a crash, so the next one is appended in place
+  if (sizeof(strings_header) + consumed != content.size() &&
+      ::ftruncate(strings_descriptor_, static_cast<off_t>(sizeof(strings_header) + consumed)) == -1) {
+    fail(strings_path_, errno);
+  }
+
+  string_ids_.reserve(strings.size());
+  for (std::uint32_t id{0}; id != strings.size(); ++id) {
+    string_ids_.emplace(std::move(strings[id]), id);
+  }
+}
+
+// Replaces the table two generations back, which shares the file name; the
+// ring header names the new generation only once its table exists.
+auto operation_log::start_strings(std::uint64_t generation) -> void {
+  if (strings_descriptor_ != -1) { ::close(strings_descriptor_); }
+
+  strings_path_ = strings_path(path_, generation);
+  strings_descriptor_ = ::open(strings_path_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+  if (strings_descriptor_ == -1) { fail(strings_path_, errno); }
+
+  strings_header table{};
+  std::memcpy(table.magic, strings_magic, sizeof(strings_magic));
+  table.generation = generation;
+  write_all(strings_descriptor_, {reinterpret_cast<char const*>(&table), sizeof(table)}, strings_path_);
+
+  auto* const header = reinterpret_cast<ring_header*>(mapping_);
+  header->generation_start = std::atomic_ref<std::uint64_t>{header->next}.load(std::memory_order_relaxed);
+  header->generation = generation;
+  string_ids_.clear();
+}
+
+auto operation_log::intern(std::string_view value) -> std::uint64_t {
+  std::lock_guard<std::mutex> strings_guard{strings_mutex_};
+  auto* const header = reinterpret_cast<ring_header*>(mapping_);
+
+  // every record that could refer to the previous table is overwritten by now
+  auto const next = std::atomic_ref<std::uint64_t>{header->next}.load(std::memory_order_relaxed);
+  if (next - header->generation_start >= capacity_) { start_strings(header->generation + 1); }
+
+  if (auto const found = string_ids_.find(value); found != std::end(string_ids_)) {
+    return string_id(header->generation, found->second);
+  }
+
+  auto const length = static_cast<std::uint32_t>(value.size());
+  std::string buffer(sizeof(length), '\0');
+  std::memcpy(buffer.data(), &length, sizeof(length));
+  buffer.append(value);
+  write_all(strings_descriptor_, buffer, strings_path_);
+
+  auto const id = static_cast<std::uint32_t>(string_ids_.size());
+  string_ids_.emplace(std::string{value}, id);
+  return string_id(header->generation, id);
+}
+
+auto operation_log::append(operation_record& record) -> void {
+  auto* const header = reinterpret_cast<ring_header*>(mapping_);
+  auto const position = std::atomic_ref<std::uint64_t>{header->next}.fetch_add(1, std::memory_order_relaxed);
+
+  auto* const slot = reinterpret_cast<operation_record*>(mapping_ + sizeof(ring_header)) + position % capacity_;
+  std::atomic_ref<std::uint64_t> sequence{slot->sequence};
+
+  record.time = chr::duration_cast<chr::nanoseconds>(chr::system_clock::now().time_since_epoch()).count();
+
+  sequence.store(0, std::memory_order_relaxed);
+  std::memcpy(reinterpret_cast<std::byte*>(slot) + sizeof(record.sequence),
+              reinterpret_cast<std::byte const*>(&record) + sizeof(record.sequence),
+              sizeof(record) - sizeof(record.sequence));
+  sequence.store(position + 1, std::memory_order_release);
+}
+
+auto operation_log::read(fs::path const& path) -> contents {
+  auto const ring = read_file(path);
+  if (ring.size() < sizeof(ring_header)) { fail(path, EINVAL); }
+
+  ring_header header{};
+  std::memcpy(&header, ring.data(), sizeof(header));
+  if (std::memcmp(header.magic, ring_magic, sizeof(ring_magic)) != 0 || header.capacity == 0 ||
+      ring.size() != sizeof(ring_header) + header.capacity * sizeof(operation_record)) {
+    fail(path, EINVAL);
+  }
+
+  contents log{};
+
+  // the tables of the current generation and of the one before it; ids are
+  // turned into indices into 'log.strings'
+  struct table { std::uint64_t generation; std::size_t offset; std::size_t size; };
+  std::vector<table> tables{};
+  for (auto generation = header.generation == 0 ? 0 : header.generation - 1;
+       generation <= header.generation; ++generation) {
+    auto const content = read_file(strings_path(path, generation));
+    if (table_generation(content) != generation) { continue; }
+
+    auto strings = parse_strings(std::string_view{content}.substr(sizeof(strings_header))).first;
+    tables.push_back({generation, log.strings.size(), strings.size()});
+    rng::move(strings, std::back_inserter(log.strings));
+  }
+
+  auto const resolve = [&](std::uint64_t id) {
+    auto const found = rng::find(tables, id >> 32, &table::generation);
+    auto const index = id & 0xFFFF'FFFFULL;
+    return found != rng::end(tables) && index < found->size ? found->offset + index : missing_string;
+  };
+
+  auto const first = header.next > header.capacity ? header.next - header.capacity : 0;
+  log.records.reserve(header.next - first);
+
+  for (auto position = first; position != header.next; ++position) {
+    operation_record record{};
+    std::memcpy(&record, ring.data() + sizeof(ring_header) + (position % header.capacity) * sizeof(record),
+                sizeof(record));
+    if (record.sequence != position + 1) { continue; }
+
+    for (std::size_t index{0}; index != operation_record::max_arguments; ++index) {
+      if (record.kinds[index] == operation_record::kind::string) {
+        record.arguments[index] = resolve(record.arguments[index]);
+      }
+    }
+    log.records.push_back(record);
+  }
+
+  return log;
+}
+
+} // namespace dropclone
@@ -0,0 +1,604 @@
+#include <dropclone/path_matcher.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <regex>
+#include <bitset>
+#include <map>
+#include <optional>
+#include <algorithm>
+#include <ranges>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+
+namespace dropclone {
+
+namespace rng = std::ranges;
+
+namespace {
+
+using byte_set = std::bitset<256>;
+
+// parsed pattern; 'bytes' nodes match one byte, 'begin' and 'end' are '^' and '$'
+struct node {
+  enum class kind { bytes, concat, alternate, repeat, begin, end };
+
+  kind type{kind::concat};
+  byte_set bytes{};
+  std::vector<node> children{};
+  int min{0};
+  int max{-1}; // -1: unbounded
+};
+
+// thrown for constructs outside the supported subset; the pattern is then
+// left to std::regex, which also reports syntax errors
+struct unsupported_pattern {};
+
+constexpr int max_repeat{256};
+
+auto fold_case(byte_set bytes) -> byte_set {
+  for (int lower{'a'}; lower <= 'z'; ++lower) {
+    auto const upper = lower - 'a' + 'A';
+    if (bytes[lower] || bytes[upper]) { bytes.set(lower).set(upper); }
+  }
+  return bytes;
+}
+
+auto range_set(int first, int last) -> byte_set {
+  byte_set bytes{};
+  for (auto byte = first; byte <= last; ++byte) { bytes.set(static_cast<std::size_t>(byte)); }
+  return bytes;
+}
+
+auto digit_set() -> byte_set { return range_set('0', '9'); }
+auto space_set() -> byte_set { return range_set('\t', '\r').set(' '); }
+auto word_set() -> byte_set { return range_set('a', 'z') | range_set('A', 'Z') | digit_set().set('_'); }
+
+// Recursive descent over the ECMAScript grammar, restricted to constructs a
+// DFA can express. All byte sets are case-folded before negation, like the
+// icase translation of std::regex.
+class regex_parser {
+ public:
+  explicit regex_parser(std::string_view pattern) : pattern_{pattern} {}
+
+  auto parse() -> std::optional<node> {
+    try {
+      auto result = parse_alternation();
+      if (position_ != pattern_.size()) { throw unsupported_pattern{}; }
+      return result;
+    } catch (unsupported_pattern const&) {
+      return std::nullopt;
+    }
+  }
+
+ private:
+  auto at_end() const noexcept -> bool { return position_ == pattern_.size(); }
+  auto peek() const noexcept -> char { return pattern_[position_]; }
+  auto next() -> char {
+    if (at_end()) { throw unsupported_pattern{}; }
+    return pattern_[position_++];
+  }
+
+  static auto make_bytes(byte_set bytes) -> node {
+    return node{node::kind::bytes, std::move(bytes)};
+  }
+
+  auto parse_alternation() -> node {
+    node alternation{node::kind::alternate};
+    alternation.children.push_back(parse_concatenation());
+    while (!at_end() && peek() == '|') {
+      ++position_;
+      alternation.children.push_back(parse_concatenation());
+    }
+    return alternation.children.size() == 1 ? std::move(alternation.children.front()) : alternation;
+  }
+
+  auto parse_concatenation() -> node {
+    node concatenation{node::kind::concat};
+    while (!at_end() && peek() != '|' && peek() != ')') {
+      concatenation.children.push_back(parse_quantified());
+    }
+    return concatenation;
+  }
+
+  auto parse_number() -> int {
+    int number{0};
+    bool any{false};
+    for (; !at_end() && peek() >= '0' && peek() <= '9'; ++position_, any = true) {
+      number = number * 10 + (peek() - '0');
+      if (number > max_repeat) { throw unsupported_pattern{}; }
+    }
+    if (!any) { throw unsupported_pattern{}; }
+    return number;
+  }
+
+  auto parse_quantified() -> node {
+    auto atom = parse_atom();
+    if (at_end()) { return atom; }
+
+    int min{0};
+    int max{-1};
+    switch (peek()) {
+      case '*': ++position_; break;
+      case '+': ++position_; min = 1; break;
+      case '?': ++position_; max = 1; break;
+      case '{': {
+        ++position_;
+        min = max = parse_number();
+        if (next() == ',') {
+          max = (!at_end() && peek() == '}') ? -1 : parse_number();
+          if (next() != '}') { throw unsupported_pattern{}; }
+        } else if (pattern_[position_ - 1] != '}') {
+          throw unsupported_pattern{};
+        }
+        if (max != -1 && max < min) { throw unsupported_pattern{}; }
+        break;
+      }
+      default: return atom;
+    }
+
+    if (atom.type == node::kind::begin || atom.type == node::kind::end) { throw unsupported_pattern{}; }
+    // lazy and greedy quantifiers find the same set of matches
+    if (!at_end() && peek() == '?') { ++position_; }
+
+    node repeat{node::kind::repeat};
+    repeat.min = min;
+    repeat.max = max;
+    repeat.children.push_back(std::move(atom));
+    return repeat;
+  }
+
+  auto parse_atom() -> node {
+    switch (auto const character = next()) {
+      case '^': return node{node::kind::begin};
+      case '$': return node{node::kind::end};
+      case '.': return make_bytes(~byte_set{}.set('\n').set('\r'));
+      case '[': return make_bytes(parse_class());
+      case '\\': return make_bytes(fold_case(parse_escape(false)));
+      case '(': {
+        if (!at_end() && peek() == '?') {
+          ++position_;
+          if (next() != ':') { throw unsupported_pattern{}; } // lookahead
+        }
+        auto group = parse_alternation();
+        if (next() != ')') { throw unsupported_pattern{}; }
+        return group;
+      }
+      case ')': case ']': case '{': case '}': case '*': case '+': case '?':
+        throw unsupported_pattern{};
+      default:
+        return make_bytes(fold_case(byte_set{}.set(static_cast<unsigned char>(character))));
+    }
+  }
+
+  auto parse_hex(int digits) -> int {
+    int value{0};
+    for (int digit{0}; digit != digits; ++digit) {
+      auto const character = next();
+      value *= 16;
+      if (character >= '0' && character <= '9') { value += character - '0'; }
+      else if (character >= 'a' && character <= 'f') { value += character - 'a' + 10; }
+      else if (character >= 'A' && character <= 'F') { value += character - 'A' + 10; }
+      else { throw unsupported_pattern{}; }
+    }
+    return value;
+  }
+
+  // returns the set of one escape, not yet case-folded; inside a class '\b'
+  // is a backspace
+  auto parse_escape(bool in_class) -> byte_set {
+    auto const character = next();
+    byte_set bytes{};
+    switch (character) {
+      case 'd': return digit_set();
+      case 'D': return ~digit_set();
+      case 's': return space_set();
+      case 'S': return ~space_set();
+      case 'w': return word_set();
+      case 'W': return ~word_set();
+      case 'n': return bytes.set('\n');
+      case 'r': return bytes.set('\r');
+      case 't': return bytes.set('\t');
+      case 'f': return bytes.set('\f');
+      case 'v': return bytes.set('\v');
+      case '0': return bytes.set(0);
+      case 'b':
+        if (!in_class) { throw unsupported_pattern{}; } // word boundary
+        return bytes.set('\b');
+      case 'x': return bytes.set(static_cast<std::size_t>(parse_hex(2)));
+      case 'u': {
+        auto const code_point = parse_hex(4);
+        if (code_point > 0x7F) { throw unsupported_pattern{}; }
+        return bytes.set(static_cast<std::size_t>(code_point));
+      }
+      case 'B': case 'c': case 'k':
+        throw unsupported_pattern{};
+      default:
+        if (character >= '1' && character <= '9') { throw unsupported_pattern{}; } // backreference
+        if ((character >= 'a' && character <= 'z') || (character >= 'A' && character <= 'Z')) {
+          throw unsupported_pattern{};
+        }
+        return bytes.set(static_cast<unsigned char>(character));
+    }
+  }
+
+  auto parse_class() -> byte_set {
+    bool negated{false};
+    if (!at_end() && peek() == '^') { ++position_; negated = true; }
+    // '[]' and '[^]' are read differently by the regex implementations
+    if (at_end() || peek() == ']') { throw unsupported_pattern{}; }
+
+    byte_set bytes{};
+    // a single byte of the class, or std::nullopt for a class escape like \d
+    auto const parse_class_atom = [&](byte_set& atom_bytes) -> std::optional<unsigned char> {
+      auto const character = next();
+      if (character == '[') { throw unsupported_pattern{}; } // POSIX classes like [:alpha:]
+      if (character != '\\') { return static_cast<unsigned char>(character); }
+      atom_bytes = parse_escape(true);
+      if (atom_bytes.count() == 1) {
+        for (std::size_t byte{0}; byte != 256; ++byte) {
+          if (atom_bytes[byte]) { return static_cast<unsigned char>(byte); }
+        }
+      }
+      return std::nullopt;
+    };
+
+    while (true) {
+      if (at_end()) { throw unsupported_pattern{}; }
+      if (peek() == ']') { ++position_; break; }
+
+      byte_set first_bytes{};
+      auto const first = parse_class_atom(first_bytes);
+
+      if (first && position_ + 1 < pattern_.size() && peek() == '-' && pattern_[position_ + 1] != ']') {
+        ++position_;
+        byte_set last_bytes{};
+        auto const last = parse_class_atom(last_bytes);
+        if (!last || *last < *first) { throw unsupported_pattern{}; }
+        bytes |= range_set(*first, *last);
+      } else if (first) {
+        bytes.set(*first);
+      } else {
+        bytes |= first_bytes;
+      }
+    }
+
+    bytes = fold_case(bytes);
+    return negated ? ~bytes : bytes;
+  }
+
+  std::string_view pattern_;
+  std::size_t position_{0};
+};
+
+// Thompson NFA; 'end' and 'accept' states are kept in DFA state sets
+struct nfa_state {
+  enum class kind { bytes, split, begin, end, accept };
+
+  kind type{kind::split};
+  byte_set bytes{};
+  int out{-1};
+  int out1{-1};
+};
+
+class nfa {
+ public:
+  auto add(nfa_state state) -> int {
+    states.push_back(std::move(state));
+    return static_cast<int>(states.size() - 1);
+  }
+
+  // emits 'pattern' so that a match continues at 'next'; returns its entry
+  auto emit(node const& pattern, int next) -> int {
+    if (states.size() > 64 * path_matcher::max_states) { throw unsupported_pattern{}; }
+
+    switch (pattern.type) {
+      case node::kind::bytes:
+        return add({nfa_state::kind::bytes, pattern.bytes, next});
+      case node::kind::begin:
+        return add({nfa_state::kind::begin, {}, next});
+      case node::kind::end:
+        return add({nfa_state::kind::end, {}, next});
+      case node::kind::concat:
+        for (auto const& child : pattern.children | std::views::reverse) { next = emit(child, next); }
+        return next;
+      case node::kind::alternate: {
+        auto entry = emit(pattern.children.back(), next);
+        for (auto const& child : pattern.children | std::views::reverse | std::views::drop(1)) {
+          entry = add({nfa_state::kind::split, {}, emit(child, next), entry});
+        }
+        return entry;
+      }
+      case node::kind::repeat: {
+        auto const& child = pattern.children.front();
+        if (pattern.max == -1) {
+          auto const loop = add({nfa_state::kind::split, {}, -1, next});
+          states[loop].out = emit(child, loop);
+          next = loop;
+        } else {
+          for (auto optional = pattern.max - pattern.min; optional != 0; --optional) {
+            next = add({nfa_state::kind::split, {}, emit(child, next), next});
+          }
+        }
+        for (auto required = pattern.min; required != 0; --required) { next = emit(child, next); }
+        return next;
+      }
+    }
+    return next;
+  }
+
+  // the kernel (bytes, end and accept states) reachable from 'from' without
+  // consuming input; '^' is only passed at the start of the path
+  auto closure(std::vector<int> const& from, bool at_start, bool at_end) const -> std::vector<int> {
+    std::vector<int> result{};
+    std::vector<bool> visited(states.size(), false);
+    std::vector<int> pending{from};
+
+    while (!pending.empty()) {
+      auto const state = pending.back();
+      pending.pop_back();
+      if (state < 0 || visited[state]) { continue; }
+      visited[state] = true;
+
+      auto const& current = states[state];
+      switch (current.type) {
+        case nfa_state::kind::split:
+          pending.push_back(current.out1);
+          pending.push_back(current.out);
+          break;
+        case nfa_state::kind::begin:
+          if (at_start) { pending.push_back(current.out); }
+          break;
+        case nfa_state::kind::end:
+          if (at_end) { pending.push_back(current.out); } else { result.push_back(state); }
+          break;
+        default:
+          result.push_back(state);
+      }
+    }
+
+    rng::sort(result);
+    return result;
+  }
+
+  std::vector<nfa_state> states{};
+  int start{-1};
+  int accept{-1};
+};
+
+} // namespace
+
+path_matcher::path_matcher(std::vector<std::string> const& patterns) : pattern_count_{patterns.size()} {
+  if (!compile(patterns)) {
+    // too many DFA states: leave everything to std::regex
+    has_dfa_ = false;
+    fallback_.clear();
+    rng::for_each(patterns, [&](auto const& pattern) {
+      auto const regex = pattern.starts_with(glob_prefix)
+                       ? glob_to_regex(std::string_view{pattern}.substr(glob_prefix.size()))
+                       : pattern;
+      fallback_.emplace_back(regex, std::regex::ECMAScript | std::regex_constants::icase | std::regex::optimize);
+    });
+  }
+}
+
+auto path_matcher::compile(std::vector<std::string> const& patterns) -> bool {
+  nfa automaton{};
+  automaton.accept = automaton.add({nfa_state::kind::accept});
+
+  std::vector<int> entries{};
+  rng::for_each(patterns, [&](auto const& pattern) {
+    auto const regex = pattern.starts_with(glob_prefix)
+                     ? glob_to_regex(std::string_view{pattern}.substr(glob_prefix.size()))
+                     : pattern;
+
+    std::optional<int> entry{};
+    if (auto parsed = regex_parser{regex}.parse()) {
+      auto const state_count = automaton.states.size();
+      try {
+        entry = automaton.emit(*parsed, automaton.accept);
+      } catch (unsupported_pattern const&) {
+        automaton.states.resize(state_count);
+      }
+    }
+
+    if (entry) {
+      entries.push_back(*entry);
+    } else {
+      fallback_.emplace_back(regex, std::regex::ECMAScript | std::regex_constants::icase | std::regex::optimize);
+    }
+  });
+
+  if (entries.empty()) { return true; }
+
+  automaton.start = entries.back();
+  for (auto const entry : entries | std::views::reverse | std::views::drop(1)) {
+    automaton.start = automaton.add({nfa_state::kind::split, {}, entry, automaton.start});
+  }
+
+  // byte classes: bytes that no pattern tells apart share a column
+  std::map<std::vector<bool>, std::uint8_t> signatures{};
+  for (std::size_t byte{0}; byte != 256; ++byte) {
+    std::vector<bool> signature{};
+    rng::for_each(automaton.states, [&](auto const& state) {
+      if (state.type == nfa_state::kind::bytes) { signature.push_back(state.bytes[byte]); }
+    });
+    auto const [found, inserted] = signatures.try_emplace(std::move(signature),
+                                                          static_cast<std::uint8_t>(signatures.size()));
+    byte_classes_[byte] = found->second;
+  }
+  class_count_ = signatures.size();
+
+  std::vector<unsigned char> representatives(class_count_);
+  for (std::size_t byte{256}; byte-- != 0; ) { representatives[byte_classes_[byte]] = static_cast<unsigned char>(byte); }
+
+  // subset construction; the initial state is kept apart because '^' can
+  // only be passed there. Search semantics: the NFA start is re-entered at
+  // every position.
+  std::map<std::pair<bool, std::vector<int>>, std::int32_t> ids{};
+  std::vector<std::pair<bool, std::vector<int>>> sets{};
+  auto const state_id = [&](bool initial, std::vector<int> set) -> std::int32_t {
+    if (set.empty()) { return dead_state; }
+    auto key = std::make_pair(initial, std::move(set));
+    if (auto found = ids.find(key); found != rng::end(ids)) { return found->second; }
+    auto const id = static_cast<std::int32_t>(sets.size());
+    ids.emplace(key, id);
+    sets.push_back(std::move(key));
+    return id;
+  };
+
+  start_state_ = state_id(true, automaton.closure({automaton.start}, true, false));
+  auto const idle_set = automaton.closure({automaton.start}, false, false);
+
+  for (std::size_t current{0}; current != sets.size(); ++current) {
+    if (sets.size() > max_states) { return false; }
+
+    auto const [initial, set] = sets[current];
+    bool const accepting = rng::binary_search(set, automaton.accept);
+    accepting_.push_back(accepting);
+    accepting_at_end_.push_back(accepting || rng::binary_search(
+      automaton.closure(set, initial, true), automaton.accept
+    ));
+
+    for (std::size_t byte_class{0}; byte_class != class_count_; ++byte_class) {
+      if (accepting) {
+        transitions_.push_back(static_cast<std::int32_t>(current));
+        continue;
+      }
+
+      std::vector<int> moved{automaton.start};
+      rng::for_each(set, [&](auto const state) {
+        auto const& nfa_state = automaton.states[state];
+        if (nfa_state.type == nfa_state::kind::bytes && nfa_state.bytes[representatives[byte_class]]) {
+          moved.push_back(nfa_state.out);
+        }
+      });
+      transitions_.push_back(state_id(false, automaton.closure(moved, false, false)));
+    }
+  }
+
+  if (auto const idle = ids.find(std::make_pair(false, idle_set)); idle != rng::end(ids)) {
+    idle_state_ = idle->second;
+    std::vector<unsigned char> exits{};
+    for (std::size_t byte{0}; byte != 256; ++byte) {
+      if (transitions_[idle_state_ * class_count_ + byte_classes_[byte]] != idle_state_) {
+        exits.push_back(static_cast<unsigned char>(byte));
+      }
+    }
+    if (exits.size() <= 2) { idle_exits_ = std::move(exits); }
+  }
+
+  has_dfa_ = true;
+  return true;
+}
+
+auto path_matcher::dfa_matches(std::string_view path) const -> bool {
+  auto const* data = path.data();
+  auto const* const end = data + path.size();
+  auto state = start_state_;
+
+  for (;;) {
+    if (state == dead_state) { return false; }
+    if (accepting_[state]) { return true; }
+
+    if (state == idle_state_ && !idle_exits_.empty()) {
+      auto const* next = end;
+      rng::for_each(idle_exits_, [&](auto const exit) {
+        if (auto const* found = static_cast<char const*>(std::memchr(data, exit, next - data))) { next = found; }
+      });
+      data = next;
+    }
+
+    if (data == end) { return accepting_at_end_[state]; }
+    state = transitions_[state * class_count_ + byte_classes_[static_cast<unsigned char>(*data++)]];
+  }
+}
+
+auto path_matcher::matches(std::string_view path) const -> bool {
+  if (has_dfa_ && dfa_matches(path)) { return true; }
+  return rng::any_of(fallback_, [&](auto const& regex) {
+    return std::regex_search(path.begin(), path.end(), regex);
+  });
+}
+
+auto path_matcher::glob_to_regex(std::string_view glob) -> std::string {
+  constexpr std::string_view special{".^$|()[]{}*+?\\"};
+
+  bool const anchored = glob.starts_with('/') || glob.substr(0, glob.size() - 1).find('/') != std::string_view::npos;
+  if (glob.starts_with('/')) { glob.remove_prefix(1); }
+  // paths carry no type, so 'build/' matches the directory 'build' itself too
+  if (glob.ends_with('/')) { glob.remove_suffix(1); }
+
+  std::string regex{anchored ? "^" : "(^|/)"};
+  for (std::size_t index{0}; index < glob.size(); ++index) {
+    auto const character = glob[index];
+    auto const rest = glob.substr(index);
+    bool const at_component_start = index == 0 || glob[index - 1] == '/';
+
+    if (rest.starts_with("**/") && at_component_start) {
+      regex += "(.*/)?";
+      index += 2;
+    } else if (rest.starts_with("**")) {
+      regex += ".*";
+      index += 1;
+    } else if (character == '*') {
+      regex += "[^/]*";
+    } else if (character == '?') {
+      regex += "[^/]";
+    } else if (auto const close = glob.find(']', index + 2); character == '[' && close != std::string_view::npos) {
+      auto contents = glob.substr(index + 1, close - index - 1);
+      bool const negated = contents.starts_with('!') || contents.starts_with('^');
+      if (negated) { contents.remove_prefix(1); }
+
+      // like '*' and '?', a class never matches the component separator
+      std::string members{};
+      auto const add_member = [&](char const member) {
+        if (member == '\\' || member == '[' || member == ']' || member == '^' || member == '-') { members += '\\'; }
+        members += member;
+      };
+      auto const add_range = [&](char const first, char const last) {
+        if (first > last) { return; }
+        add_member(first);
+        if (first != last) { members += '-'; add_member(last); }
+      };
+      for (std::size_t member{0}; member < contents.size(); ++member) {
+        auto const first = contents[member];
+        if (member + 2 < contents.size() && contents[member + 1] == '-') {
+          auto const last = contents[member + 2];
+          member += 2;
+          if (first <= '/' && '/' <= last) {
+            add_range(first, '/' - 1);
+            add_range('/' + 1, last);
+          } else {
+            add_member(first);
+            members += '-';
+            add_member(last);
+          }
+        } else if (first != '/') {
+          add_member(first);
+        }
+      }
+
+      if (negated) {
+        regex += "[^" + members + "/]";
+      } else {
+        regex += members.empty() ? "[^\\s\\S]" : "[" + members + "]";
+      }
+      index = close;
+    } else if (character == '\\' && index + 1 < glob.size()) {
+      ++index;
+      if (special.find(glob[index]) != std::string_view::npos) { regex += '\\'; }
+      regex += glob[index];
+    } else {
+      if (special.find(character) != std::string_view::npos) { regex += '\\'; }
+      regex += character;
+    }
+  }
+
+  // a directory matches together with everything below it
+  regex += "(/|$)";
+  return regex;
+}
+
+} // namespace dropclone
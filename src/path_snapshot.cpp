@@ -1,15 +1,19 @@
 #include <dropclone/path_snapshot.hpp>
+#include <dropclone/directory_scanner.hpp>
 #include <dropclone/exception.hpp>
 #include <dropclone/errorcode.hpp>
 #include <ranges>
 #include <algorithm>
 #include <filesystem>
-#include <numeric>
-#include <execution>
+#include <vector>
+#include <unordered_set>
+#include <cstdint>
 #include <utility>
 #include <functional>
 #include <system_error>
 #include <chrono> 
+#include <string_view>
+#include <stdexcept>
 
 namespace dropclone {
 
@@ -22,6 +26,85 @@ namespace dropclone {
     : root_{std::move(root)}, creation_time{chr::steady_clock::now()} 
   {}
 
+  path_snapshot::path_snapshot(fs::path root, snapshot_entries const& entries) 
+    : root_{std::move(root)}, creation_time{chr::steady_clock::now()}
+  {
+    paths_.reserve(entries.size() + 1);
+    rng::for_each(entries, [&](auto const& entry) { set_entry(entry.first, entry.second, false); });
+    compute_hash();
+  }
+
+  path_snapshot::path_snapshot(fs::path root, entry_list const& entries) 
+    : root_{std::move(root)}, creation_time{chr::steady_clock::now()}
+  {
+    paths_.reserve(entries.size() + 1);
+    rng::for_each(entries, [&](auto const& entry) { set_entry(entry.first, entry.second, false); });
+    compute_hash();
+  }
+
+  auto path_snapshot::set_entry(fs::path const& relative_path, path_info const& info, bool overwrite) -> index_type {
+    auto const index = paths_.insert(relative_path);
+    if (paths_.size() > infos_.size()) {
+      infos_.resize(paths_.size());
+      present_.resize(paths_.size(), false);
+      directory_hashes_.resize(paths_.size(), 0);
+      has_subtree_.resize(paths_.size(), false);
+    }
+
+    if (!present_[index]) {
+      present_[index] = true;
+      ++entry_count_;
+    } else if (!overwrite) {
+      return index;
+    }
+    infos_[index] = info;
+    return index;
+  }
+
+  // the index of the erased entry; npos if there was none
+  auto path_snapshot::erase_entry(fs::path const& relative_path) -> index_type {
+    auto const index = paths_.find(relative_path);
+    if (index == path_table::npos || !present_[index]) { return path_table::npos; }
+    present_[index] = false;
+    --entry_count_;
+    return index;
+  }
+
+  // rebuilds the path table from the present entries once erased entries
+  // (e.g. after many incremental updates) make up most of it
+  auto path_snapshot::compact() -> bool {
+    if (paths_.size() < 4096 || paths_.size() < 2 * entry_count_) { return false; }
+
+    path_table paths{};
+    paths.reserve(entry_count_ + 1);
+    std::vector<path_info> infos(1);
+    std::vector<bool> present(1, false);
+
+    std::vector<std::pair<index_type, index_type>> pending{{path_table::root, path_table::root}};
+    while (!pending.empty()) {
+      auto const [old_directory, new_directory] = pending.back();
+      pending.pop_back();
+
+      for (auto child = paths_.first_child(old_directory); child != path_table::npos; 
+           child = paths_.next_sibling(child)) {
+        if (!is_live(child)) { continue; }
+        auto const new_child = paths.insert_child(new_directory, paths_.name(child));
+        infos.resize(paths.size());
+        present.resize(paths.size(), false);
+        infos[new_child] = infos_[child];
+        present[new_child] = present_[child];
+        if (has_subtree_[child]) { pending.emplace_back(child, new_child); }
+      }
+    }
+
+    paths_ = std::move(paths);
+    infos_ = std::move(infos);
+    present_ = std::move(present);
+    directory_hashes_.assign(paths_.size(), 0);
+    has_subtree_.assign(paths_.size(), false);
+    return true;
+  }
+
   auto path_snapshot::local_diff(path_snapshot const& other) -> path_snapshot {
     path_snapshot result{root_};
 
@@ -33,42 +116,78 @@ namespace dropclone {
       }
     };
 
-    rng::for_each(entries_, [&](auto& entry) {
-      if (auto found = other.entries_.find(entry.first); found == rng::end(other.entries_)) {
-          entry.second.path_status = creation_time < other.creation_time 
-                                     ? path_info::status::deleted 
-                                     : path_info::status::added; 
-          emplace(entry.first, entry.second);
+    auto const compare = [&](index_type index, index_type other_index) {
+      auto& info = infos_[index];
+      if (other_index == path_table::npos || !other.present_[other_index]) {
+          info.path_status = creation_time < other.creation_time 
+                             ? path_info::status::deleted 
+                             : path_info::status::added; 
+          emplace(paths_.path(index), info);
       } else {
-        if (entry.second.last_write_time != found->second.last_write_time ||
-            entry.second.file_size != found->second.file_size ||
-            entry.second.file_perms != found->second.file_perms) {
-          entry.second.path_status = path_info::status::updated;
-          emplace(entry.first, entry.second);
+        auto const& other_info = other.infos_[other_index];
+        if (info.last_write_time != other_info.last_write_time ||
+            info.file_size != other_info.file_size ||
+            info.file_perms != other_info.file_perms) {
+          info.path_status = path_info::status::updated;
+          emplace(paths_.path(index), info);
         } 
       } 
-    });
+    };
+
+    // Descend only into directories whose subtree hash differs from the one
+    // in 'other'; identical subtrees cannot contain a difference. Both path
+    // tables are walked side by side.
+    std::vector<std::pair<index_type, index_type>> pending_directories{
+      {path_table::root, path_table::root}
+    };
+    while (!pending_directories.empty()) {
+      auto const [directory, other_directory] = pending_directories.back();
+      pending_directories.pop_back();
+
+      if (!has_subtree_[directory]) { continue; }
+      if (other_directory != path_table::npos && other.has_subtree_[other_directory] &&
+          other.directory_hashes_[other_directory] == directory_hashes_[directory]) {
+        continue;
+      }
+
+      for (auto child = paths_.first_child(directory); child != path_table::npos; 
+           child = paths_.next_sibling(child)) {
+        if (!is_live(child)) { continue; }
+        auto const other_child = other_directory == path_table::npos 
+                               ? path_table::npos 
+                               : other.paths_.find_child(other_directory, paths_.name(child));
+        if (present_[child]) { compare(child, other_child); }
+        if (has_subtree_[child]) { pending_directories.emplace_back(child, other_child); }
+      }
+    }
 
     // Correct directories falsely marked as 'updated':
     // If a directory is flagged due to structural changes (e.g. deletion of 
     // child files/directories), but no new or modified entries remain inside,
     // reset its status to 'unchanged' to avoid unnecessary copy operations.
-    rng::for_each(result.directories(), [&](auto& directory) {
-      auto const is_relevant_change = [&](auto const& entry) {
-        return entry.first != directory.first &&
-               entry.first.string().starts_with(directory.first.string()) &&
-               entry.second.path_status != path_info::status::deleted;
-      };
+    //
+    // Every relevant (non-deleted) entry marks its ancestors in one upward
+    // walk, which stops at the first ancestor that is already marked, so
+    // the pass stays linear in the number of changed entries.
+    std::unordered_set<fs::path> changed_directories{};
+    auto const mark_ancestors = [&](auto const& entry) {
+      if (entry.second.path_status == path_info::status::deleted) { return; }
+      for (auto ancestor = entry.first.parent_path(); 
+           !ancestor.empty() && changed_directories.insert(ancestor).second; 
+           ancestor = ancestor.parent_path()) {}
+    };
+    rng::for_each(result.files(), mark_ancestors);
+    rng::for_each(result.directories(), mark_ancestors);
 
+    rng::for_each(result.directories(), [&](auto& directory) {
       if (bool relevant_change = 
                 directory.second.path_status == path_info::status::deleted || 
-                rng::any_of(result.files(), is_relevant_change) ||
-                rng::any_of(result.directories(), is_relevant_change); 
+                changed_directories.contains(directory.first);
           !relevant_change) {
         // 1. Empty directories receive the status 'structurally_required' to ensure they are
         //    created in the destination, even if they contain no added or updated entries.
-        // 2. When deleting files, they are first moved to a .trash directory for potential recovery.
-        //    To copy them there, the required directory structure (e.g. .trash/dir1/dir2/) must exist.
+        // 2. When deleting files, they are first moved to a trash directory for potential recovery.
+        //    To rename them there, the required directory structure (e.g. <trash>/dir1/dir2/) must exist.
         //    These intermediate directories are also marked as 'structurally_required'.
         directory.second.path_status = path_info::status::structurally_required;
       }
@@ -77,29 +196,17 @@ namespace dropclone {
     return result;
   }
 
-  auto path_snapshot::make(path_filter filter) -> void { 
+  auto path_snapshot::make(path_filter filter, std::size_t thread_count, path_filter prune) -> void { 
     try {
-      std::error_code error_code{};
-      auto recursive_directory_view = 
-        fs::recursive_directory_iterator{root_, fs::directory_options::none, error_code} 
-        | vws::filter([&](auto const& entry) { return filter(entry.path()); });
-
-      for (auto const& dir_entry : recursive_directory_view) {
-        auto const relative_entry_path = fs::relative(dir_entry.path(), root_);
-        if (error_code == std::errc::permission_denied) {
-          path_info info{};
-          info.conflict = path_conflict_t::access_denied;
-          conflicts_.emplace(relative_entry_path, info);
-          error_code.clear();
-        } else {
-          entries_.try_emplace(relative_entry_path,
-            dir_entry.last_write_time(), 
-            dir_entry.is_directory() ? 0 : dir_entry.file_size(), 
-            dir_entry.status().permissions(),
-            dir_entry.is_directory()
-          ); 
-        }
-      }
+      // one thread scans on the calling thread, with the same rules for
+      // unreadable directories as any number of threads
+      auto scan_result = directory_scanner{root_, std::move(filter), thread_count, std::move(prune)}.scan();
+      paths_.reserve(scan_result.entries.size() + 1);
+      rng::for_each(scan_result.entries, [&](auto const& entry) { 
+        set_entry(entry.first, entry.second, false); 
+      });
+      conflicts_ = std::move(scan_result.conflicts);
+      pruned_ = scan_result.pruned;
     } catch (fs::filesystem_error const& e) {
       throw_exception<errorcode::filesystem>(
         errorcode::filesystem::failed_to_traverse_directory,
@@ -113,14 +220,165 @@ namespace dropclone {
         e.what()
       );
     }
-    hash_ = compute_hash(); 
+    compute_hash(); 
   }
   
-  auto path_snapshot::compute_hash() const -> size_t {
-    return std::reduce(std::execution::par, rng::begin(entries_), rng::end(entries_), size_t{0}, 
-      [](size_t seed, auto const& file) {
-        return std::bit_xor{}(seed, std::hash<path_info>{}(file.second));
-    }); 
+  auto path_snapshot::make(path_changes const& changes, path_filter filter, path_filter prune) -> void {
+    try {
+      rng::for_each(changes, [&](auto const& change) {
+        std::error_code error_code{};
+        fs::directory_entry const dir_entry{root_ / change.path, error_code};
+        if (error_code || !dir_entry.exists(error_code)) { return; }
+
+        auto const info = directory_scanner::entry_info(dir_entry);
+        if (!info) { return; }
+
+        if (change.subtree && info->is_directory && !dir_entry.is_symlink(error_code) && !error_code) {
+          if (prune && prune(dir_entry.path())) {
+            ++pruned_;
+          } else {
+            // the same rules for unreadable directories as the full scan
+            auto scan_result = directory_scanner{root_, filter, 1, prune}.scan(change.path);
+            rng::for_each(scan_result.entries, [&](auto const& entry) { 
+              set_entry(entry.first, entry.second, true); 
+            });
+            // an earlier change may have listed the unreadable directory
+            rng::for_each(scan_result.conflicts, [&](auto const& conflict) { erase_entry(conflict.first); });
+            conflicts_.merge(scan_result.conflicts);
+            pruned_ += scan_result.pruned;
+          }
+        }
+
+        if (change.path.empty() || conflicts_.contains(change.path)) { return; }
+        if (filter(dir_entry.path())) { set_entry(change.path, *info, true); }
+      });
+    } catch (fs::filesystem_error const& e) {
+      throw_exception<errorcode::filesystem>(
+        errorcode::filesystem::failed_to_traverse_directory,
+        root_.string(),
+        "path_snapshot::make(changes)",
+        e.what()
+      );
+    }
+    compute_hash();
+  }
+
+  auto path_snapshot::extract(path_changes const& changes) const -> path_snapshot {
+    path_snapshot result{root_};
+    result.creation_time = creation_time;
+
+    rng::for_each(changes, [&](auto const& change) {
+      auto const index = paths_.find(change.path);
+      if (index == path_table::npos) { return; }
+      if (present_[index]) { result.set_entry(change.path, infos_[index], false); }
+      if (!change.subtree) { return; }
+
+      std::vector<index_type> pending_directories{index};
+      while (!pending_directories.empty()) {
+        auto const directory = pending_directories.back();
+        pending_directories.pop_back();
+        for (auto child = paths_.first_child(directory); child != path_table::npos; 
+             child = paths_.next_sibling(child)) {
+          if (present_[child]) { result.set_entry(paths_.path(child), infos_[child], false); }
+          if (has_subtree_[child]) { pending_directories.push_back(child); }
+        }
+      }
+    });
+
+    result.compute_hash();
+    return result;
+  }
+
+  auto path_snapshot::update(path_snapshot const& previous, path_snapshot const& current) -> void {
+    std::vector<index_type> changed_entries{};
+    changed_entries.reserve(previous.entries().size() + current.entries().size());
+    rng::for_each(previous.entries(), [&](auto const& entry) { 
+      changed_entries.push_back(erase_entry(entry.first)); 
+    });
+    rng::for_each(current.entries(), [&](auto const& entry) { 
+      changed_entries.push_back(set_entry(entry.first, entry.second, true)); 
+    });
+    creation_time = current.creation_time;
+    rehash_ancestors(changed_entries);
+    if (compact()) { compute_hash(); }
+  }
+
+  auto path_snapshot::directory_hash(fs::path const& directory) const noexcept -> size_t {
+    auto const index = paths_.find(directory);
+    return index == path_table::npos || !has_subtree_[index] ? size_t{0} : directory_hashes_[index];
+  }
+
+  auto path_snapshot::compute_hash() -> void {
+    directory_hashes_.assign(paths_.size(), 0);
+    has_subtree_.assign(paths_.size(), false);
+    hash_ = compute_directory_hash(path_table::root);
+  }
+
+  auto path_snapshot::compute_directory_hash(index_type directory) -> size_t {
+    for (auto child = paths_.first_child(directory); child != path_table::npos; 
+         child = paths_.next_sibling(child)) {
+      compute_directory_hash(child);
+    }
+    rehash_directory(directory);
+    return directory_hashes_[directory];
+  }
+
+  // Only the directories above the changed entries hash anything new; they
+  // are rehashed deepest first, from the stored hashes of their children, so
+  // an update costs the fan-out along its paths instead of the whole tree.
+  auto path_snapshot::rehash_ancestors(std::vector<index_type> const& entries) -> void {
+    std::unordered_set<index_type> stale_directories{};
+    rng::for_each(entries, [&](index_type entry) {
+      if (entry == path_table::npos) { return; }
+      // once a directory is stale, so are all directories above it
+      for (auto directory = paths_.parent(entry); 
+           directory != path_table::npos && stale_directories.insert(directory).second; 
+           directory = paths_.parent(directory)) {}
+    });
+
+    auto const depth = [&](index_type directory) {
+      std::size_t depth{0};
+      for (; directory != path_table::root; directory = paths_.parent(directory)) { ++depth; }
+      return depth;
+    };
+
+    std::vector<std::pair<std::size_t, index_type>> ordered_directories{};
+    ordered_directories.reserve(stale_directories.size());
+    rng::for_each(stale_directories, [&](index_type directory) { 
+      ordered_directories.emplace_back(depth(directory), directory); 
+    });
+    rng::sort(ordered_directories, std::greater{});
+
+    rng::for_each(ordered_directories, [&](auto const& directory) { rehash_directory(directory.second); });
+    hash_ = directory_hashes_[path_table::root];
+  }
+
+  auto path_snapshot::rehash_directory(index_type directory) -> void {
+    // splitmix64 finalizer; spreads the identity-like std::hash of integers
+    // so that the additive combination below does not cancel out
+    auto const mix = [](std::uint64_t value) -> size_t {
+      value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+      return value ^ (value >> 31);
+    };
+
+    size_t hash{0};
+    bool has_subtree{false};
+    for (auto child = paths_.first_child(directory); child != path_table::npos; 
+         child = paths_.next_sibling(child)) {
+      // erased entries stay in the path table until it is compacted
+      if (!is_live(child)) { continue; }
+
+      auto const info_hash = !present_[child] ? size_t{0}
+                           : mix(std::hash<path_info>{}(infos_[child]) ^ infos_[child].is_directory);
+      auto const name_hash = std::hash<std::string_view>{}(paths_.name(child));
+      // addition keeps the directory hash independent of the child order
+      hash += mix(name_hash ^ mix(info_hash + 0x9e3779b97f4a7c15ULL * directory_hashes_[child]));
+      has_subtree = true;
+    }
+
+    directory_hashes_[directory] = hash;
+    has_subtree_[directory] = has_subtree;
   }
 
   auto path_snapshot::add_files(snapshot_entries const& entries, entry_filter filter) -> void {
@@ -139,4 +397,60 @@ namespace dropclone {
     root_ = new_root;
   }
 
+  path_snapshot::entry_view::iterator::iterator(path_snapshot const* snapshot, index_type index) noexcept
+    : snapshot_{snapshot}, index_{index} 
+  {
+    skip_absent();
+  }
+
+  auto path_snapshot::entry_view::iterator::skip_absent() noexcept -> void {
+    while (index_ < snapshot_->present_.size() && !snapshot_->present_[index_]) { ++index_; }
+  }
+
+  auto path_snapshot::entry_view::iterator::operator*() const -> value_type {
+    auto const index = static_cast<index_type>(index_);
+    return value_type{snapshot_->paths_.path(index), snapshot_->infos_[index]};
+  }
+
+  auto path_snapshot::entry_view::iterator::operator++() noexcept -> iterator& {
+    ++index_;
+    skip_absent();
+    return *this;
+  }
+
+  auto path_snapshot::entry_view::iterator::operator++(int) noexcept -> iterator {
+    auto previous = *this;
+    ++*this;
+    return previous;
+  }
+
+  auto path_snapshot::entry_view::begin() const noexcept -> iterator { 
+    return iterator{snapshot_, path_table::root}; 
+  }
+
+  auto path_snapshot::entry_view::end() const noexcept -> iterator {
+    return iterator{snapshot_, static_cast<index_type>(snapshot_->present_.size())};
+  }
+
+  auto path_snapshot::entry_view::find(fs::path const& relative_path) const -> path_info const* {
+    auto const index = snapshot_->paths_.find(relative_path);
+    if (index == path_table::npos || index >= snapshot_->present_.size() || !snapshot_->present_[index]) { 
+      return nullptr; 
+    }
+    return &snapshot_->infos_[index];
+  }
+
+  auto path_snapshot::entry_view::at(fs::path const& relative_path) const -> path_info const& {
+    if (auto const* info = find(relative_path)) { return *info; }
+    throw std::out_of_range{"path_snapshot::entry_view::at: " + relative_path.string()};
+  }
+
+  auto path_snapshot::entry_view::operator==(entry_view const& other) const -> bool {
+    if (size() != other.size()) { return false; }
+    return rng::all_of(*this, [&](auto const& entry) {
+      auto const* other_info = other.find(entry.first);
+      return other_info != nullptr && *other_info == entry.second;
+    });
+  }
+
 } // namespace dropclone
\ No newline at end of file
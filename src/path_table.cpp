@@ -0,0 +1,130 @@
+#include <dropclone/path_table.hpp>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+namespace dropclone {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr std::size_t initial_slot_count{1024};
+
+// calls 'visit' for every non-empty component of a relative path
+template <typename Visitor>
+auto for_each_component(std::string_view path, Visitor&& visit) -> bool {
+  while (!path.empty()) {
+    auto const separator = path.find('/');
+    auto const component = path.substr(0, separator);
+    if (!component.empty() && !visit(component)) { return false; }
+    if (separator == std::string_view::npos) { break; }
+    path.remove_prefix(separator + 1);
+  }
+  return true;
+}
+
+} // namespace
+
+path_table::path_table() {
+  nodes_.emplace_back();
+  slots_.assign(initial_slot_count, npos);
+}
+
+auto path_table::slot_of(index_type parent, std::string_view name) const noexcept -> std::size_t {
+  auto hash = static_cast<std::uint64_t>(std::hash<std::string_view>{}(name));
+  hash ^= (static_cast<std::uint64_t>(parent) + 0x9e3779b97f4a7c15ULL) * 0xbf58476d1ce4e5b9ULL;
+  hash ^= hash >> 31;
+  return static_cast<std::size_t>(hash) & (slots_.size() - 1);
+}
+
+auto path_table::find_child(index_type parent, std::string_view name) const -> index_type {
+  for (auto slot = slot_of(parent, name); ; slot = (slot + 1) & (slots_.size() - 1)) {
+    auto const index = slots_[slot];
+    if (index == npos) { return npos; }
+    if (nodes_[index].parent == parent && this->name(index) == name) { return index; }
+  }
+}
+
+auto path_table::insert_child(index_type parent, std::string_view name) -> index_type {
+  if (auto const found = find_child(parent, name); found != npos) { return found; }
+
+  // keep the table at most half full
+  if (2 * nodes_.size() >= slots_.size()) { rehash(2 * slots_.size()); }
+
+  auto const index = static_cast<index_type>(nodes_.size());
+  node& child = nodes_.emplace_back();
+  child.parent = parent;
+  child.next_sibling = nodes_[parent].first_child;
+  child.name_offset = names_.size();
+  child.name_length = static_cast<std::uint32_t>(name.size());
+  names_.append(name);
+  nodes_[parent].first_child = index;
+
+  auto slot = slot_of(parent, name);
+  while (slots_[slot] != npos) { slot = (slot + 1) & (slots_.size() - 1); }
+  slots_[slot] = index;
+
+  return index;
+}
+
+auto path_table::find(fs::path const& relative_path) const -> index_type {
+  auto index = root;
+  for_each_component(relative_path.native(), [&](std::string_view component) {
+    index = find_child(index, component);
+    return index != npos;
+  });
+  return index;
+}
+
+auto path_table::insert(fs::path const& relative_path) -> index_type {
+  auto index = root;
+  for_each_component(relative_path.native(), [&](std::string_view component) {
+    index = insert_child(index, component);
+    return true;
+  });
+  return index;
+}
+
+auto path_table::path(index_type index) const -> fs::path {
+  std::size_t length{0};
+  std::size_t depth{0};
+  for (auto current = index; current != root; current = nodes_[current].parent, ++depth) {
+    length += nodes_[current].name_length;
+  }
+  if (depth == 0) { return fs::path{}; }
+
+  std::string result(length + depth - 1, '/');
+  auto position = result.size();
+  for (auto current = index; current != root; current = nodes_[current].parent) {
+    auto const component = name(current);
+    position -= component.size();
+    std::copy(std::begin(component), std::end(component), std::begin(result) + position);
+    if (position != 0) { --position; }
+  }
+
+  return fs::path{std::move(result)};
+}
+
+auto path_table::reserve(std::size_t node_count) -> void {
+  nodes_.reserve(node_count);
+  auto slot_count = slots_.size();
+  while (slot_count < 2 * node_count) { slot_count *= 2; }
+  if (slot_count != slots_.size()) { rehash(slot_count); }
+}
+
+auto path_table::rehash(std::size_t slot_count) -> void {
+  slots_.assign(slot_count, npos);
+  for (index_type index{1}; index < nodes_.size(); ++index) {
+    auto slot = slot_of(nodes_[index].parent, name(index));
+    while (slots_[slot] != npos) { slot = (slot + 1) & (slots_.size() - 1); }
+    slots_[slot] = index;
+  }
+}
+
+} // namespace dropclone
@@ -0,0 +1,200 @@
+#include <dropclone/path_watcher.hpp>
+#include <dropclone/path_snapshot.hpp>
+#include <dropclone/logger_manager.hpp>
+#include <dropclone/errorcode.hpp>
+#include <dropclone/messagecode.hpp>
+#include <dropclone/utility.hpp>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <filesystem>
+#include <unordered_map>
+#include <system_error>
+#include <algorithm>
+#include <ranges>
+#include <cerrno>
+#include <cstring>
+#include <cstdint>
+
+namespace dropclone {
+
+namespace fs = std::filesystem;
+namespace rng = std::ranges;
+
+namespace {
+
+constexpr std::uint32_t watch_mask =
+  IN_CREATE | IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | IN_DELETE |
+  IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF |
+  IN_ONLYDIR | IN_EXCL_UNLINK;
+
+auto is_same_or_descendant(fs::path const& path, fs::path const& ancestor) -> bool {
+  auto const [path_end, ancestor_end] = rng::mismatch(path, ancestor);
+  return ancestor_end == rng::end(ancestor);
+}
+
+} // namespace
+
+path_watcher::path_watcher(fs::path root, path_snapshot::path_filter prune) 
+  : root_{std::move(root)}, prune_{std::move(prune)} 
+{
+  descriptor_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (descriptor_ == -1) {
+    logger.get(logger_id::sync)->warn(
+      utility::formatter<errorcode::watch>::format(
+        errorcode::watch::watch_failed,
+        root_.string(), std::strerror(errno)
+    ));
+    return;
+  }
+
+  active_ = true;
+  add_watches(fs::path{});
+
+  if (active_) {
+    logger.info<messagecode::watch, messagecode::watch::watch_started>(
+      logger_id::sync,
+      root_, watches_.size()
+    );
+  }
+}
+
+path_watcher::~path_watcher() {
+  if (descriptor_ != -1) { ::close(descriptor_); }
+}
+
+auto path_watcher::add_watch(fs::path const& relative_directory) -> bool {
+  auto const watch = ::inotify_add_watch(
+    descriptor_, (root_ / relative_directory).c_str(), watch_mask
+  );
+
+  if (watch == -1) {
+    // the directory vanished between listing and watching – its parent
+    // reports the deletion, so this is not a reason to give up watching
+    if (errno == ENOENT || errno == ENOTDIR) { return false; }
+
+    logger.get(logger_id::sync)->warn(
+      utility::formatter<errorcode::watch>::format(
+        errorcode::watch::watch_failed,
+        (root_ / relative_directory).string(), std::strerror(errno)
+    ));
+    active_ = false;
+    return false;
+  }
+
+  if (relative_directory.empty()) { root_watch_ = watch; }
+  watches_.insert_or_assign(watch, relative_directory);
+  return true;
+}
+
+auto path_watcher::add_watches(fs::path const& relative_directory) -> void {
+  auto const directory = root_ / relative_directory;
+  if (!relative_directory.empty() && prune_ && prune_(directory)) { return; }
+  if (!add_watch(relative_directory)) { return; }
+
+  std::error_code error_code{};
+
+  for (fs::recursive_directory_iterator iterator{
+         directory, fs::directory_options::skip_permission_denied, error_code
+       }, end{}; !error_code && iterator != end; iterator.increment(error_code)) {
+    if (!iterator->is_directory(error_code) || iterator->is_symlink(error_code)) { continue; }
+    if (prune_ && prune_(iterator->path())) {
+      iterator.disable_recursion_pending();
+      continue;
+    }
+    add_watch(relative_directory / iterator->path().lexically_relative(directory));
+    if (!active_) { return; }
+  }
+}
+
+auto path_watcher::remove_watches(fs::path const& relative_directory) -> void {
+  std::erase_if(watches_, [&](auto const& watch) {
+    if (!is_same_or_descendant(watch.second, relative_directory)) { return false; }
+    ::inotify_rm_watch(descriptor_, watch.first);
+    return true;
+  });
+}
+
+auto path_watcher::poll() -> poll_result {
+  poll_result result{};
+  if (!active_) {
+    result.overflow = true;
+    return result;
+  }
+
+  std::unordered_map<fs::path, bool> changes{};
+  auto const add_change = [&](fs::path const& path, bool subtree) {
+    auto [change, inserted] = changes.try_emplace(path, subtree);
+    if (!inserted) { change->second = change->second || subtree; }
+  };
+
+  alignas(inotify_event) char buffer[64 * 1024];
+
+  for (;;) {
+    auto const length = ::read(descriptor_, buffer, sizeof(buffer));
+    if (length == -1 && errno == EINTR) { continue; }
+    if (length <= 0) { break; }
+
+    for (auto const* cursor = buffer; cursor < buffer + length; ) {
+      auto const* event = reinterpret_cast<inotify_event const*>(cursor);
+      cursor += sizeof(inotify_event) + event->len;
+
+      if (event->mask & IN_Q_OVERFLOW) {
+        overflow_ = true;
+        continue;
+      }
+
+      auto const watch = watches_.find(event->wd);
+      if (watch == rng::end(watches_)) { continue; }
+
+      if (event->mask & (IN_IGNORED | IN_DELETE_SELF | IN_MOVE_SELF | IN_UNMOUNT)) {
+        if (event->wd == root_watch_) { overflow_ = true; }
+        if (event->mask & IN_IGNORED) { watches_.erase(watch); }
+        continue;
+      }
+
+      if (event->len == 0) { continue; }
+
+      auto const parent = watch->second;
+      auto const path = parent / fs::path{event->name};
+      bool const is_directory = (event->mask & IN_ISDIR) != 0;
+      bool const is_new_directory = is_directory && (event->mask & (IN_CREATE | IN_MOVED_TO));
+      bool const is_gone_directory = is_directory && (event->mask & (IN_DELETE | IN_MOVED_FROM));
+
+      if (is_gone_directory) { remove_watches(path); }
+      if (is_new_directory) { add_watches(path); }
+
+      // a directory that appears with content (e.g. moved in) or disappears
+      // with content (moved out) is re-evaluated as a whole subtree, because
+      // no events are reported for the entries inside it
+      add_change(path, is_new_directory || is_gone_directory);
+
+      // creating, removing or renaming an entry touches its directory
+      if (!parent.empty()) { add_change(parent, false); }
+    }
+  }
+
+  if (overflow_ || !active_) {
+    logger.warn<messagecode::watch, messagecode::watch::watch_overflow>(logger_id::sync, root_);
+
+    rng::for_each(watches_, [&](auto const& watch) {
+      ::inotify_rm_watch(descriptor_, watch.first);
+    });
+    watches_.clear();
+    root_watch_ = -1;
+    overflow_ = false;
+    active_ = true;
+    add_watches(fs::path{});
+
+    result.overflow = true;
+    return result;
+  }
+
+  result.changes.reserve(changes.size());
+  rng::for_each(changes, [&](auto& change) {
+    result.changes.push_back({change.first, change.second});
+  });
+
+  return result;
+}
+
+} // namespace dropclone
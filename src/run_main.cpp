@@ -22,7 +22,9 @@ namespace dc = dropclone;
 
 namespace {
 
-constexpr auto sync_interval_seconds{30};
+// longest single wait for the next due entry; bounds how long a
+// termination request may go unnoticed between sync cycles
+constexpr auto max_wait_seconds{5};
 std::atomic_bool running{true};
 
 auto get_config_path(int argc, char const *argv[]) -> fs::path {
@@ -47,11 +49,9 @@ auto get_config_path(int argc, char const *argv[]) -> fs::path {
 
 auto register_signal_handler() -> void {
    auto const signal_handler = [](int) -> void {
-    logger.get(logger_id::core)->info(
-      dc::utility::formatter<dc::messagecode::system>::format(
-        dc::messagecode::system::termination_requested_by_signal,
-        sync_interval_seconds
-      )
+    logger.info<dc::messagecode::system, dc::messagecode::system::termination_requested_by_signal>(
+      logger_id::core,
+      max_wait_seconds
     );
     running.store(false);
   };
@@ -72,19 +72,16 @@ auto register_signal_handler() -> void {
 }
 
 auto run_main(int argc, char const* argv[]) -> int {
-  logger.get(logger_id::core)->info(
-    dc::utility::formatter<dc::messagecode::system>::format(
-      dc::messagecode::system::application_starting
-  ));
+  logger.info<dc::messagecode::system, dc::messagecode::system::application_starting>(logger_id::core);
 
   try {
     register_signal_handler();
     auto const config_file = get_config_path(argc, argv);
     drop_clone clone{config_file, nlohmann_json_parser{}};
     while (running.load()) {
-      clone.sync();
-      std::this_thread::sleep_for(
-        std::chrono::seconds{sync_interval_seconds}
+      clone.sync_due();
+      clone.wait_until_due(
+        std::chrono::seconds{max_wait_seconds}
       );
     }
   } catch (dc::exception const& e) {
@@ -96,10 +93,7 @@ auto run_main(int argc, char const* argv[]) -> int {
     return EXIT_FAILURE;
   }
 
-  logger.get(logger_id::core)->info(
-    dc::utility::formatter<dc::messagecode::system>::format(
-      dc::messagecode::system::application_terminating
-  ));
+  logger.info<dc::messagecode::system, dc::messagecode::system::application_terminating>(logger_id::core);
 
   return EXIT_SUCCESS;
 }
\ No newline at end of file
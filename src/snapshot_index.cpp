@@ -0,0 +1,300 @@
+#include <dropclone/snapshot_index.hpp>
+#include <dropclone/path_snapshot.hpp>
+#include <dropclone/path_info.hpp>
+#include <dropclone/logger_manager.hpp>
+#include <dropclone/errorcode.hpp>
+#include <dropclone/messagecode.hpp>
+#include <dropclone/utility.hpp>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <cstring>
+#include <cstdint>
+#include <cerrno>
+#include <format>
+
+namespace dropclone {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr char index_magic[8]{'D', 'C', 'S', 'N', 'A', 'P', 'I', 'X'};
+
+struct index_header {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t reserved;
+  std::uint64_t entry_count;
+  std::uint64_t payload_size;
+  std::uint64_t checksum;
+};
+
+struct index_record {
+  std::int64_t last_write_time;
+  std::uint64_t file_size;
+  std::uint32_t file_perms;
+  std::uint8_t is_directory;
+  std::uint8_t reserved;
+  std::uint16_t path_length;
+};
+
+// 64-bit FNV-1a; order-dependent, so both the writer and the reader have to
+// feed the payload in the same sequence of calls.
+class checksum {
+ public:
+  auto update(void const* data, std::size_t size) noexcept -> void {
+    auto const* bytes = static_cast<unsigned char const*>(data);
+    for (std::size_t i{0}; i != size; ++i) {
+      value_ = (value_ ^ bytes[i]) * 0x100000001b3ULL;
+    }
+  }
+
+  auto value() const noexcept -> std::uint64_t { return value_; }
+
+ private:
+  std::uint64_t value_{0xcbf29ce484222325ULL};
+};
+
+class mapped_file {
+ public:
+  explicit mapped_file(fs::path const& path) {
+    descriptor_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (descriptor_ == -1) { return; }
+
+    struct stat file_status{};
+    if (::fstat(descriptor_, &file_status) == -1 || file_status.st_size == 0) { return; }
+
+    size_ = static_cast<std::size_t>(file_status.st_size);
+    auto* data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, descriptor_, 0);
+    if (data == MAP_FAILED) { size_ = 0; return; }
+
+    ::madvise(data, size_, MADV_SEQUENTIAL);
+    data_ = static_cast<char const*>(data);
+  }
+
+  mapped_file(mapped_file const&) = delete;
+  auto operator=(mapped_file const&) -> mapped_file& = delete;
+
+  ~mapped_file() {
+    if (data_ != nullptr) { ::munmap(const_cast<char*>(data_), size_); }
+    if (descriptor_ != -1) { ::close(descriptor_); }
+  }
+
+  auto data() const noexcept -> char const* { return data_; }
+  auto size() const noexcept -> std::size_t { return size_; }
+
+ private:
+  int descriptor_{-1};
+  char const* data_{nullptr};
+  std::size_t size_{0};
+};
+
+template <typename value_type>
+auto read_value(char const*& cursor) -> value_type {
+  value_type value{};
+  std::memcpy(&value, cursor, sizeof(value_type));
+  cursor += sizeof(value_type);
+  return value;
+}
+
+auto log_invalid_index(fs::path const& index_path, std::string_view reason) -> void {
+  logger.get(logger_id::sync)->warn(
+    utility::formatter<errorcode::index>::format(
+      errorcode::index::invalid_index,
+      index_path.string(), reason
+  ));
+}
+
+} // namespace
+
+snapshot_index::snapshot_index(fs::path index_path) : index_path_{std::move(index_path)} {}
+
+auto snapshot_index::index_path(fs::path const& index_directory,
+                                fs::path const& source_directory,
+                                fs::path const& destination_directory) -> fs::path {
+  checksum path_checksum{};
+  path_checksum.update(source_directory.native().data(), source_directory.native().size());
+  path_checksum.update("\0", 1);
+  path_checksum.update(destination_directory.native().data(), destination_directory.native().size());
+  return index_directory / std::format("{:016x}.idx", path_checksum.value());
+}
+
+auto snapshot_index::load(fs::path const& root) const -> std::optional<path_snapshot> {
+  std::error_code error_code{};
+  if (!fs::exists(index_path_, error_code)) { return std::nullopt; }
+
+  mapped_file index_file{index_path_};
+  if (index_file.data() == nullptr) {
+    logger.get(logger_id::sync)->warn(
+      utility::formatter<errorcode::index>::format(
+        errorcode::index::could_not_open_index,
+        index_path_.string(), std::strerror(errno)
+    ));
+    return std::nullopt;
+  }
+
+  if (index_file.size() < sizeof(index_header)) {
+    log_invalid_index(index_path_, "truncated header");
+    return std::nullopt;
+  }
+
+  auto const* cursor = index_file.data();
+  auto const header = read_value<index_header>(cursor);
+
+  if (std::memcmp(header.magic, index_magic, sizeof(index_magic)) != 0) {
+    log_invalid_index(index_path_, "bad magic");
+    return std::nullopt;
+  }
+
+  if (header.version != version) {
+    log_invalid_index(index_path_, std::format("version {} != {}", header.version, version));
+    return std::nullopt;
+  }
+
+  if (header.payload_size != index_file.size() - sizeof(index_header)) {
+    log_invalid_index(index_path_, "payload size mismatch");
+    return std::nullopt;
+  }
+
+  checksum payload_checksum{};
+  payload_checksum.update(cursor, header.payload_size);
+  if (payload_checksum.value() != header.checksum) {
+    log_invalid_index(index_path_, "checksum mismatch");
+    return std::nullopt;
+  }
+
+  auto const* const end = cursor + header.payload_size;
+  auto const has_bytes = [&](std::size_t size) {
+    return static_cast<std::size_t>(end - cursor) >= size;
+  };
+
+  if (!has_bytes(sizeof(std::uint32_t))) {
+    log_invalid_index(index_path_, "truncated root");
+    return std::nullopt;
+  }
+
+  auto const root_length = read_value<std::uint32_t>(cursor);
+  if (!has_bytes(root_length)) {
+    log_invalid_index(index_path_, "truncated root");
+    return std::nullopt;
+  }
+
+  std::string_view const indexed_root{cursor, root_length};
+  cursor += root_length;
+
+  if (indexed_root != root.native()) {
+    logger.get(logger_id::sync)->warn(
+      utility::formatter<errorcode::index>::format(
+        errorcode::index::stale_index,
+        index_path_.string(), indexed_root
+    ));
+    return std::nullopt;
+  }
+
+  path_snapshot::entry_list entries{};
+  entries.reserve(header.entry_count);
+
+  for (std::uint64_t entry{0}; entry != header.entry_count; ++entry) {
+    if (!has_bytes(sizeof(index_record))) {
+      log_invalid_index(index_path_, "truncated entry");
+      return std::nullopt;
+    }
+
+    auto const record = read_value<index_record>(cursor);
+    if (!has_bytes(record.path_length)) {
+      log_invalid_index(index_path_, "truncated entry");
+      return std::nullopt;
+    }
+
+    path_info info{};
+    info.last_write_time = fs::file_time_type{fs::file_time_type::duration{record.last_write_time}};
+    info.file_size = record.file_size;
+    info.file_perms = static_cast<fs::perms>(record.file_perms);
+    info.is_directory = record.is_directory != 0;
+
+    entries.emplace_back(fs::path{std::string_view{cursor, record.path_length}}, info);
+    cursor += record.path_length;
+  }
+
+  logger.info<messagecode::index, messagecode::index::index_loaded>(
+    logger_id::sync,
+    index_path_, entries.size()
+  );
+
+  return path_snapshot{root, std::move(entries)};
+}
+
+auto snapshot_index::store(path_snapshot const& snapshot) const -> bool {
+  auto temporary_path = index_path_;
+  temporary_path += ".tmp";
+
+  try {
+    std::ofstream index_stream{temporary_path, std::ios::binary | std::ios::trunc};
+    if (!index_stream.is_open()) {
+      throw std::system_error{errno, std::generic_category(), temporary_path.string()};
+    }
+    index_stream.exceptions(std::ios::failbit | std::ios::badbit);
+
+    index_header header{};
+    std::memcpy(header.magic, index_magic, sizeof(index_magic));
+    header.version = version;
+    index_stream.write(reinterpret_cast<char const*>(&header), sizeof(header));
+
+    checksum payload_checksum{};
+    auto const write = [&](void const* data, std::size_t size) {
+      payload_checksum.update(data, size);
+      index_stream.write(static_cast<char const*>(data), static_cast<std::streamsize>(size));
+      header.payload_size += size;
+    };
+
+    auto const root = snapshot.root();
+    auto const root_length = static_cast<std::uint32_t>(root.native().size());
+    write(&root_length, sizeof(root_length));
+    write(root.native().data(), root.native().size());
+
+    for (auto const& [path, info] : snapshot.entries()) {
+      auto const& native_path = path.native();
+      if (native_path.size() > UINT16_MAX) { continue; }
+
+      index_record record{};
+      record.last_write_time = info.last_write_time.time_since_epoch().count();
+      record.file_size = info.file_size;
+      record.file_perms = static_cast<std::uint32_t>(info.file_perms);
+      record.is_directory = info.is_directory ? 1 : 0;
+      record.path_length = static_cast<std::uint16_t>(native_path.size());
+
+      write(&record, sizeof(record));
+      write(native_path.data(), native_path.size());
+      ++header.entry_count;
+    }
+
+    header.checksum = payload_checksum.value();
+    index_stream.seekp(0);
+    index_stream.write(reinterpret_cast<char const*>(&header), sizeof(header));
+    index_stream.close();
+
+    fs::rename(temporary_path, index_path_);
+  } catch (std::exception const& e) {
+    logger.get(logger_id::sync)->warn(
+      utility::formatter<errorcode::index>::format(
+        errorcode::index::could_not_write_index,
+        index_path_.string(), e.what()
+    ));
+
+    std::error_code error_code{};
+    fs::remove(temporary_path, error_code);
+    return false;
+  }
+
+  return true;
+}
+
+} // namespace dropclone
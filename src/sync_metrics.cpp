@@ -0,0 +1,202 @@
+#include <dropclone/sync_metrics.hpp>
+#include <filesystem>
+#include <fstream>
+#include <format>
+#include <string>
+#include <string_view>
+#include <atomic>
+#include <chrono>
+#include <utility>
+#include <system_error>
+#include <algorithm>
+#include <cstdint>
+
+namespace dropclone {
+
+namespace fs = std::filesystem;
+namespace chr = std::chrono;
+namespace rng = std::ranges;
+
+namespace {
+
+using histogram = sync_metrics::histogram;
+using counter = sync_metrics::counter;
+
+struct histogram_label {
+  std::string_view phase;
+  std::string_view command;
+};
+
+// indexed by sync_metrics::histogram; commit_lag is exported on its own
+constexpr std::array<histogram_label, sync_metrics::histogram_count> histogram_labels{{
+  {"sync", ""}, {"scan", ""}, {"hash", ""}, {"diff", ""},
+  {"execute", "copy_command"}, {"execute", "rename_command"}, {"execute", "remove_command"},
+  {"execute", "delta_command"}, {"execute", "update_command"},
+  {"undo", "copy_command"}, {"undo", "rename_command"}, {"undo", "remove_command"},
+  {"undo", "delta_command"}, {"undo", "update_command"},
+  {"rollback", ""}, {"fsync", ""}, {"commit_lag", ""}
+}};
+
+struct counter_family {
+  std::string_view name;
+  std::string_view help;
+};
+
+// indexed by sync_metrics::counter
+constexpr std::array<counter_family, sync_metrics::counter_count> counter_families{{
+  {"dropclone_syncs_total", "Sync cycles run"},
+  {"dropclone_sync_failures_total", "Sync cycles that failed"},
+  {"dropclone_files_copied_total", "Files copied to the destination"},
+  {"dropclone_bytes_copied_total", "Bytes copied to the destination"},
+  {"dropclone_rollbacks_total", "Transactions rolled back"}
+}};
+
+auto next_thread_index() noexcept -> std::size_t {
+  static std::atomic<std::size_t> next_index{0};
+  thread_local std::size_t const index{next_index.fetch_add(1, std::memory_order_relaxed)};
+  return index;
+}
+
+auto escape_label(std::string_view value) -> std::string {
+  std::string escaped{};
+  escaped.reserve(value.size());
+  for (auto const character : value) {
+    if (character == '\\') { escaped += "\\\\"; }
+    else if (character == '"') { escaped += "\\\""; }
+    else if (character == '\n') { escaped += "\\n"; }
+    else { escaped += character; }
+  }
+  return escaped;
+}
+
+auto seconds(chr::nanoseconds duration) -> double {
+  return chr::duration<double>{duration}.count();
+}
+
+auto write_histogram(std::string& out, std::string_view name, std::string const& labels,
+                     sync_metrics::histogram_values const& values) -> void {
+  std::uint64_t cumulative{0};
+  for (std::size_t bucket{0}; bucket != sync_metrics::bucket_bounds.size(); ++bucket) {
+    cumulative += values.buckets[bucket];
+    out += std::format("{}_bucket{{{},le=\"{}\"}} {}\n",
+      name, labels, seconds(sync_metrics::bucket_bounds[bucket]), cumulative);
+  }
+  out += std::format("{}_bucket{{{},le=\"+Inf\"}} {}\n", name, labels, values.count);
+  out += std::format("{}_sum{{{}}} {}\n", name, labels, seconds(values.sum));
+  out += std::format("{}_count{{{}}} {}\n", name, labels, values.count);
+}
+
+} // namespace
+
+sync_metrics::scoped_timer::scoped_timer(sync_metrics* metrics, histogram target) noexcept
+  : metrics_{metrics}, target_{target},
+    started_{metrics != nullptr ? chr::steady_clock::now() : chr::steady_clock::time_point{}}
+{}
+
+sync_metrics::scoped_timer::~scoped_timer() {
+  if (metrics_ != nullptr) { metrics_->observe(target_, chr::steady_clock::now() - started_); }
+}
+
+sync_metrics::sync_metrics() : shards_{std::make_unique<std::array<shard, shard_count>>()} {}
+
+auto sync_metrics::local_shard() noexcept -> shard& {
+  return (*shards_)[next_thread_index() % shard_count];
+}
+
+auto sync_metrics::add(counter target, std::uint64_t value) noexcept -> void {
+  local_shard().counters[static_cast<std::size_t>(target)].fetch_add(value, std::memory_order_relaxed);
+}
+
+auto sync_metrics::observe(histogram target, chr::nanoseconds duration) noexcept -> void {
+  auto const bucket = static_cast<std::size_t>(
+    rng::lower_bound(bucket_bounds, duration) - rng::begin(bucket_bounds));
+
+  auto& histogram = local_shard().histograms[static_cast<std::size_t>(target)];
+  histogram.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+  histogram.sum.fetch_add(duration.count(), std::memory_order_relaxed);
+}
+
+auto sync_metrics::snapshot() const noexcept -> values {
+  values result{};
+  for (auto const& shard : *shards_) {
+    for (std::size_t index{0}; index != counter_count; ++index) {
+      result.counters[index] += shard.counters[index].load(std::memory_order_relaxed);
+    }
+    for (std::size_t index{0}; index != histogram_count; ++index) {
+      auto& histogram = result.histograms[index];
+      for (std::size_t bucket{0}; bucket != bucket_count; ++bucket) {
+        auto const count = shard.histograms[index].buckets[bucket].load(std::memory_order_relaxed);
+        histogram.buckets[bucket] += count;
+        histogram.count += count;
+      }
+      histogram.sum += chr::nanoseconds{shard.histograms[index].sum.load(std::memory_order_relaxed)};
+    }
+  }
+  return result;
+}
+
+auto sync_metrics::command_histogram(std::string_view command_name, bool undo) noexcept -> histogram {
+  constexpr std::array<std::pair<std::string_view, histogram>, 5> commands{{
+    {"copy_command", histogram::copy_execute}, {"rename_command", histogram::rename_execute},
+    {"remove_command", histogram::remove_execute}, {"delta_command", histogram::delta_execute},
+    {"update_command", histogram::update_execute}
+  }};
+  constexpr auto undo_offset = static_cast<std::size_t>(histogram::copy_undo) -
+                               static_cast<std::size_t>(histogram::copy_execute);
+
+  auto const found = rng::find(commands, command_name, &std::pair<std::string_view, histogram>::first);
+  auto const execute = found != rng::end(commands) ? found->second : histogram::copy_execute;
+  return undo ? static_cast<histogram>(static_cast<std::size_t>(execute) + undo_offset) : execute;
+}
+
+auto export_metrics(fs::path const& path, std::vector<entry_metrics> const& entries) -> void {
+  std::vector<std::pair<std::string, sync_metrics::values>> snapshots{};
+  snapshots.reserve(entries.size());
+  rng::for_each(entries, [&](auto const& entry) {
+    snapshots.emplace_back(std::format("entry=\"{}\"", escape_label(entry.entry)), entry.metrics->snapshot());
+  });
+
+  std::string out{};
+
+  for (std::size_t index{0}; index != sync_metrics::counter_count; ++index) {
+    auto const& family = counter_families[index];
+    out += std::format("# HELP {} {}\n# TYPE {} counter\n", family.name, family.help, family.name);
+    rng::for_each(snapshots, [&](auto const& snapshot) {
+      out += std::format("{}{{{}}} {}\n", family.name, snapshot.first, snapshot.second.counters[index]);
+    });
+  }
+
+  constexpr std::string_view phase_name{"dropclone_phase_duration_seconds"};
+  out += std::format("# HELP {} Time spent per sync phase\n# TYPE {} histogram\n", phase_name, phase_name);
+  rng::for_each(snapshots, [&](auto const& snapshot) {
+    for (std::size_t index{0}; index != sync_metrics::histogram_count; ++index) {
+      if (static_cast<histogram>(index) == histogram::commit_lag) { continue; }
+
+      auto const& label = histogram_labels[index];
+      auto labels = std::format("{},phase=\"{}\"", snapshot.first, label.phase);
+      if (!label.command.empty()) { labels += std::format(",command=\"{}\"", label.command); }
+      write_histogram(out, phase_name, labels, snapshot.second.histograms[index]);
+    }
+  });
+
+  constexpr std::string_view lag_name{"dropclone_commit_lag_seconds"};
+  out += std::format("# HELP {} Time from a source file change to its commit in the destination\n"
+                     "# TYPE {} histogram\n", lag_name, lag_name);
+  rng::for_each(snapshots, [&](auto const& snapshot) {
+    write_histogram(out, lag_name, snapshot.first,
+                    snapshot.second.histograms[static_cast<std::size_t>(histogram::commit_lag)]);
+  });
+
+  auto temporary = path;
+  temporary += ".tmp";
+  {
+    std::ofstream file{temporary, std::ios::trunc};
+    file << out;
+    if (!file.flush()) {
+      throw fs::filesystem_error{"export_metrics", temporary, std::make_error_code(std::errc::io_error)};
+    }
+  }
+  fs::rename(temporary, path);
+}
+
+} // namespace dropclone
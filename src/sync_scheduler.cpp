@@ -0,0 +1,78 @@
+#include <dropclone/sync_scheduler.hpp>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace dropclone {
+
+namespace chr = std::chrono;
+namespace rng = std::ranges;
+
+// largest share by which an interval is stretched or shortened
+constexpr double interval_jitter{0.1};
+// the first cycles are spread over at most this long, so no entry waits
+// a whole long interval for its first sync
+constexpr chr::milliseconds startup_jitter{chr::seconds{5}};
+
+sync_scheduler::sync_scheduler(std::vector<config_entry> const& entries, clock::time_point now)
+  : sync_scheduler{entries, now, std::random_device{}()}
+{}
+
+sync_scheduler::sync_scheduler(std::vector<config_entry> const& entries, clock::time_point now,
+                               std::uint64_t seed)
+  : random_{seed}
+{
+  schedules_.reserve(entries.size());
+  rng::for_each(entries, [&](auto const& entry) {
+    auto const window = std::min(entry.sync_interval, startup_jitter);
+    std::uniform_int_distribution<chr::milliseconds::rep> offset{0, window.count() - 1};
+    schedules_.push_back({
+      entry.sync_interval,
+      std::max(entry.max_sync_interval, entry.sync_interval),
+      entry.sync_interval,
+      entry.interval_mode,
+      now + chr::milliseconds{offset(random_)}
+    });
+  });
+}
+
+auto sync_scheduler::due(clock::time_point now) const -> std::vector<std::size_t> {
+  std::vector<std::size_t> indices{};
+  for (std::size_t index{0}; index != schedules_.size(); ++index) {
+    if (schedules_[index].next <= now) { indices.push_back(index); }
+  }
+  return indices;
+}
+
+auto sync_scheduler::next_due() const noexcept -> clock::time_point {
+  if (schedules_.empty()) { return clock::time_point::max(); }
+  return rng::min(schedules_, {}, &schedule::next).next;
+}
+
+auto sync_scheduler::completed(std::size_t index, bool changed, clock::time_point now) -> void {
+  auto& schedule = schedules_[index];
+
+  if (schedule.mode == interval_mode::adaptive) {
+    schedule.interval = changed ? schedule.base_interval
+                                : std::min(schedule.interval * 2, schedule.max_interval);
+  }
+  schedule.next = now + jittered(schedule.interval);
+}
+
+auto sync_scheduler::trigger(std::size_t index, clock::time_point now) noexcept -> void {
+  schedules_[index].next = std::min(schedules_[index].next, now);
+}
+
+auto sync_scheduler::interval(std::size_t index) const noexcept -> chr::milliseconds {
+  return schedules_[index].interval;
+}
+
+auto sync_scheduler::jittered(chr::milliseconds interval) -> chr::milliseconds {
+  std::uniform_real_distribution<double> factor{1.0 - interval_jitter, 1.0 + interval_jitter};
+  return std::max(chr::milliseconds{1}, chr::duration_cast<chr::milliseconds>(interval * factor(random_)));
+}
+
+} // namespace dropclone
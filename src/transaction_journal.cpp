@@ -0,0 +1,225 @@
+#include <dropclone/transaction_journal.hpp>
+#include <fcntl.h>
+#include <unistd.h>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <system_error>
+#include <mutex>
+#include <cstring>
+#include <cstdint>
+#include <cerrno>
+
+namespace dropclone {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr char journal_magic[8]{'D', 'C', 'J', 'O', 'U', 'R', 'N', '1'};
+
+struct journal_record {
+  std::uint8_t state;
+  std::uint8_t kind;
+  std::uint16_t reserved;
+  std::uint32_t file_perms;
+  std::uint32_t source_length;
+  std::uint32_t destination_length;
+  std::int64_t last_write_time;
+  std::uint64_t file_size;
+  std::uint64_t checksum; // over the record with checksum 0, then both paths
+};
+
+// 64-bit FNV-1a
+auto fnv1a(std::string_view data, std::uint64_t value = 0xcbf29ce484222325ULL) noexcept -> std::uint64_t {
+  for (auto const byte : data) {
+    value = (value ^ static_cast<unsigned char>(byte)) * 0x100000001b3ULL;
+  }
+  return value;
+}
+
+auto record_checksum(journal_record record, std::string_view source,
+                     std::string_view destination) noexcept -> std::uint64_t {
+  record.checksum = 0;
+  auto value = fnv1a({reinterpret_cast<char const*>(&record), sizeof(record)});
+  value = fnv1a(source, value);
+  return fnv1a(destination, value);
+}
+
+[[noreturn]] auto fail(fs::path const& path, int error) -> void {
+  throw fs::filesystem_error{"transaction_journal", path, std::error_code{error, std::generic_category()}};
+}
+
+auto write_all(int descriptor, std::string_view data, fs::path const& path) -> void {
+  while (!data.empty()) {
+    auto const written = ::write(descriptor, data.data(), data.size());
+    if (written == -1 && errno == EINTR) { continue; }
+    if (written == -1) { fail(path, errno); }
+    data.remove_prefix(static_cast<std::size_t>(written));
+  }
+}
+
+} // namespace
+
+transaction_journal::transaction_journal(fs::path path) : path_{std::move(path)} {}
+
+transaction_journal::~transaction_journal() {
+  if (descriptor_ != -1) { ::close(descriptor_); }
+}
+
+auto transaction_journal::open() -> void {
+  if (descriptor_ != -1) { return; }
+
+  descriptor_ = ::open(path_.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+  if (descriptor_ == -1) { fail(path_, errno); }
+
+  auto const size = ::lseek(descriptor_, 0, SEEK_END);
+  if (size == -1) { fail(path_, errno); }
+  size_ = static_cast<std::uint64_t>(size);
+}
+
+auto transaction_journal::append(record_state state, operation kind, fs::path const& source,
+                                 fs::path const& destination, path_info const& info) -> void {
+  std::string_view const source_path{source.native()};
+  std::string_view const destination_path{destination.native()};
+
+  journal_record record{};
+  record.state = static_cast<std::uint8_t>(state);
+  record.kind = static_cast<std::uint8_t>(kind);
+  record.file_perms = static_cast<std::uint32_t>(info.file_perms);
+  record.source_length = static_cast<std::uint32_t>(source_path.size());
+  record.destination_length = static_cast<std::uint32_t>(destination_path.size());
+  record.last_write_time = info.last_write_time.time_since_epoch().count();
+  record.file_size = info.file_size;
+  record.checksum = record_checksum(record, source_path, destination_path);
+
+  std::string buffer{};
+  buffer.reserve(sizeof(journal_magic) + sizeof(record) + source_path.size() + destination_path.size());
+
+  std::lock_guard<std::mutex> journal_guard{mutex_};
+  open();
+
+  if (size_ == 0) { buffer.append(journal_magic, sizeof(journal_magic)); }
+  buffer.append(reinterpret_cast<char const*>(&record), sizeof(record));
+  buffer.append(source_path);
+  buffer.append(destination_path);
+
+  write_all(descriptor_, buffer, path_);
+  size_ += buffer.size();
+}
+
+auto transaction_journal::begin(operation kind, fs::path const& source,
+                                fs::path const& destination, path_info const& info) -> void {
+  append(record_state::begun, kind, source, destination, info);
+}
+
+auto transaction_journal::done(operation kind, fs::path const& source,
+                               fs::path const& destination) -> void {
+  append(record_state::done, kind, source, destination, {});
+}
+
+auto transaction_journal::abandon(operation kind, fs::path const& source,
+                                  fs::path const& destination) -> void {
+  append(record_state::abandoned, kind, source, destination, {});
+}
+
+auto transaction_journal::sync() -> void {
+  int descriptor{-1};
+  {
+    std::lock_guard<std::mutex> journal_guard{mutex_};
+    if (descriptor_ == -1) { return; }
+    descriptor = descriptor_;
+  }
+
+  // outside the lock, so steps keep being appended while the device flushes
+  while (::fdatasync(descriptor) == -1) {
+    if (errno != EINTR) { fail(path_, errno); }
+  }
+}
+
+auto transaction_journal::mark() -> std::uint64_t {
+  std::lock_guard<std::mutex> journal_guard{mutex_};
+  open();
+  return size_;
+}
+
+auto transaction_journal::truncate(std::uint64_t mark) -> void {
+  std::lock_guard<std::mutex> journal_guard{mutex_};
+  open();
+  if (mark >= size_) { return; }
+
+  // a journal holding nothing but its magic counts as empty
+  if (mark <= sizeof(journal_magic)) { mark = 0; }
+  if (::ftruncate(descriptor_, static_cast<off_t>(mark)) == -1) { fail(path_, errno); }
+  size_ = mark;
+}
+
+auto transaction_journal::reset() -> void { truncate(0); }
+
+auto transaction_journal::replay() const -> std::vector<step> {
+  std::ifstream journal_stream{path_, std::ios::binary};
+  if (!journal_stream.is_open()) { return {}; }
+
+  std::string const content{std::istreambuf_iterator<char>{journal_stream}, std::istreambuf_iterator<char>{}};
+  std::string_view data{content};
+  if (!data.starts_with(std::string_view{journal_magic, sizeof(journal_magic)})) { return {}; }
+  data.remove_prefix(sizeof(journal_magic));
+
+  std::vector<step> steps{};
+  std::vector<bool> abandoned{};
+  std::unordered_map<std::string, std::size_t> pending{};
+
+  while (data.size() >= sizeof(journal_record)) {
+    journal_record record{};
+    std::memcpy(&record, data.data(), sizeof(record));
+
+    auto const paths_length = std::uint64_t{record.source_length} + record.destination_length;
+    if (data.size() - sizeof(record) < paths_length) { break; }
+
+    auto const source_path = data.substr(sizeof(record), record.source_length);
+    auto const destination_path = data.substr(sizeof(record) + record.source_length, record.destination_length);
+    if (record_checksum(record, source_path, destination_path) != record.checksum) { break; }
+    data.remove_prefix(sizeof(record) + paths_length);
+
+    auto key = std::string{source_path};
+    key.push_back('\0');
+    key.append(destination_path);
+    key.push_back(static_cast<char>(record.kind));
+
+    if (record.state != static_cast<std::uint8_t>(record_state::begun)) {
+      if (auto const found = pending.find(key); found != std::end(pending)) {
+        if (record.state == static_cast<std::uint8_t>(record_state::done)) {
+          steps[found->second].done = true;
+        } else {
+          abandoned[found->second] = true;
+        }
+        pending.erase(found);
+      }
+      continue;
+    }
+
+    step next{};
+    next.kind = static_cast<operation>(record.kind);
+    next.source = fs::path{source_path};
+    next.destination = fs::path{destination_path};
+    next.info.last_write_time = fs::file_time_type{fs::file_time_type::duration{record.last_write_time}};
+    next.info.file_size = record.file_size;
+    next.info.file_perms = static_cast<fs::perms>(record.file_perms);
+
+    pending.insert_or_assign(std::move(key), steps.size());
+    steps.push_back(std::move(next));
+    abandoned.push_back(false);
+  }
+
+  std::vector<step> replayed{};
+  replayed.reserve(steps.size());
+  for (std::size_t index{0}; index != steps.size(); ++index) {
+    if (!abandoned[index]) { replayed.push_back(std::move(steps[index])); }
+  }
+  return replayed;
+}
+
+} // namespace dropclone
@@ -0,0 +1,243 @@
+#include <dropclone/trash_purger.hpp>
+#include <dropclone/worker_pool.hpp>
+#include <dropclone/logger_manager.hpp>
+#include <dropclone/utility.hpp>
+#include <dropclone/errorcode.hpp>
+#include <dropclone/messagecode.hpp>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <filesystem>
+#include <system_error>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <exception>
+#include <utility>
+#include <algorithm>
+#include <cerrno>
+
+namespace dropclone {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr int lowest_priority{19};
+constexpr int ioprio_who_process{1};
+constexpr int ioprio_class_idle{3};
+constexpr int ioprio_class_shift{13};
+
+struct directory_entry {
+  std::string name{};
+  bool is_directory{false};
+};
+
+[[noreturn]] auto fail(fs::path const& path, int error) -> void {
+  throw fs::filesystem_error{"purge_trash", path, std::error_code{error, std::generic_category()}};
+}
+
+// lists a directory before anything in it is unlinked, so removing entries
+// never races with readdir
+auto list_directory(int directory_fd, fs::path const& path) -> std::vector<directory_entry> {
+  auto const list_fd = ::dup(directory_fd);
+  if (list_fd == -1) { fail(path, errno); }
+
+  auto* const directory = ::fdopendir(list_fd);
+  if (directory == nullptr) {
+    auto const error = errno;
+    ::close(list_fd);
+    fail(path, error);
+  }
+  ::rewinddir(directory);
+
+  std::vector<directory_entry> entries{};
+  while (auto const* entry = ::readdir(directory)) {
+    std::string_view const name{entry->d_name};
+    if (name == "." || name == "..") { continue; }
+    entries.push_back({std::string{name}, entry->d_type == DT_DIR});
+  }
+  ::closedir(directory);
+
+  return entries;
+}
+
+auto open_directory(int parent_fd, char const* name, fs::path const& path) -> int {
+  auto const directory_fd = ::openat(parent_fd, name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+  if (directory_fd == -1) { fail(path, errno); }
+  return directory_fd;
+}
+
+auto unlink_entry(int parent_fd, directory_entry const& entry, fs::path const& parent_path) -> std::size_t;
+
+// unlinks everything below the open directory 'directory_fd'
+auto unlink_children(int directory_fd, fs::path const& path) -> std::size_t {
+  std::size_t removed{0};
+  for (auto const& entry : list_directory(directory_fd, path)) {
+    removed += unlink_entry(directory_fd, entry, path);
+  }
+  return removed;
+}
+
+auto unlink_entry(int parent_fd, directory_entry const& entry, fs::path const& parent_path) -> std::size_t {
+  auto const name = entry.name.c_str();
+
+  // d_type may be DT_UNKNOWN; unlinking a directory then fails with EISDIR
+  if (!entry.is_directory) {
+    if (::unlinkat(parent_fd, name, 0) == 0) { return 1; }
+    if (errno == ENOENT) { return 0; }
+    if (errno != EISDIR && errno != EPERM) { fail(parent_path / entry.name, errno); }
+  }
+
+  auto const directory_fd = open_directory(parent_fd, name, parent_path / entry.name);
+  std::size_t removed{0};
+  try {
+    removed = unlink_children(directory_fd, parent_path / entry.name);
+  } catch (...) {
+    ::close(directory_fd);
+    throw;
+  }
+  ::close(directory_fd);
+
+  if (::unlinkat(parent_fd, name, AT_REMOVEDIR) == -1 && errno != ENOENT) {
+    fail(parent_path / entry.name, errno);
+  }
+  return removed + 1;
+}
+
+// drops the calling thread – and the threads it starts – to the lowest CPU
+// priority and the idle I/O class; on Linux both apply per thread
+auto lower_priority() -> void {
+  ::setpriority(PRIO_PROCESS, 0, lowest_priority);
+  ::syscall(SYS_ioprio_set, ioprio_who_process, 0, ioprio_class_idle << ioprio_class_shift);
+}
+
+} // namespace
+
+trash_purger::trash_purger(std::size_t workers) : workers_{std::max<std::size_t>(workers, 1)} {}
+
+trash_purger::~trash_purger() {
+  if (thread_.joinable()) {
+    thread_.request_stop();
+    thread_.join();
+  }
+}
+
+auto trash_purger::trash_root(fs::path const& root) -> fs::path {
+  return root / fs::path{directory_name};
+}
+
+auto trash_purger::purge(fs::path trash, fs::path root) -> void {
+  {
+    std::lock_guard<std::mutex> purger_guard{mutex_};
+    jobs_.push_back({std::move(trash), std::move(root)});
+    if (!thread_.joinable()) {
+      thread_ = std::jthread{[this](std::stop_token stop_token) { run(stop_token); }};
+    }
+  }
+  job_available_.notify_one();
+}
+
+auto trash_purger::wait() -> void {
+  std::unique_lock<std::mutex> purger_guard{mutex_};
+  idle_.wait(purger_guard, [&] { return jobs_.empty() && !busy_; });
+}
+
+auto trash_purger::run(std::stop_token stop_token) -> void {
+  lower_priority();
+
+  while (true) {
+    job next{};
+    {
+      std::unique_lock<std::mutex> purger_guard{mutex_};
+      job_available_.wait(purger_guard, stop_token, [&] { return !jobs_.empty(); });
+      // pending trash is purged even after a stop was requested
+      if (jobs_.empty()) { return; }
+      next = std::move(jobs_.front());
+      jobs_.pop_front();
+      busy_ = true;
+    }
+
+    try {
+      auto const removed = purge_now(next.trash, workers_);
+      remove_empty(next.trash, next.root);
+
+      logger.info<messagecode::command, messagecode::command::trash_purged>(
+        logger_id::sync,
+        next.trash, removed
+      );
+    } catch (fs::filesystem_error const& err) {
+      logger.get(logger_id::sync)->error(
+        utility::formatter<errorcode::command>::format(
+          errorcode::command::trash_purge_failed,
+          next.trash.string(), err.what()
+      ));
+    }
+
+    {
+      std::lock_guard<std::mutex> purger_guard{mutex_};
+      busy_ = false;
+    }
+    idle_.notify_all();
+  }
+}
+
+auto trash_purger::purge_now(fs::path const& directory, std::size_t workers) -> std::size_t {
+  auto const directory_fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+  if (directory_fd == -1) {
+    if (errno == ENOENT) { return 0; }
+    fail(directory, errno);
+  }
+
+  std::atomic<std::size_t> removed{0};
+  std::exception_ptr failure{};
+  std::mutex failure_mutex{};
+
+  try {
+    auto const entries = list_directory(directory_fd, directory);
+
+    // the top-level entries are independent subtrees, one task each
+    worker_pool pool{std::min(workers, std::max<std::size_t>(entries.size(), 1))};
+    for (auto const& entry : entries) {
+      pool.submit([&] {
+        try {
+          removed.fetch_add(unlink_entry(directory_fd, entry, directory), std::memory_order_relaxed);
+        } catch (...) {
+          std::lock_guard<std::mutex> failure_guard{failure_mutex};
+          if (!failure) { failure = std::current_exception(); }
+        }
+      });
+    }
+    pool.wait();
+  } catch (...) {
+    ::close(directory_fd);
+    throw;
+  }
+  ::close(directory_fd);
+
+  if (failure) { std::rethrow_exception(failure); }
+
+  if (::rmdir(directory.c_str()) == -1 && errno != ENOENT) { fail(directory, errno); }
+  return removed.load() + 1;
+}
+
+// a removed source or destination root is dropped entirely once nothing but
+// its trash was left in it
+auto trash_purger::remove_empty(fs::path const& trash, fs::path const& root) -> void {
+  std::error_code error_code{};
+  auto const trash_parent = trash.parent_path();
+  if (trash_parent.filename() == directory_name && fs::is_empty(trash_parent, error_code)) {
+    fs::remove(trash_parent, error_code);
+  }
+
+  if (!root.empty() && fs::is_directory(root, error_code) && fs::is_empty(root, error_code)) {
+    logger.info<messagecode::command, messagecode::command::remove_directory>(logger_id::sync, root);
+
+    fs::remove(root, error_code);
+  }
+}
+
+} // namespace dropclone
@@ -0,0 +1,66 @@
+#include <dropclone/worker_pool.hpp>
+#include <algorithm>
+#include <utility>
+#include <mutex>
+#include <stop_token>
+
+namespace dropclone {
+
+worker_pool::worker_pool(std::size_t thread_count, std::size_t queue_capacity) 
+  : queue_capacity_{queue_capacity} 
+{
+  thread_count = std::max<std::size_t>(thread_count, 1);
+  workers_.reserve(thread_count);
+  for (std::size_t worker{0}; worker != thread_count; ++worker) {
+    workers_.emplace_back([this](std::stop_token stop_token) { work(stop_token); });
+  }
+}
+
+worker_pool::~worker_pool() {
+  // request_stop wakes the workers through the stop_token aware wait;
+  // queued tasks that did not start yet are dropped
+  for (auto& worker : workers_) { worker.request_stop(); }
+  workers_.clear();
+}
+
+auto worker_pool::submit(task work) -> void {
+  {
+    std::unique_lock<std::mutex> pool_guard{mutex_};
+    space_available_.wait(pool_guard, [&] { 
+      return queue_capacity_ == 0 || tasks_.size() < queue_capacity_; 
+    });
+    tasks_.push_back(std::move(work));
+  }
+  task_available_.notify_one();
+}
+
+auto worker_pool::wait() -> void {
+  std::unique_lock<std::mutex> pool_guard{mutex_};
+  idle_.wait(pool_guard, [&] { return tasks_.empty() && running_ == 0; });
+}
+
+auto worker_pool::work(std::stop_token stop_token) -> void {
+  for (;;) {
+    task next_task{};
+    {
+      std::unique_lock<std::mutex> pool_guard{mutex_};
+      if (!task_available_.wait(pool_guard, stop_token, [&] { return !tasks_.empty(); })) { 
+        return; 
+      }
+      next_task = std::move(tasks_.front());
+      tasks_.pop_front();
+      ++running_;
+    }
+    space_available_.notify_one();
+
+    next_task();
+
+    {
+      std::lock_guard<std::mutex> pool_guard{mutex_};
+      --running_;
+      if (tasks_.empty() && running_ == 0) { idle_.notify_all(); }
+    }
+  }
+}
+
+} // namespace dropclone
@@ -60,6 +60,60 @@ TEST_CASE("sanitize throws if mode is undefined", "[clone_config][config_entry]"
   REQUIRE_THROWS_AS(entry.sanitize(), dc::exception);
 }
 
+TEST_CASE("sanitize throws if update_mode is undefined", "[clone_config][config_entry]") { 
+  dc::config_entry entry{
+    fs::path{"/dropclone/test/"},
+    fs::path{"/dropclone/test/"},
+    dc::clone_mode::copy
+  };
+  entry.update_mode = dc::update_mode::undefined;
+  REQUIRE_THROWS_AS(entry.sanitize(), dc::exception);
+}
+
+TEST_CASE("sanitize throws if compare is undefined", "[clone_config][config_entry]") { 
+  dc::config_entry entry{
+    fs::path{"/dropclone/test/"},
+    fs::path{"/dropclone/test/"},
+    dc::clone_mode::copy
+  };
+  entry.compare = dc::compare_strategy::undefined;
+  REQUIRE_THROWS_AS(entry.sanitize(), dc::exception);
+}
+
+TEST_CASE("sanitize throws if durability is undefined", "[clone_config][config_entry]") { 
+  dc::config_entry entry{
+    fs::path{"/dropclone/test/"},
+    fs::path{"/dropclone/test/"},
+    dc::clone_mode::copy
+  };
+  entry.durability = dc::durability_mode::undefined;
+  REQUIRE_THROWS_AS(entry.sanitize(), dc::exception);
+}
+
+TEST_CASE("sanitize throws if interval_mode is undefined", "[clone_config][config_entry]") { 
+  dc::config_entry entry{
+    fs::path{"/dropclone/test/"},
+    fs::path{"/dropclone/test/"},
+    dc::clone_mode::copy
+  };
+  entry.interval_mode = dc::interval_mode::undefined;
+  REQUIRE_THROWS_AS(entry.sanitize(), dc::exception);
+}
+
+TEST_CASE("sanitize throws if sync_interval is zero or above max_sync_interval", "[clone_config][config_entry]") { 
+  dc::config_entry entry{
+    fs::path{"/dropclone/test/"},
+    fs::path{"/dropclone/test/"},
+    dc::clone_mode::copy
+  };
+  entry.sync_interval = std::chrono::milliseconds{0};
+  REQUIRE_THROWS_AS(entry.sanitize(), dc::exception);
+
+  entry.sync_interval = std::chrono::milliseconds{2000};
+  entry.max_sync_interval = std::chrono::milliseconds{1000};
+  REQUIRE_THROWS_AS(entry.sanitize(), dc::exception);
+}
+
 TEST_CASE("sanitize throws if both exclude_patterns and include_patterns are non-empty", "[clone_config][config_entry]") { 
   dc::config_entry::raw_patterns_type exclude_patterns{"pattern1", "pattern2"};
   dc::config_entry::raw_patterns_type include_patterns{"pattern1"};
@@ -115,6 +169,19 @@ TEST_CASE("filter returns true if both exclude_patterns and include_patterns are
   REQUIRE(entry.filter(fs::path{"/dropclone/origin/cpp.pdf"}));
 }
 
+TEST_CASE("filter and prune skip the trash below source_directory", "[clone_config][config_entry]") {
+  dc::config_entry entry{
+    fs::path{"/dropclone/origin/"},
+    fs::path{"/dropclone/copy/"},
+    dc::clone_mode::move
+  };
+
+  CHECK_FALSE(entry.filter(fs::path{"/dropclone/origin/.dropclone-trash/1/cpp.pdf"}));
+  CHECK(entry.prune(fs::path{"/dropclone/origin/.dropclone-trash"}));
+  CHECK(entry.filter(fs::path{"/dropclone/origin/.dropclone-trash.pdf"}));
+  CHECK_FALSE(entry.prune(fs::path{"/dropclone/origin/books/.dropclone-trash"}));
+}
+
 TEST_CASE("filter rejects path matching an exclude pattern", "[clone_config][config_entry]") {
   dc::config_entry::raw_patterns_type exclude_patterns{"cpp\\.txt$", "[-.\\w]+\\.pdf$"};
   dc::config_entry::raw_patterns_type include_patterns{};
@@ -171,6 +238,33 @@ TEST_CASE("filter rejects path not matching any include pattern", "[clone_config
   REQUIRE(!entry.filter(fs::path{"/dropclone/origin/books/"}));
 }
 
+TEST_CASE("is_prefix_stable accepts only patterns that keep matching in subdirectories", "[clone_config][config_entry]") {
+  CHECK(dc::config_entry::is_prefix_stable("node_modules/"));
+  CHECK(dc::config_entry::is_prefix_stable("^\\.cache/"));
+  CHECK(dc::config_entry::is_prefix_stable("price\\$"));
+  CHECK(dc::config_entry::is_prefix_stable("[$]"));
+  CHECK_FALSE(dc::config_entry::is_prefix_stable("\\.pdf$"));
+  CHECK_FALSE(dc::config_entry::is_prefix_stable("build\\b"));
+  CHECK_FALSE(dc::config_entry::is_prefix_stable("tmp(?!/keep)"));
+}
+
+TEST_CASE("prune covers directories whose whole subtree is excluded", "[clone_config][config_entry]") {
+  dc::config_entry::raw_patterns_type exclude_patterns{"node_modules/", "\\.pdf$"};
+  dc::config_entry::raw_patterns_type include_patterns{};
+  dc::config_entry entry{
+    fs::path{"/dropclone/origin/"},
+    fs::path{"/dropclone/copy/"},
+    dc::clone_mode::copy,
+    exclude_patterns,
+    include_patterns
+  };
+
+  CHECK(entry.prune(fs::path{"/dropclone/origin/web/node_modules"}));
+  CHECK_FALSE(entry.prune(fs::path{"/dropclone/origin/web"}));
+  CHECK_FALSE(entry.prune(fs::path{"/dropclone/origin/books.pdf"}));
+  CHECK_FALSE(entry.prune(fs::path{"/dropclone/other/node_modules"}));
+}
+
 static fs::path const path_root{"/"};
 static fs::path const path_a{"/a"};
 static fs::path const path_a_slash{"/a/"};
@@ -0,0 +1,191 @@
+#include <catch2/catch_test_macros.hpp>
+#include <dropclone/clone_manager.hpp>
+#include <dropclone/clone_transaction.hpp>
+#include <dropclone/transaction_journal.hpp>
+#include <dropclone/snapshot_index.hpp>
+#include <dropclone/path_snapshot.hpp>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+namespace fs = std::filesystem;
+namespace dc = dropclone;
+
+static fs::path const manager_root = fs::temp_directory_path() / fs::path{"dropclone_clone_manager_test"};
+static fs::path const manager_source = manager_root / fs::path{"source"};
+static fs::path const manager_destination = manager_root / fs::path{"destination"};
+static fs::path const manager_index = manager_root / fs::path{"index"};
+
+using operation = dc::transaction_journal::operation;
+
+static auto create_manager_test_directories() -> void {
+  fs::remove_all(manager_root);
+  fs::create_directories(manager_source);
+  fs::create_directories(manager_destination);
+  fs::create_directories(manager_index);
+}
+
+static auto manager_entry(dc::clone_mode mode) -> dc::config_entry {
+  dc::config_entry entry{manager_source, manager_destination, mode};
+  entry.sanitize();
+  return entry;
+}
+
+static auto manager_index_path() -> fs::path {
+  return dc::snapshot_index::index_path(manager_index, manager_source, manager_destination);
+}
+
+// the journal a crashed run left next to its index
+static auto manager_journal_path() -> fs::path {
+  auto journal_path = manager_index_path();
+  journal_path.replace_extension(".journal");
+  return journal_path;
+}
+
+static auto stored_manager_index() -> dc::path_snapshot {
+  auto snapshot = dc::snapshot_index{manager_index_path()}.load(manager_source);
+  REQUIRE(snapshot.has_value());
+  return std::move(*snapshot);
+}
+
+static auto write_manager_test_file(fs::path const& path, std::string const& content) -> dc::path_info {
+  std::ofstream{path} << content;
+  dc::path_info info{};
+  info.file_size = content.size();
+  info.last_write_time = fs::last_write_time(path);
+  info.file_perms = fs::status(path).permissions();
+  return info;
+}
+
+static auto read_manager_test_file(fs::path const& path) -> std::string {
+  std::ifstream file{path};
+  return std::string{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+}
+
+TEST_CASE("clone_manager rolls back copies that were not done and forwards done ones", "[clone_manager][recovery]") {
+  create_manager_test_directories();
+
+  auto const info = write_manager_test_file(manager_source / "done.txt", "done");
+  write_manager_test_file(manager_destination / "done.txt", "done");
+  write_manager_test_file(manager_source / "partial.txt", "partial");
+  write_manager_test_file(manager_destination / "partial.txt", "par");
+
+  {
+    dc::transaction_journal journal{manager_journal_path()};
+    journal.begin(operation::copy, manager_source / "done.txt", manager_destination / "done.txt", info);
+    journal.done(operation::copy, manager_source / "done.txt", manager_destination / "done.txt");
+    journal.begin(operation::copy, manager_source / "partial.txt", manager_destination / "partial.txt", info);
+  }
+
+  dc::clone_manager manager{manager_entry(dc::clone_mode::copy), manager_index};
+
+  CHECK_FALSE(fs::exists(manager_destination / "partial.txt"));
+  CHECK(fs::exists(manager_destination / "done.txt"));
+
+  auto const index = stored_manager_index();
+  REQUIRE(index.entries().contains(fs::path{"done.txt"}));
+  CHECK(index.entries().at(fs::path{"done.txt"}).file_size == 4);
+  CHECK_FALSE(index.entries().contains(fs::path{"partial.txt"}));
+  CHECK(dc::transaction_journal{manager_journal_path()}.replay().empty());
+
+  fs::remove_all(manager_root);
+}
+
+TEST_CASE("clone_manager removes the copy of a move whose source still exists", "[clone_manager][recovery]") {
+  create_manager_test_directories();
+
+  auto const info = write_manager_test_file(manager_source / "moved.txt", "moved");
+  write_manager_test_file(manager_destination / "moved.txt", "moved");
+
+  {
+    dc::transaction_journal journal{manager_journal_path()};
+    journal.begin(operation::copy, manager_source / "moved.txt", manager_destination / "moved.txt", info);
+    journal.done(operation::copy, manager_source / "moved.txt", manager_destination / "moved.txt");
+  }
+
+  dc::clone_manager manager{manager_entry(dc::clone_mode::move), manager_index};
+
+  CHECK(fs::exists(manager_source / "moved.txt"));
+  CHECK_FALSE(fs::exists(manager_destination / "moved.txt"));
+  CHECK_FALSE(stored_manager_index().entries().contains(fs::path{"moved.txt"}));
+
+  fs::remove_all(manager_root);
+}
+
+TEST_CASE("clone_manager removes the temporary file of an update that was not done", "[clone_manager][recovery]") {
+  create_manager_test_directories();
+
+  auto const to_path = manager_destination / "updated.txt";
+  auto const info = write_manager_test_file(manager_source / "updated.txt", "new content");
+  write_manager_test_file(to_path, "old");
+  write_manager_test_file(dc::update_command::temporary_path(to_path), "new con");
+
+  {
+    dc::transaction_journal journal{manager_journal_path()};
+    journal.begin(operation::update, manager_source / "updated.txt", to_path, info);
+  }
+
+  dc::clone_manager manager{manager_entry(dc::clone_mode::copy), manager_index};
+
+  CHECK_FALSE(fs::exists(dc::update_command::temporary_path(to_path)));
+  CHECK(read_manager_test_file(to_path) == "old");
+  CHECK_FALSE(stored_manager_index().entries().contains(fs::path{"updated.txt"}));
+
+  fs::remove_all(manager_root);
+}
+
+TEST_CASE("clone_manager applies a rename whose source is gone and destination exists", "[clone_manager][recovery]") {
+  create_manager_test_directories();
+
+  // both files were synchronized before the crash
+  auto const info = write_manager_test_file(manager_source / "kept.txt", "kept");
+  dc::path_snapshot::entry_list const synchronized{{fs::path{"renamed.txt"}, info}, {fs::path{"kept.txt"}, info}};
+  dc::snapshot_index{manager_index_path()}.store(dc::path_snapshot{manager_source, synchronized});
+
+  auto const trash = manager_destination / ".dropclone-trash" / "1";
+  fs::create_directories(trash);
+  write_manager_test_file(trash / "renamed.txt", "renamed");
+  write_manager_test_file(manager_destination / "kept.txt", "kept");
+
+  {
+    dc::transaction_journal journal{manager_journal_path()};
+    journal.begin(operation::rename, manager_destination / "renamed.txt", trash / "renamed.txt", info);
+    journal.begin(operation::rename, manager_destination / "kept.txt", trash / "kept.txt", info);
+  }
+
+  dc::clone_manager manager{manager_entry(dc::clone_mode::copy), manager_index};
+
+  auto const index = stored_manager_index();
+  CHECK_FALSE(index.entries().contains(fs::path{"renamed.txt"}));
+  CHECK(index.entries().contains(fs::path{"kept.txt"}));
+
+  fs::remove_all(manager_root);
+}
+
+TEST_CASE("clone_manager leaves watch cycles to the journal until the index is stored", "[clone_manager][index]") {
+  create_manager_test_directories();
+  write_manager_test_file(manager_source / "first.txt", "first");
+
+  {
+    auto entry = manager_entry(dc::clone_mode::copy);
+    entry.watch = true;
+    dc::clone_manager manager{entry, manager_index};
+
+    // the first cycle scans everything and stores the index
+    REQUIRE(manager.sync());
+    REQUIRE(stored_manager_index().entries().contains(fs::path{"first.txt"}));
+
+    write_manager_test_file(manager_source / "second.txt", "second");
+    REQUIRE(manager.sync());
+
+    CHECK(read_manager_test_file(manager_destination / "second.txt") == "second");
+    CHECK_FALSE(stored_manager_index().entries().contains(fs::path{"second.txt"}));
+    CHECK_FALSE(dc::transaction_journal{manager_journal_path()}.replay().empty());
+  }
+
+  CHECK(stored_manager_index().entries().contains(fs::path{"second.txt"}));
+  CHECK(dc::transaction_journal{manager_journal_path()}.replay().empty());
+
+  fs::remove_all(manager_root);
+}
@@ -0,0 +1,203 @@
+#include <catch2/catch_test_macros.hpp>
+#include <dropclone/clone_transaction.hpp>
+#include <dropclone/path_snapshot.hpp>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+namespace fs = std::filesystem;
+namespace dc = dropclone;
+
+static fs::path const transaction_root = fs::temp_directory_path() / fs::path{"dropclone_transaction_test"};
+static fs::path const transaction_source = transaction_root / fs::path{"source"};
+static fs::path const transaction_destination = transaction_root / fs::path{"destination"};
+
+static auto create_transaction_test_files(int count) -> dc::path_snapshot::snapshot_entries {
+  fs::remove_all(transaction_root);
+  fs::create_directories(transaction_source);
+  fs::create_directories(transaction_destination);
+
+  dc::path_snapshot::snapshot_entries files{};
+  for (int file{0}; file != count; ++file) {
+    auto const name = fs::path{"file_" + std::to_string(file) + ".txt"};
+    std::ofstream{transaction_source / name} << name.string();
+    files.emplace(name, dc::path_info{});
+  }
+  return files;
+}
+
+TEST_CASE("copy_files with multiple workers copies and records every file", "[clone_transaction][copy_files]") {
+  auto files = create_transaction_test_files(64);
+  dc::path_snapshot::snapshot_entries processed{};
+
+  dc::copy_files(files, transaction_source, transaction_destination, 
+                 false, fs::copy_options::none, dc::command_options{4}, &processed);
+
+  CHECK(processed.size() == 64);
+  for (auto const& file : files) {
+    CHECK(fs::exists(transaction_destination / file.first));
+  }
+
+  fs::remove_all(transaction_root);
+}
+
+TEST_CASE("copy_files records the files copied before a failure", "[clone_transaction][copy_files]") {
+  auto files = create_transaction_test_files(32);
+  files.emplace(fs::path{"missing.txt"}, dc::path_info{});
+  dc::path_snapshot::snapshot_entries processed{};
+
+  CHECK_THROWS_AS(dc::copy_files(files, transaction_source, transaction_destination, 
+                                 false, fs::copy_options::none, dc::command_options{4}, &processed),
+                  fs::filesystem_error);
+
+  CHECK_FALSE(processed.contains(fs::path{"missing.txt"}));
+  for (auto const& file : processed) {
+    CHECK(fs::exists(transaction_destination / file.first));
+  }
+
+  fs::remove_all(transaction_root);
+}
+
+static auto read_transaction_test_file(fs::path const& path) -> std::string {
+  std::ifstream file{path};
+  return std::string{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+}
+
+TEST_CASE("update_command swaps new content in and removes the old one on commit", "[clone_transaction][update_command]") {
+  auto files = create_transaction_test_files(8);
+  for (auto const& file : files) {
+    std::ofstream{transaction_destination / file.first} << "old";
+  }
+
+  dc::path_snapshot updated{transaction_source};
+  updated.add_files(files, [](auto const&) { return true; });
+
+  dc::clone_transaction transaction{};
+  transaction.add(dc::update_command{updated, transaction_destination, dc::command_options{4}});
+  transaction.start();
+
+  for (auto const& file : files) {
+    auto const to_path = transaction_destination / file.first;
+    CHECK(read_transaction_test_file(to_path) == file.first.string());
+    CHECK_FALSE(fs::exists(dc::update_command::temporary_path(to_path)));
+  }
+
+  fs::remove_all(transaction_root);
+}
+
+TEST_CASE("update_command undo restores the previous content", "[clone_transaction][update_command]") {
+  auto files = create_transaction_test_files(4);
+  std::ofstream{transaction_destination / files.begin()->first} << "old";
+
+  dc::path_snapshot updated{transaction_source};
+  updated.add_files(files, [](auto const&) { return true; });
+
+  dc::update_command command{updated, transaction_destination};
+  command.execute();
+  command.undo();
+
+  for (auto const& file : files) {
+    auto const to_path = transaction_destination / file.first;
+    if (file.first == files.begin()->first) {
+      CHECK(read_transaction_test_file(to_path) == "old");
+    } else {
+      CHECK_FALSE(fs::exists(to_path));
+    }
+    CHECK_FALSE(fs::exists(dc::update_command::temporary_path(to_path)));
+  }
+
+  fs::remove_all(transaction_root);
+}
+
+TEST_CASE("update_command swaps by name where the file system cannot exchange", "[clone_transaction][update_command]") {
+  fs::remove_all(transaction_root);
+  fs::create_directories(transaction_destination);
+  auto const to_path = transaction_destination / "file.txt";
+  auto const swap_path = dc::update_command::temporary_path(to_path);
+  auto const parked_path = dc::update_command::parked_path(to_path);
+
+  std::ofstream{to_path} << "old";
+  std::ofstream{swap_path} << "new";
+  dc::update_command::swap_by_name(swap_path, to_path);
+  CHECK(read_transaction_test_file(to_path) == "new");
+  CHECK(read_transaction_test_file(swap_path) == "old");
+  CHECK_FALSE(fs::exists(parked_path));
+
+  // a failing rename leaves the new content where it was
+  fs::remove(to_path);
+  std::ofstream{swap_path, std::ios::trunc} << "new";
+  CHECK_THROWS_AS(dc::update_command::swap_by_name(swap_path, to_path), fs::filesystem_error);
+  CHECK(read_transaction_test_file(swap_path) == "new");
+  CHECK_FALSE(fs::exists(parked_path));
+
+  fs::remove_all(transaction_root);
+}
+
+TEST_CASE("update_command clean_up restores a destination a swap left missing", "[clone_transaction][update_command]") {
+  fs::remove_all(transaction_root);
+  fs::create_directories(transaction_destination);
+  auto const to_path = transaction_destination / "file.txt";
+  auto const swap_path = dc::update_command::temporary_path(to_path);
+  auto const parked_path = dc::update_command::parked_path(to_path);
+
+  // a crash between the second and the third rename of swap_by_name
+  std::ofstream{swap_path} << "old";
+  std::ofstream{parked_path} << "new";
+  CHECK(dc::update_command::clean_up(to_path));
+  CHECK(read_transaction_test_file(to_path) == "new");
+  CHECK_FALSE(fs::exists(swap_path));
+  CHECK_FALSE(fs::exists(parked_path));
+
+  // with the destination in place, leftovers are only removed
+  std::ofstream{parked_path} << "newer";
+  CHECK(dc::update_command::clean_up(to_path));
+  CHECK(read_transaction_test_file(to_path) == "new");
+  CHECK_FALSE(fs::exists(parked_path));
+  CHECK_FALSE(dc::update_command::clean_up(to_path));
+
+  fs::remove_all(transaction_root);
+}
+
+TEST_CASE("remove_command moves files into its trash and undo renames them back", "[clone_transaction][remove_command]") {
+  auto files = create_transaction_test_files(4);
+
+  dc::path_snapshot removed{transaction_source};
+  removed.add_files(files, [](auto const&) { return true; });
+
+  dc::remove_command command{removed};
+  command.execute();
+  for (auto const& file : files) {
+    CHECK_FALSE(fs::exists(transaction_source / file.first));
+  }
+
+  command.undo();
+  for (auto const& file : files) {
+    CHECK(read_transaction_test_file(transaction_source / file.first) == file.first.string());
+  }
+  CHECK_FALSE(fs::exists(dc::trash_purger::trash_root(transaction_source)));
+
+  fs::remove_all(transaction_root);
+}
+
+TEST_CASE("remove_command hands its trash to the purger on commit", "[clone_transaction][remove_command]") {
+  auto files = create_transaction_test_files(4);
+  std::ofstream{transaction_source / "kept.txt"} << "kept";
+
+  dc::path_snapshot removed{transaction_source};
+  removed.add_files(files, [](auto const&) { return true; });
+
+  dc::trash_purger purger{};
+  dc::clone_transaction transaction{};
+  transaction.add(dc::remove_command{removed, dc::command_options{1, nullptr, false, &purger}});
+  transaction.start();
+  purger.wait();
+
+  for (auto const& file : files) {
+    CHECK_FALSE(fs::exists(transaction_source / file.first));
+  }
+  CHECK(fs::exists(transaction_source / "kept.txt"));
+  CHECK_FALSE(fs::exists(dc::trash_purger::trash_root(transaction_source)));
+
+  fs::remove_all(transaction_root);
+}
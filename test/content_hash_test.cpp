@@ -0,0 +1,107 @@
+#include <catch2/catch_test_macros.hpp>
+#include <dropclone/content_hash.hpp>
+#include <xxhash.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace fs = std::filesystem;
+namespace dc = dropclone;
+
+static fs::path const hash_root = fs::temp_directory_path() / fs::path{"dropclone_content_hash_test"};
+
+TEST_CASE("xxHash matches the reference XXH64 digests", "[content_hash][xxhash]") {
+  auto const digest = [](std::string const& input) { return XXH64(input.data(), input.size(), 0); };
+
+  CHECK(digest("") == 0xEF46DB3751D8E999ULL);
+  CHECK(digest("abc") == 0x44BC2CF5AD770999ULL);
+
+  std::string input(1000, '\0');
+  for (std::size_t index{0}; index != input.size(); ++index) { input[index] = static_cast<char>(index % 251); }
+  CHECK(digest(input) == 0xF306F04AA88B54D3ULL);
+}
+
+TEST_CASE("xxh3 matches the one-shot XXH3 digest in one piece and streamed", "[content_hash][xxh3]") {
+  auto const digest = [](std::string const& input) {
+    dc::xxh3 hasher{};
+    hasher.update(input.data(), input.size());
+    return hasher.digest();
+  };
+
+  CHECK(digest("") == 0x2D06800538D394C2ULL);
+  CHECK(digest("abc") == 0x78AF5F94892F3950ULL);
+
+  // long enough to cross the stripe and block boundaries of the streaming state
+  std::string input(5000, '\0');
+  for (std::size_t index{0}; index != input.size(); ++index) { input[index] = static_cast<char>(index % 251); }
+  auto const expected = XXH3_64bits(input.data(), input.size());
+  CHECK(digest(input) == expected);
+
+  for (std::size_t const piece : {1, 7, 63, 64, 65, 240, 1025}) {
+    dc::xxh3 hasher{};
+    for (std::size_t offset{0}; offset < input.size(); offset += piece) {
+      hasher.update(input.data() + offset, std::min(piece, input.size() - offset));
+    }
+    CHECK(hasher.digest() == expected);
+  }
+}
+
+TEST_CASE("hash_cache reuses digests of untouched files across restarts", "[content_hash][hash_cache]") {
+  fs::remove_all(hash_root);
+  fs::create_directories(hash_root);
+  std::ofstream{hash_root / "file.txt"} << "abc";
+
+  {
+    dc::hash_cache cache{hash_root / "cache.hashes"};
+    CHECK(cache.digest(hash_root / "file.txt") == 0x78AF5F94892F3950ULL);
+    CHECK_FALSE(cache.digest(hash_root / "missing.txt").has_value());
+    CHECK_FALSE(cache.digest(hash_root).has_value());
+    REQUIRE(cache.store());
+  }
+
+  // a cache loaded from disk knows the file without reading it again
+  dc::hash_cache cache{hash_root / "cache.hashes"};
+  cache.load();
+  auto const modification_time = fs::last_write_time(hash_root / "file.txt");
+  CHECK(cache.digest(hash_root / "file.txt") == 0x78AF5F94892F3950ULL);
+
+  // a rewrite is detected even if the mtime is put back afterwards
+  std::ofstream{hash_root / "file.txt", std::ios::trunc} << "abd";
+  fs::last_write_time(hash_root / "file.txt", modification_time);
+  CHECK(cache.digest(hash_root / "file.txt") != 0x78AF5F94892F3950ULL);
+
+  std::ofstream{hash_root / "cache.hashes", std::ios::trunc} << "garbage";
+  dc::hash_cache broken_cache{hash_root / "cache.hashes"};
+  broken_cache.load();
+  CHECK(broken_cache.digest(hash_root / "file.txt") == cache.digest(hash_root / "file.txt"));
+
+  fs::remove_all(hash_root);
+}
+
+TEST_CASE("hash_cache drops files that were not looked up since the last store", "[content_hash][hash_cache]") {
+  fs::remove_all(hash_root);
+  fs::create_directories(hash_root);
+  std::ofstream{hash_root / "kept.txt"} << "abc";
+  std::ofstream{hash_root / "removed.txt"} << "abd";
+
+  auto const cache_size = [](std::uintmax_t entries) { return 24 + entries * 48; };
+
+  {
+    dc::hash_cache cache{hash_root / "cache.hashes"};
+    CHECK(cache.digest(hash_root / "kept.txt").has_value());
+    CHECK(cache.digest(hash_root / "removed.txt").has_value());
+    REQUIRE(cache.store());
+  }
+  CHECK(fs::file_size(hash_root / "cache.hashes") == cache_size(2));
+
+  fs::remove(hash_root / "removed.txt");
+  dc::hash_cache cache{hash_root / "cache.hashes"};
+  cache.load();
+  CHECK(cache.digest(hash_root / "kept.txt") == 0x78AF5F94892F3950ULL);
+  REQUIRE(cache.store());
+  CHECK(fs::file_size(hash_root / "cache.hashes") == cache_size(1));
+
+  fs::remove_all(hash_root);
+}
@@ -0,0 +1,67 @@
+#include <catch2/catch_test_macros.hpp>
+#include <dropclone/copy_engine.hpp>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+namespace fs = std::filesystem;
+namespace dc = dropclone;
+
+static fs::path const engine_root = fs::temp_directory_path() / fs::path{"dropclone_copy_engine_test"};
+
+static auto read_file(fs::path const& path) -> std::string {
+  std::ifstream file_stream{path, std::ios::binary};
+  std::stringstream content{};
+  content << file_stream.rdbuf();
+  return content.str();
+}
+
+TEST_CASE("clone_file copies content and permissions and reports the method", "[copy_engine][clone_file]") {
+  fs::remove_all(engine_root);
+  fs::create_directories(engine_root);
+
+  std::string const content(3 * 1024 * 1024 + 17, 'x');
+  std::ofstream{engine_root / "source.bin", std::ios::binary} << content;
+  fs::permissions(engine_root / "source.bin", fs::perms::owner_read | fs::perms::owner_write | fs::perms::group_read);
+  std::ofstream{engine_root / "empty.bin"};
+
+  auto const result = dc::clone_file(engine_root / "source.bin", engine_root / "copy.bin");
+  REQUIRE(result.has_value());
+  CHECK(result->method != dc::copy_method::standard);
+  CHECK(result->bytes == content.size());
+  CHECK(read_file(engine_root / "copy.bin") == content);
+  CHECK(fs::status(engine_root / "copy.bin").permissions() == fs::status(engine_root / "source.bin").permissions());
+
+  REQUIRE(dc::clone_file(engine_root / "empty.bin", engine_root / "empty_copy.bin").has_value());
+  CHECK(fs::file_size(engine_root / "empty_copy.bin") == 0);
+
+  dc::copy_statistics statistics{};
+  statistics.record(*result);
+  CHECK(statistics.total_files() == 1);
+  CHECK(statistics.files(result->method) == 1);
+  CHECK(statistics.total_bytes() == content.size());
+
+  fs::remove_all(engine_root);
+}
+
+TEST_CASE("clone_file handles an existing destination like fs::copy", "[copy_engine][clone_file]") {
+  fs::remove_all(engine_root);
+  fs::create_directories(engine_root);
+  std::ofstream{engine_root / "source.txt"} << "new content";
+  std::ofstream{engine_root / "destination.txt"} << "old";
+
+  CHECK_THROWS_AS(dc::clone_file(engine_root / "source.txt", engine_root / "destination.txt"), fs::filesystem_error);
+  CHECK_FALSE(dc::clone_file(engine_root / "source.txt", engine_root / "destination.txt", 
+                             fs::copy_options::skip_existing).has_value());
+  CHECK(read_file(engine_root / "destination.txt") == "old");
+
+  REQUIRE(dc::clone_file(engine_root / "source.txt", engine_root / "destination.txt", 
+                         fs::copy_options::overwrite_existing).has_value());
+  CHECK(read_file(engine_root / "destination.txt") == "new content");
+
+  CHECK_THROWS_AS(dc::clone_file(engine_root / "missing.txt", engine_root / "other.txt"), fs::filesystem_error);
+  CHECK_FALSE(fs::exists(engine_root / "other.txt"));
+
+  fs::remove_all(engine_root);
+}
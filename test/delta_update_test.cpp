@@ -0,0 +1,92 @@
+#include <catch2/catch_test_macros.hpp>
+#include <dropclone/delta_update.hpp>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+namespace fs = std::filesystem;
+namespace dc = dropclone;
+
+static fs::path const delta_root = fs::temp_directory_path() / fs::path{"dropclone_delta_update_test"};
+
+static auto read_file(fs::path const& path) -> std::string {
+  std::ifstream file_stream{path, std::ios::binary};
+  std::stringstream content{};
+  content << file_stream.rdbuf();
+  return content.str();
+}
+
+static auto write_file(fs::path const& path, std::string const& content) -> void {
+  std::ofstream{path, std::ios::binary | std::ios::trunc} << content;
+}
+
+static auto make_content(std::size_t size) -> std::string {
+  std::string content(size, '\0');
+  for (std::size_t index{0}; index != size; ++index) { content[index] = static_cast<char>('a' + (index * 7 + index / 4096) % 26); }
+  return content;
+}
+
+TEST_CASE("delta_update rewrites only changed blocks and can be undone", "[delta_update]") {
+  fs::remove_all(delta_root);
+  fs::create_directories(delta_root);
+
+  auto const original = make_content(20 * dc::delta_block_size + 100);
+  auto changed = original;
+  changed[3 * dc::delta_block_size + 5] = '#';
+  changed[17 * dc::delta_block_size] = '#';
+  changed.append(dc::delta_block_size / 2, 'z');
+
+  write_file(delta_root / "source", changed);
+  write_file(delta_root / "destination", original);
+  fs::permissions(delta_root / "source", fs::perms::owner_read | fs::perms::owner_write);
+
+  auto const result = dc::delta_update(delta_root / "source", delta_root / "destination", delta_root / "journal");
+  CHECK(result.blocks == 21);
+  // the two modified blocks and the grown last block
+  CHECK(result.changed_blocks == 3);
+  CHECK(result.bytes_written == 2 * dc::delta_block_size + 100 + dc::delta_block_size / 2);
+  CHECK(read_file(delta_root / "destination") == changed);
+  CHECK(fs::status(delta_root / "destination").permissions() == (fs::perms::owner_read | fs::perms::owner_write));
+  REQUIRE(fs::exists(delta_root / "journal"));
+
+  CHECK(dc::delta_restore(delta_root / "destination", delta_root / "journal"));
+  CHECK(read_file(delta_root / "destination") == original);
+  CHECK_FALSE(fs::exists(delta_root / "journal"));
+
+  // shrinking cuts off blocks that the journal has to bring back
+  write_file(delta_root / "source", original.substr(0, 2 * dc::delta_block_size));
+  dc::delta_update(delta_root / "source", delta_root / "destination", delta_root / "journal");
+  CHECK(fs::file_size(delta_root / "destination") == 2 * dc::delta_block_size);
+  dc::delta_restore(delta_root / "destination", delta_root / "journal");
+  CHECK(read_file(delta_root / "destination") == original);
+
+  fs::remove_all(delta_root);
+}
+
+TEST_CASE("recover_delta_journals restores complete journals and drops incomplete ones", "[delta_update]") {
+  fs::remove_all(delta_root);
+  fs::create_directories(delta_root / "destination" / "sub");
+  fs::create_directories(delta_root / "journals" / "sub");
+
+  auto const original = make_content(4 * dc::delta_block_size);
+  auto changed = original;
+  changed[dc::delta_block_size] = '#';
+
+  write_file(delta_root / "source", changed);
+  write_file(delta_root / "destination" / "sub" / "file", original);
+  write_file(delta_root / "destination" / "other", original);
+
+  dc::delta_update(delta_root / "source", delta_root / "destination" / "sub" / "file",
+                   delta_root / "journals" / "sub" / "file");
+  // interrupted before it was sealed: the destination was never touched
+  write_file(delta_root / "journals" / "other", "DCDELTA1");
+
+  CHECK(dc::recover_delta_journals(delta_root / "journals", delta_root / "destination") == 1);
+  CHECK(read_file(delta_root / "destination" / "sub" / "file") == original);
+  CHECK(read_file(delta_root / "destination" / "other") == original);
+  CHECK_FALSE(fs::exists(delta_root / "journals"));
+  CHECK(dc::recover_delta_journals(delta_root / "journals", delta_root / "destination") == 0);
+
+  fs::remove_all(delta_root);
+}
@@ -0,0 +1,57 @@
+#include <catch2/catch_test_macros.hpp>
+#include <dropclone/duplicate_name_index.hpp>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <set>
+#include <vector>
+
+namespace fs = std::filesystem;
+namespace dc = dropclone;
+
+static fs::path const index_root = fs::temp_directory_path() / fs::path{"dropclone_duplicate_name_index_test"};
+
+TEST_CASE("duplicate_name_index skips names on disk and names handed out before", "[duplicate_name_index]") {
+  fs::remove_all(index_root);
+  fs::create_directories(index_root / "inbox");
+  std::ofstream{index_root / "inbox/scan.pdf"};
+  std::ofstream{index_root / "inbox/scan_2.pdf"};
+
+  dc::duplicate_name_index names{index_root};
+
+  CHECK(names.allocate("inbox/scan.pdf") == fs::path{"inbox/scan_1.pdf"});
+  CHECK(names.allocate("inbox/scan.pdf") == fs::path{"inbox/scan_3.pdf"});
+  CHECK(names.allocate("inbox/notes.txt") == fs::path{"inbox/notes.txt"});
+  CHECK(names.allocate("inbox/notes.txt") == fs::path{"inbox/notes_1.txt"});
+  CHECK(names.allocate("new/scan.pdf") == fs::path{"new/scan.pdf"});
+
+  fs::remove_all(index_root);
+}
+
+TEST_CASE("duplicate_name_index hands out distinct names to concurrent callers", "[duplicate_name_index]") {
+  fs::remove_all(index_root);
+  fs::create_directories(index_root);
+
+  dc::duplicate_name_index names{index_root};
+  std::mutex allocated_mutex{};
+  std::set<fs::path> allocated{};
+
+  std::vector<std::thread> threads{};
+  for (auto thread{0}; thread != 4; ++thread) {
+    threads.emplace_back([&] {
+      for (auto count{0}; count != 250; ++count) {
+        auto name = names.allocate("scan.pdf");
+        std::lock_guard<std::mutex> allocated_guard{allocated_mutex};
+        allocated.insert(std::move(name));
+      }
+    });
+  }
+  for (auto& thread : threads) { thread.join(); }
+
+  CHECK(allocated.size() == 1000);
+  CHECK(allocated.contains("scan.pdf"));
+  CHECK(allocated.contains("scan_999.pdf"));
+
+  fs::remove_all(index_root);
+}
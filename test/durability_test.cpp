@@ -0,0 +1,133 @@
+#include <catch2/catch_test_macros.hpp>
+#include <dropclone/durability.hpp>
+#include <dropclone/clone_transaction.hpp>
+#include <dropclone/path_snapshot.hpp>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace fs = std::filesystem;
+namespace dc = dropclone;
+
+static fs::path const durability_root = fs::temp_directory_path() / fs::path{"dropclone_durability_test"};
+
+static auto create_durability_test_files(int directories, int files) -> std::vector<fs::path> {
+  fs::remove_all(durability_root);
+
+  std::vector<fs::path> paths{};
+  for (int directory{0}; directory != directories; ++directory) {
+    auto const parent = durability_root / fs::path{"dir_" + std::to_string(directory)};
+    fs::create_directories(parent);
+    for (int file{0}; file != files; ++file) {
+      auto const path = parent / fs::path{"file_" + std::to_string(file) + ".txt"};
+      std::ofstream{path} << path.string();
+      paths.push_back(path);
+    }
+  }
+  return paths;
+}
+
+TEST_CASE("durability_tracker syncs every file right away in per_file mode", "[durability]") {
+  auto const paths = create_durability_test_files(1, 4);
+
+  dc::durability_tracker tracker{dc::durability_mode::per_file};
+  for (auto const& path : paths) { tracker.written(path); }
+  CHECK(tracker.synced_files() == 4);
+
+  tracker.flush();
+  CHECK(tracker.synced_files() == 4);
+
+  fs::remove_all(durability_root);
+}
+
+TEST_CASE("durability_tracker batches files until flush", "[durability]") {
+  auto const paths = create_durability_test_files(4, 8);
+
+  for (auto const mode : {dc::durability_mode::per_directory, dc::durability_mode::per_transaction}) {
+    dc::durability_tracker tracker{mode, 4};
+    for (auto const& path : paths) { tracker.written(path); }
+    CHECK(tracker.synced_files() == 0);
+
+    tracker.flush();
+    CHECK(tracker.synced_files() == paths.size());
+
+    tracker.reset();
+    CHECK(tracker.synced_files() == 0);
+    CHECK(tracker.sync_time() == std::chrono::nanoseconds::zero());
+  }
+
+  fs::remove_all(durability_root);
+}
+
+TEST_CASE("durability_tracker forgets pending files on reset and discard", "[durability]") {
+  auto const paths = create_durability_test_files(2, 4);
+
+  dc::durability_tracker tracker{dc::durability_mode::per_directory};
+  for (auto const& path : paths) { tracker.written(path); }
+  tracker.reset();
+  tracker.flush();
+  CHECK(tracker.synced_files() == 0);
+
+  for (auto const& path : paths) { tracker.written(path); }
+  tracker.discard();
+  tracker.written(paths.front());
+  tracker.flush();
+  CHECK(tracker.synced_files() == 1);
+
+  fs::remove_all(durability_root);
+}
+
+TEST_CASE("durability_tracker skips files that are gone", "[durability]") {
+  auto const paths = create_durability_test_files(1, 2);
+
+  dc::durability_tracker tracker{dc::durability_mode::per_directory};
+  tracker.written(paths[0]);
+  tracker.written(durability_root / "dir_0" / "missing.txt");
+  REQUIRE_NOTHROW(tracker.flush());
+
+  fs::remove_all(durability_root);
+}
+
+TEST_CASE("durability_tracker does nothing in mode none", "[durability]") {
+  auto const paths = create_durability_test_files(1, 2);
+
+  dc::durability_tracker tracker{dc::durability_mode::none};
+  for (auto const& path : paths) { tracker.written(path); }
+  tracker.flush();
+  CHECK(tracker.synced_files() == 0);
+
+  fs::remove_all(durability_root);
+}
+
+TEST_CASE("clone_transaction flushes what its commands wrote before it commits", "[durability][clone_transaction]") {
+  create_durability_test_files(0, 0);
+  auto const source = durability_root / "source";
+  auto const destination = durability_root / "destination";
+  fs::create_directories(source);
+  fs::create_directories(destination);
+
+  dc::path_snapshot::snapshot_entries files{};
+  for (int file{0}; file != 6; ++file) {
+    auto const name = fs::path{"file_" + std::to_string(file) + ".txt"};
+    std::ofstream{source / name} << name.string();
+    files.emplace(name, dc::path_info{});
+  }
+
+  dc::path_snapshot added{source};
+  added.add_files(files, [](auto const&) { return true; });
+
+  dc::durability_tracker tracker{dc::durability_mode::per_directory, 2};
+  dc::command_options options{};
+  options.durability = &tracker;
+
+  dc::clone_transaction transaction{nullptr, &tracker};
+  transaction.add(dc::copy_command{added, destination, dc::behavior_policies::none, options});
+  transaction.start();
+
+  CHECK(tracker.synced_files() == 6);
+  for (auto const& file : files) {
+    CHECK(fs::exists(destination / file.first));
+  }
+
+  fs::remove_all(durability_root);
+}
@@ -0,0 +1,102 @@
+#include <catch2/catch_test_macros.hpp>
+#include <dropclone/io_uring_backend.hpp>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+namespace dc = dropclone;
+
+static fs::path const uring_root = fs::temp_directory_path() / fs::path{"dropclone_io_uring_backend_test"};
+
+static auto read_file(fs::path const& path) -> std::string {
+  std::ifstream file_stream{path, std::ios::binary};
+  std::stringstream content{};
+  content << file_stream.rdbuf();
+  return content.str();
+}
+
+TEST_CASE("io_uring_backend copies files and skips existing destinations", "[io_uring_backend]") {
+  auto* const backend = dc::io_uring_backend::local();
+  if (backend == nullptr) { SKIP("io_uring is not available"); }
+
+  fs::remove_all(uring_root);
+  fs::create_directories(uring_root / "source");
+  fs::create_directories(uring_root / "destination");
+
+  std::vector<dc::io_uring_backend::path_pair> copies{};
+  for (auto index{0}; index != 40; ++index) {
+    auto const name = "file_" + std::to_string(index);
+    std::ofstream{uring_root / "source" / name, std::ios::binary} << std::string(index * 37 * 1024 + 3, 'a' + index % 26);
+    copies.push_back({uring_root / "source" / name, uring_root / "destination" / name});
+  }
+  fs::permissions(uring_root / "source" / "file_7", fs::perms::owner_read | fs::perms::group_read);
+  std::ofstream{uring_root / "destination" / "file_3"} << "old";
+
+  std::vector<std::size_t> done{};
+  backend->copy_files(copies, false, [&](std::size_t index, dc::copy_result const& result) {
+    CHECK(result.method == dc::copy_method::io_uring);
+    CHECK(result.bytes == fs::file_size(copies[index].from));
+    done.push_back(index);
+  });
+
+  CHECK(done.size() == copies.size() - 1);
+  CHECK(read_file(uring_root / "destination" / "file_3") == "old");
+  CHECK(read_file(uring_root / "destination" / "file_39") == read_file(uring_root / "source" / "file_39"));
+  CHECK(fs::status(uring_root / "destination" / "file_7").permissions() ==
+        (fs::perms::owner_read | fs::perms::group_read));
+
+  done.clear();
+  backend->copy_files(std::span{copies}.subspan(3, 1), true, [&](std::size_t index, dc::copy_result const&) {
+    done.push_back(index);
+  });
+  CHECK(done.size() == 1);
+  CHECK(read_file(uring_root / "destination" / "file_3") == read_file(uring_root / "source" / "file_3"));
+
+  std::vector<dc::io_uring_backend::path_pair> const missing{{uring_root / "source" / "missing", uring_root / "destination" / "missing"}};
+  CHECK_THROWS_AS(backend->copy_files(missing, false, [](std::size_t, dc::copy_result const&) {}), fs::filesystem_error);
+  CHECK_FALSE(fs::exists(uring_root / "destination" / "missing"));
+
+  fs::remove_all(uring_root);
+}
+
+TEST_CASE("io_uring_backend creates, renames and removes in batches", "[io_uring_backend]") {
+  auto* const backend = dc::io_uring_backend::local();
+  if (backend == nullptr) { SKIP("io_uring is not available"); }
+
+  fs::remove_all(uring_root);
+  fs::create_directories(uring_root / "existing");
+
+  // children before parents and a directory that already exists
+  std::vector<fs::path> const directories{
+    uring_root / "a" / "b" / "c", uring_root / "a", uring_root / "a" / "b", uring_root / "existing"
+  };
+  std::size_t created{0};
+  backend->create_directories(directories, [&](std::size_t) { ++created; });
+  CHECK(created == 3);
+  CHECK(fs::is_directory(uring_root / "a" / "b" / "c"));
+
+  std::ofstream{uring_root / "a" / "file"} << "content";
+  std::vector<dc::io_uring_backend::path_pair> const renames{
+    {uring_root / "a" / "file", uring_root / "a" / "b" / "file"},
+    {uring_root / "a" / "gone", uring_root / "a" / "b" / "gone"}
+  };
+  std::vector<std::size_t> renamed{};
+  backend->rename_files(renames, [&](std::size_t index) { renamed.push_back(index); });
+  CHECK(renamed == std::vector<std::size_t>{0});
+  CHECK(read_file(uring_root / "a" / "b" / "file") == "content");
+
+  std::vector<fs::path> const files{uring_root / "a" / "b" / "file", uring_root / "a" / "gone"};
+  std::size_t removed{0};
+  backend->remove_files(files, [&](std::size_t) { ++removed; });
+  CHECK(removed == 1);
+
+  removed = 0;
+  backend->remove_directories(std::span{directories}.first(3), [&](std::size_t) { ++removed; });
+  CHECK(removed == 3);
+  CHECK_FALSE(fs::exists(uring_root / "a"));
+
+  fs::remove_all(uring_root);
+}
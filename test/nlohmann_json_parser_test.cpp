@@ -292,6 +292,283 @@ TEST_CASE("parser throws if field 'destination_directory' has invalid type", "[n
     Catch::Matchers::MessageMatches(Catch::Matchers::ContainsSubstring("config_error.003")));
 }
 
+TEST_CASE("parser throws if field 'scan_threads' has invalid type", "[nlohmann_json_parser]") {
+  constexpr auto json_config = 
+  R"(
+  {
+    "clone_config" : [
+      {
+        "source_directory" : "/home/source",
+        "destination_directory" : "/home/destination/",
+        "mode" : "copy",
+        "scan_threads" : "four"
+      }
+    ],
+    "log_directory" : "/github/dropclone/log/"
+  })";
+
+  create_temporary_json_file(json_config);
+
+  REQUIRE_THROWS_MATCHES(dc::nlohmann_json_parser{}(temp_config_path), dc::exception, 
+    Catch::Matchers::MessageMatches(Catch::Matchers::ContainsSubstring("config_error.010")));
+}
+
+TEST_CASE("parser throws if field 'watch' has invalid type", "[nlohmann_json_parser]") {
+  constexpr auto json_config = 
+  R"(
+  {
+    "clone_config" : [
+      {
+        "source_directory" : "/home/source",
+        "destination_directory" : "/home/destination/",
+        "mode" : "copy",
+        "watch" : "yes"
+      }
+    ],
+    "log_directory" : "/github/dropclone/log/"
+  })";
+
+  create_temporary_json_file(json_config);
+
+  REQUIRE_THROWS_MATCHES(dc::nlohmann_json_parser{}(temp_config_path), dc::exception, 
+    Catch::Matchers::MessageMatches(Catch::Matchers::ContainsSubstring("config_error.010")));
+}
+
+TEST_CASE("parser throws if field 'sync_budget_seconds' has invalid type", "[nlohmann_json_parser]") {
+  constexpr auto json_config = 
+  R"(
+  {
+    "clone_config" : [
+      {
+        "source_directory" : "/home/source",
+        "destination_directory" : "/home/destination/",
+        "mode" : "copy",
+        "sync_budget_seconds" : -5
+      }
+    ],
+    "log_directory" : "/github/dropclone/log/"
+  })";
+
+  create_temporary_json_file(json_config);
+
+  REQUIRE_THROWS_MATCHES(dc::nlohmann_json_parser{}(temp_config_path), dc::exception, 
+    Catch::Matchers::MessageMatches(Catch::Matchers::ContainsSubstring("config_error.010")));
+}
+
+TEST_CASE("parser throws if field 'max_concurrent_syncs' has invalid type", "[nlohmann_json_parser]") {
+  constexpr auto json_config = 
+  R"(
+  {
+    "clone_config" : [
+      {
+        "source_directory" : "/home/source",
+        "destination_directory" : "/home/destination/",
+        "mode" : "copy"
+      }
+    ],
+    "log_directory" : "/github/dropclone/log/",
+    "max_concurrent_syncs" : "all"
+  })";
+
+  create_temporary_json_file(json_config);
+
+  REQUIRE_THROWS_MATCHES(dc::nlohmann_json_parser{}(temp_config_path), dc::exception, 
+    Catch::Matchers::MessageMatches(Catch::Matchers::ContainsSubstring("config_error.010")));
+}
+
+TEST_CASE("parser throws if field 'copy_workers' has invalid type", "[nlohmann_json_parser]") {
+  constexpr auto json_config = 
+  R"(
+  {
+    "clone_config" : [
+      {
+        "source_directory" : "/home/source",
+        "destination_directory" : "/home/destination/",
+        "mode" : "copy",
+        "copy_workers" : "many"
+      }
+    ],
+    "log_directory" : "/github/dropclone/log/"
+  })";
+
+  create_temporary_json_file(json_config);
+
+  REQUIRE_THROWS_MATCHES(dc::nlohmann_json_parser{}(temp_config_path), dc::exception, 
+    Catch::Matchers::MessageMatches(Catch::Matchers::ContainsSubstring("config_error.010")));
+}
+
+TEST_CASE("parser throws if field 'io_uring' has invalid type", "[nlohmann_json_parser]") {
+  constexpr auto json_config = 
+  R"(
+  {
+    "clone_config" : [
+      {
+        "source_directory" : "/home/source",
+        "destination_directory" : "/home/destination/",
+        "mode" : "copy",
+        "io_uring" : "on"
+      }
+    ],
+    "log_directory" : "/github/dropclone/log/"
+  })";
+
+  create_temporary_json_file(json_config);
+
+  REQUIRE_THROWS_MATCHES(dc::nlohmann_json_parser{}(temp_config_path), dc::exception, 
+    Catch::Matchers::MessageMatches(Catch::Matchers::ContainsSubstring("config_error.010")));
+}
+
+TEST_CASE("parser throws if field 'update_mode' has invalid type", "[nlohmann_json_parser]") {
+  constexpr auto json_config = 
+  R"(
+  {
+    "clone_config" : [
+      {
+        "source_directory" : "/home/source",
+        "destination_directory" : "/home/destination/",
+        "mode" : "copy",
+        "update_mode" : 1
+      }
+    ],
+    "log_directory" : "/github/dropclone/log/"
+  })";
+
+  create_temporary_json_file(json_config);
+
+  REQUIRE_THROWS_MATCHES(dc::nlohmann_json_parser{}(temp_config_path), dc::exception, 
+    Catch::Matchers::MessageMatches(Catch::Matchers::ContainsSubstring("config_error.010")));
+}
+
+TEST_CASE("parser throws if field 'delta_min_size' has invalid type", "[nlohmann_json_parser]") {
+  constexpr auto json_config = 
+  R"(
+  {
+    "clone_config" : [
+      {
+        "source_directory" : "/home/source",
+        "destination_directory" : "/home/destination/",
+        "mode" : "copy",
+        "delta_min_size" : "1M"
+      }
+    ],
+    "log_directory" : "/github/dropclone/log/"
+  })";
+
+  create_temporary_json_file(json_config);
+
+  REQUIRE_THROWS_MATCHES(dc::nlohmann_json_parser{}(temp_config_path), dc::exception, 
+    Catch::Matchers::MessageMatches(Catch::Matchers::ContainsSubstring("config_error.010")));
+}
+
+TEST_CASE("parser throws if field 'compare' has invalid type", "[nlohmann_json_parser]") {
+  constexpr auto json_config = 
+  R"(
+  {
+    "clone_config" : [
+      {
+        "source_directory" : "/home/source",
+        "destination_directory" : "/home/destination/",
+        "mode" : "copy",
+        "compare" : 2
+      }
+    ],
+    "log_directory" : "/github/dropclone/log/"
+  })";
+
+  create_temporary_json_file(json_config);
+
+  REQUIRE_THROWS_MATCHES(dc::nlohmann_json_parser{}(temp_config_path), dc::exception, 
+    Catch::Matchers::MessageMatches(Catch::Matchers::ContainsSubstring("config_error.010")));
+}
+
+TEST_CASE("parser throws if field 'durability' has invalid type", "[nlohmann_json_parser]") {
+  constexpr auto json_config = 
+  R"(
+  {
+    "clone_config" : [
+      {
+        "source_directory" : "/home/source",
+        "destination_directory" : "/home/destination/",
+        "mode" : "copy",
+        "durability" : true
+      }
+    ],
+    "log_directory" : "/github/dropclone/log/"
+  })";
+
+  create_temporary_json_file(json_config);
+
+  REQUIRE_THROWS_MATCHES(dc::nlohmann_json_parser{}(temp_config_path), dc::exception, 
+    Catch::Matchers::MessageMatches(Catch::Matchers::ContainsSubstring("config_error.010")));
+}
+
+TEST_CASE("parser throws if field 'sync_interval_ms' has invalid type", "[nlohmann_json_parser]") {
+  constexpr auto json_config = 
+  R"(
+  {
+    "clone_config" : [
+      {
+        "source_directory" : "/home/source",
+        "destination_directory" : "/home/destination/",
+        "mode" : "copy",
+        "sync_interval_ms" : 0.5
+      }
+    ],
+    "log_directory" : "/github/dropclone/log/"
+  })";
+
+  create_temporary_json_file(json_config);
+
+  REQUIRE_THROWS_MATCHES(dc::nlohmann_json_parser{}(temp_config_path), dc::exception, 
+    Catch::Matchers::MessageMatches(Catch::Matchers::ContainsSubstring("config_error.010")));
+}
+
+TEST_CASE("parser reads the sync interval settings of an entry", "[nlohmann_json_parser]") {
+  constexpr auto json_config = 
+  R"(
+  {
+    "clone_config" : [
+      {
+        "source_directory" : "/home/source",
+        "destination_directory" : "/home/destination/",
+        "mode" : "copy",
+        "sync_interval_ms" : 500,
+        "max_sync_interval_ms" : 600000,
+        "interval_mode" : "adaptive"
+      }
+    ],
+    "log_directory" : "/github/dropclone/log/"
+  })";
+
+  create_temporary_json_file(json_config);
+
+  auto const config = dc::nlohmann_json_parser{}(temp_config_path);
+  REQUIRE(config.entries.front().sync_interval == std::chrono::milliseconds{500});
+  REQUIRE(config.entries.front().max_sync_interval == std::chrono::milliseconds{600'000});
+  REQUIRE(config.entries.front().interval_mode == dc::interval_mode::adaptive);
+}
+
+TEST_CASE("parser throws if field 'sync_log_format' has invalid type", "[nlohmann_json_parser]") {
+  constexpr auto json_config = 
+  R"(
+  {
+    "clone_config" : [
+      {
+        "source_directory" : "/home/source",
+        "destination_directory" : "/home/destination/",
+        "mode" : "copy"
+      }
+    ],
+    "log_directory" : "/github/dropclone/log/",
+    "sync_log_format" : 1
+  })";
+
+  create_temporary_json_file(json_config);
+
+  REQUIRE_THROWS_MATCHES(dc::nlohmann_json_parser{}(temp_config_path), dc::exception, 
+    Catch::Matchers::MessageMatches(Catch::Matchers::ContainsSubstring("config_error.010")));
+}
+
 TEST_CASE("parser passes if multiple entries are configured correctly", "[nlohmann_json_parser]") {
   constexpr auto json_config = 
   R"(
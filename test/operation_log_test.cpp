@@ -0,0 +1,118 @@
+#include <catch2/catch_test_macros.hpp>
+#include <dropclone/operation_log.hpp>
+#include <filesystem>
+#include <string>
+#include <cstdint>
+
+namespace fs = std::filesystem;
+namespace dc = dropclone;
+
+static fs::path const operation_log_root = fs::temp_directory_path() / fs::path{"dropclone_operation_log_test"};
+static fs::path const operation_log_path = operation_log_root / fs::path{"sync_log.bin"};
+
+using kind = dc::operation_record::kind;
+
+TEST_CASE("operation_log records strings by id and numbers as they are", "[operation_log]") {
+  fs::remove_all(operation_log_root);
+  fs::create_directories(operation_log_root);
+
+  {
+    dc::operation_log log{operation_log_path, 16};
+    log.record(3, 2, 2, std::string{"/src/a.txt"}, std::string{"/dst/a.txt"}, std::string{"copy_file_range"});
+    log.record(10, 2, 2, std::string{"/src/a.txt"}, std::string{"/dst/a.txt"}, std::size_t{4}, -1);
+  }
+
+  auto const log = dc::operation_log::read(operation_log_path);
+  REQUIRE(log.records.size() == 2);
+  CHECK(log.strings.size() == 3);
+
+  auto const& copied = log.records[0];
+  CHECK(copied.message == 3);
+  CHECK(copied.kinds[0] == kind::string);
+  CHECK(log.strings[copied.arguments[1]] == "/dst/a.txt");
+  CHECK(copied.kinds[3] == kind::none);
+
+  auto const& delta = log.records[1];
+  CHECK(delta.arguments[0] == copied.arguments[0]);
+  CHECK(delta.kinds[2] == kind::unsigned_number);
+  CHECK(delta.arguments[2] == 4);
+  CHECK(delta.kinds[3] == kind::signed_number);
+  CHECK(static_cast<std::int64_t>(delta.arguments[3]) == -1);
+
+  fs::remove_all(operation_log_root);
+}
+
+TEST_CASE("operation_log keeps the newest records once the ring is full", "[operation_log]") {
+  fs::remove_all(operation_log_root);
+  fs::create_directories(operation_log_root);
+
+  {
+    dc::operation_log log{operation_log_path, 4};
+    for (std::uint64_t record{0}; record != 6; ++record) { log.record(5, 2, 2, record); }
+  }
+  {
+    // reopening continues the ring and the string ids
+    dc::operation_log log{operation_log_path, 4};
+    log.record(5, 2, 2, std::uint64_t{6});
+  }
+
+  auto const log = dc::operation_log::read(operation_log_path);
+  REQUIRE(log.records.size() == 4);
+  for (std::uint64_t index{0}; index != 4; ++index) {
+    CHECK(log.records[index].arguments[0] == index + 3);
+    CHECK(log.records[index].sequence == index + 4);
+  }
+
+  fs::remove_all(operation_log_root);
+}
+
+TEST_CASE("operation_log starts over if the ring has another capacity", "[operation_log]") {
+  fs::remove_all(operation_log_root);
+  fs::create_directories(operation_log_root);
+
+  { dc::operation_log{operation_log_path, 4}.record(5, 2, 2, std::string{"/dst/a.txt"}); }
+  { dc::operation_log{operation_log_path, 8}.record(5, 2, 2, std::string{"/dst/b.txt"}); }
+
+  auto const log = dc::operation_log::read(operation_log_path);
+  REQUIRE(log.records.size() == 1);
+  CHECK(log.strings[log.records[0].arguments[0]] == "/dst/b.txt");
+  CHECK(log.strings.size() == 1);
+
+  fs::remove_all(operation_log_root);
+}
+
+TEST_CASE("operation_log drops the string table of overwritten records", "[operation_log]") {
+  fs::remove_all(operation_log_root);
+  fs::create_directories(operation_log_root);
+
+  auto const table_size = [] {
+    return fs::file_size(dc::operation_log::strings_path(operation_log_path, 0)) +
+           fs::file_size(dc::operation_log::strings_path(operation_log_path, 1));
+  };
+
+  {
+    dc::operation_log log{operation_log_path, 4};
+    for (int record{0}; record != 100; ++record) {
+      log.record(5, 2, 2, "/dst/" + std::to_string(record) + ".txt", std::string{"/src"});
+    }
+    // two tables of at most a ring's worth of strings and "/src" each, every
+    // string with its length and at most 12 bytes
+    CHECK(table_size() <= 2 * (16 + (4 + 1) * (4 + 12)));
+  }
+  {
+    // reopening continues the current table
+    dc::operation_log log{operation_log_path, 4};
+    log.record(5, 2, 2, std::string{"/dst/100.txt"}, std::string{"/src"});
+  }
+
+  auto const log = dc::operation_log::read(operation_log_path);
+  REQUIRE(log.records.size() == 4);
+  for (std::size_t index{0}; index != 4; ++index) {
+    auto const& record = log.records[index];
+    REQUIRE(record.arguments[0] < log.strings.size());
+    CHECK(log.strings[record.arguments[0]] == "/dst/" + std::to_string(97 + index) + ".txt");
+    CHECK(log.strings[record.arguments[1]] == "/src");
+  }
+
+  fs::remove_all(operation_log_root);
+}
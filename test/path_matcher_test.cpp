@@ -0,0 +1,83 @@
+#include <catch2/catch_test_macros.hpp>
+#include <dropclone/path_matcher.hpp>
+#include <regex>
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace dc = dropclone;
+
+TEST_CASE("path_matcher agrees with std::regex_search", "[path_matcher]") {
+  std::vector<std::string> const patterns{
+    "cpp\\.txt$", "[-.\\w]+\\.pdf$", "^build/", "node_modules", "\\.(o|obj|a)$",
+    "^docs/[^/]+\\.md$", "a{2,3}b", "x[0-9]{2}y?", "^$", "(?:tmp|cache)/", "[^a-z]z",
+    "\\d+\\s", "Report.*2024", "^\\w+$", "[\\x41-\\x43]q", "\\u0041\\.", "(ab)*c$",
+    "\\b", "(a)\\1", "(?=x)y"
+  };
+  std::vector<std::string> const paths{
+    "", "cpp.txt", "src/CPP.TXT", "books/c++.pdf", "books/my book.PDF", "build/x.o", "src/build/x",
+    "web/node_modules/react", "NODE_MODULES", "lib.a", "lib.ab", "docs/readme.md", "docs/a/readme.md",
+    "aab", "AAAB", "ab", "x12", "x1y", "x99y", "tmp/", "src/cache/", "1z", "az", "12 3", "12",
+    "report_final_2024.txt", "word", "two words", "Aq", "dq", "A.", "ababc", "abab", "aa", "xy"
+  };
+
+  for (auto const& pattern : patterns) {
+    dc::path_matcher const matcher{{pattern}};
+    std::regex const regex{pattern, std::regex::ECMAScript | std::regex_constants::icase};
+    for (auto const& path : paths) {
+      INFO("pattern: " << pattern << ", path: " << path);
+      CHECK(matcher.matches(path) == std::regex_search(path, regex));
+    }
+  }
+
+  // all patterns at once match if any single one does
+  dc::path_matcher const combined{patterns};
+  for (auto const& path : paths) {
+    bool const any = std::any_of(std::begin(patterns), std::end(patterns), [&](auto const& pattern) {
+      return std::regex_search(path, std::regex{pattern, std::regex::ECMAScript | std::regex_constants::icase});
+    });
+    INFO("path: " << path);
+    CHECK(combined.matches(path) == any);
+  }
+}
+
+TEST_CASE("path_matcher matches gitignore-style globs", "[path_matcher][glob]") {
+  dc::path_matcher const matcher{{"glob:*.pdf", "glob:/build/", "glob:docs/**/draft?.md", "glob:**/cache", "glob:[!a-c]x"}};
+
+  CHECK(matcher.matches("scan.pdf"));
+  CHECK(matcher.matches("inbox/Scan.PDF"));
+  CHECK(matcher.matches("scan.pdf/page1.png"));
+  CHECK_FALSE(matcher.matches("scan.pdf.txt"));
+  CHECK(matcher.matches("build/a.o"));
+  CHECK(matcher.matches("build"));
+  CHECK_FALSE(matcher.matches("src/build/a.o"));
+  CHECK(matcher.matches("docs/draft1.md"));
+  CHECK(matcher.matches("docs/a/b/draft2.md"));
+  CHECK_FALSE(matcher.matches("docs/a/draft10.md"));
+  CHECK(matcher.matches("cache"));
+  CHECK(matcher.matches("a/b/cache/file"));
+  CHECK_FALSE(matcher.matches("a/cached"));
+  CHECK(matcher.matches("dx"));
+  CHECK_FALSE(matcher.matches("bx"));
+
+  CHECK(dc::path_matcher::glob_to_regex("*.pdf") == "(^|/)[^/]*\\.pdf(/|$)");
+  CHECK(dc::path_matcher::glob_to_regex("/build/") == "^build(/|$)");
+}
+
+TEST_CASE("path_matcher glob classes never match the component separator", "[path_matcher][glob]") {
+  dc::path_matcher const matcher{{"glob:a[x/]b", "glob:c[!x]d", "glob:e[.-0]f", "glob:g[/]h"}};
+
+  CHECK(matcher.matches("axb"));
+  CHECK_FALSE(matcher.matches("a/b"));
+  CHECK(matcher.matches("cyd"));
+  CHECK_FALSE(matcher.matches("c/d"));
+  CHECK(matcher.matches("e.f"));
+  CHECK(matcher.matches("e0f"));
+  CHECK_FALSE(matcher.matches("e/f"));
+  CHECK_FALSE(matcher.matches("g/h"));
+
+  CHECK(dc::path_matcher::glob_to_regex("a[x/]b") == "^a[x]b(/|$)");
+  CHECK(dc::path_matcher::glob_to_regex("c[!x]d") == "(^|/)c[^x/]d(/|$)");
+  CHECK(dc::path_matcher::glob_to_regex("e[.-0]f") == "(^|/)e[.0]f(/|$)");
+}
@@ -0,0 +1,291 @@
+#include <catch2/catch_test_macros.hpp>
+#include <dropclone/path_snapshot.hpp>
+#include <dropclone/clone_config.hpp>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+namespace dc = dropclone;
+
+static fs::path const snapshot_root = fs::temp_directory_path() / fs::path{"dropclone_snapshot_test"};
+
+static auto create_test_tree(fs::path const& root) -> void {
+  fs::remove_all(root);
+  for (auto directory : {"a", "b", "c"}) {
+    for (auto subdirectory : {"x", "y"}) {
+      auto const path = root / directory / subdirectory / "z";
+      fs::create_directories(path);
+      for (auto file : {"1.txt", "2.pdf", "3.bin"}) {
+        std::ofstream{path.parent_path() / file} << directory << subdirectory << file;
+        std::ofstream{path / file} << file;
+      }
+    }
+  }
+  fs::create_directories(root / "empty");
+}
+
+static auto accept_all = [](fs::path const&) { return true; };
+
+TEST_CASE("make with multiple threads produces the same snapshot as the serial scan", "[path_snapshot][make]") {
+  create_test_tree(snapshot_root);
+
+  dc::path_snapshot serial_snapshot{snapshot_root};
+  serial_snapshot.make(accept_all);
+
+  dc::path_snapshot parallel_snapshot{snapshot_root};
+  parallel_snapshot.make(accept_all, 4);
+
+  CHECK(serial_snapshot.entries().size() == 52);
+  CHECK(parallel_snapshot.entries() == serial_snapshot.entries());
+  CHECK(parallel_snapshot.hash() == serial_snapshot.hash());
+
+  fs::remove_all(snapshot_root);
+}
+
+TEST_CASE("make reports an unreadable directory like the serial scan", "[path_snapshot][make]") {
+  create_test_tree(snapshot_root);
+  auto const unreadable = snapshot_root / "a" / "x";
+  fs::permissions(unreadable, fs::perms::none);
+  // root reads the directory anyway; then there is nothing to report
+  bool const denied = ::access(unreadable.c_str(), R_OK) != 0;
+
+  dc::path_snapshot serial_snapshot{snapshot_root};
+  REQUIRE_NOTHROW(serial_snapshot.make(accept_all));
+
+  dc::path_snapshot parallel_snapshot{snapshot_root};
+  REQUIRE_NOTHROW(parallel_snapshot.make(accept_all, 4));
+
+  CHECK(parallel_snapshot.entries() == serial_snapshot.entries());
+  CHECK(parallel_snapshot.conflicts() == serial_snapshot.conflicts());
+  CHECK(parallel_snapshot.hash() == serial_snapshot.hash());
+
+  // a watch cycle that rescans the subtree above it
+  dc::path_changes const changes{{fs::path{"a/x"}, false}, {fs::path{"a"}, true}};
+  dc::path_snapshot changed_snapshot{snapshot_root};
+  REQUIRE_NOTHROW(changed_snapshot.make(changes, accept_all));
+
+  CHECK(changed_snapshot.entries() == serial_snapshot.extract(changes).entries());
+  CHECK(changed_snapshot.conflicts() == serial_snapshot.conflicts());
+
+  if (denied) {
+    CHECK(serial_snapshot.conflicts().size() == 1);
+    CHECK(serial_snapshot.conflicts().contains(fs::path{"a/x"}));
+    CHECK(serial_snapshot.entries().contains(fs::path{"a"}));
+    CHECK_FALSE(serial_snapshot.entries().contains(fs::path{"a/x"}));
+  }
+
+  fs::permissions(unreadable, fs::perms::owner_all);
+  fs::remove_all(snapshot_root);
+}
+
+TEST_CASE("make with multiple threads applies the path filter like the serial scan", "[path_snapshot][make]") {
+  create_test_tree(snapshot_root);
+
+  auto const skip_pdf = [](fs::path const& path) { return path.extension() != ".pdf"; };
+
+  dc::path_snapshot serial_snapshot{snapshot_root};
+  serial_snapshot.make(skip_pdf);
+
+  dc::path_snapshot parallel_snapshot{snapshot_root};
+  parallel_snapshot.make(skip_pdf, 3);
+
+  CHECK(parallel_snapshot.entries() == serial_snapshot.entries());
+  CHECK(parallel_snapshot.hash() == serial_snapshot.hash());
+
+  fs::remove_all(snapshot_root);
+}
+
+TEST_CASE("make prunes excluded subtrees without changing the snapshot", "[path_snapshot][make]") {
+  create_test_tree(snapshot_root);
+
+  dc::config_entry::raw_patterns_type exclude_patterns{"^b/", "x/z/", "\\.pdf$"};
+  dc::config_entry::raw_patterns_type include_patterns{};
+  dc::config_entry entry{snapshot_root, snapshot_root / "copy", dc::clone_mode::copy, 
+                         exclude_patterns, include_patterns};
+
+  auto const filter = [&](fs::path const& path) { return entry.filter(path); };
+  auto const prune = [&](fs::path const& path) { return entry.prune(path); };
+
+  dc::path_snapshot filtered_snapshot{snapshot_root};
+  filtered_snapshot.make(filter);
+
+  dc::path_snapshot serial_snapshot{snapshot_root};
+  serial_snapshot.make(filter, 1, prune);
+
+  dc::path_snapshot parallel_snapshot{snapshot_root};
+  parallel_snapshot.make(filter, 3, prune);
+
+  // 'b', 'a/x/z' and 'c/x/z' are kept as directories, their content is skipped
+  CHECK(filtered_snapshot.pruned() == 0);
+  CHECK(serial_snapshot.pruned() == 3);
+  CHECK(parallel_snapshot.pruned() == 3);
+  CHECK(serial_snapshot.entries().contains("b"));
+  CHECK(serial_snapshot.entries() == filtered_snapshot.entries());
+  CHECK(parallel_snapshot.entries() == filtered_snapshot.entries());
+
+  dc::path_snapshot changed_snapshot{snapshot_root};
+  changed_snapshot.make(dc::path_changes{{fs::path{"b"}, true}, {fs::path{"a"}, true}}, filter, prune);
+  CHECK(changed_snapshot.pruned() == 2);
+  CHECK(changed_snapshot.entries().contains("a/x/z"));
+  CHECK_FALSE(changed_snapshot.entries().contains("a/x/z/1.txt"));
+
+  fs::remove_all(snapshot_root);
+}
+
+TEST_CASE("make with path changes updates the snapshot like a full rescan", "[path_snapshot][make]") {
+  create_test_tree(snapshot_root);
+
+  dc::path_snapshot committed_snapshot{snapshot_root};
+  committed_snapshot.make(accept_all);
+
+  fs::remove_all(snapshot_root / "a" / "x");
+  fs::rename(snapshot_root / "b" / "y", snapshot_root / "c" / "w");
+  std::ofstream{snapshot_root / "empty" / "new.txt"} << "new";
+
+  dc::path_changes const changes{
+    {fs::path{"a"}, false}, {fs::path{"a/x"}, true},
+    {fs::path{"b"}, false}, {fs::path{"b/y"}, true},
+    {fs::path{"c"}, false}, {fs::path{"c/w"}, true},
+    {fs::path{"empty"}, false}, {fs::path{"empty/new.txt"}, false}
+  };
+
+  auto const previous_snapshot = committed_snapshot.extract(changes);
+  dc::path_snapshot current_snapshot{snapshot_root};
+  current_snapshot.make(changes, accept_all);
+  committed_snapshot.update(previous_snapshot, current_snapshot);
+
+  dc::path_snapshot rescanned_snapshot{snapshot_root};
+  rescanned_snapshot.make(accept_all);
+
+  CHECK(committed_snapshot.entries() == rescanned_snapshot.entries());
+  CHECK(committed_snapshot.hash() == rescanned_snapshot.hash());
+
+  fs::remove_all(snapshot_root);
+}
+
+TEST_CASE("hash includes entry names and localises changes to their subtree", "[path_snapshot][hash]") {
+  auto const file_info = [](uintmax_t size) {
+    dc::path_info info{};
+    info.file_size = size;
+    info.file_perms = fs::perms::owner_read;
+    return info;
+  };
+  dc::path_info directory_info{};
+  directory_info.is_directory = true;
+
+  dc::path_snapshot::snapshot_entries const entries{
+    {fs::path{"a"}, directory_info}, {fs::path{"a/1.txt"}, file_info(1)}, {fs::path{"a/2.txt"}, file_info(2)},
+    {fs::path{"b"}, directory_info}, {fs::path{"b/3.txt"}, file_info(3)}
+  };
+  dc::path_snapshot const snapshot{snapshot_root, entries};
+
+  auto renamed_entries = entries;
+  renamed_entries.erase(fs::path{"a/2.txt"});
+  renamed_entries.emplace(fs::path{"a/4.txt"}, file_info(2));
+  dc::path_snapshot const renamed_snapshot{snapshot_root, renamed_entries};
+
+  auto swapped_entries = entries;
+  swapped_entries[fs::path{"a/1.txt"}] = file_info(2);
+  swapped_entries[fs::path{"a/2.txt"}] = file_info(1);
+  dc::path_snapshot const swapped_snapshot{snapshot_root, swapped_entries};
+
+  CHECK(renamed_snapshot.hash() != snapshot.hash());
+  CHECK(swapped_snapshot.hash() != snapshot.hash());
+  CHECK(renamed_snapshot.directory_hash(fs::path{"a"}) != snapshot.directory_hash(fs::path{"a"}));
+  CHECK(renamed_snapshot.directory_hash(fs::path{"b"}) == snapshot.directory_hash(fs::path{"b"}));
+}
+
+TEST_CASE("update rehashes the changed paths to the hash of a fresh snapshot", "[path_snapshot][hash]") {
+  auto const file_info = [](uintmax_t size) {
+    dc::path_info info{};
+    info.file_size = size;
+    info.file_perms = fs::perms::owner_read;
+    return info;
+  };
+  dc::path_info directory_info{};
+  directory_info.is_directory = true;
+
+  dc::path_snapshot::snapshot_entries entries{
+    {fs::path{"a"}, directory_info}, {fs::path{"a/1.txt"}, file_info(1)},
+    {fs::path{"a/b"}, directory_info}, {fs::path{"a/b/2.txt"}, file_info(2)},
+    {fs::path{"c"}, directory_info}, {fs::path{"c/3.txt"}, file_info(3)}
+  };
+  dc::path_snapshot snapshot{snapshot_root, entries};
+
+  auto const apply = [&](dc::path_changes const& changes) {
+    dc::path_snapshot const current_snapshot{snapshot_root, entries};
+    snapshot.update(snapshot.extract(changes), current_snapshot.extract(changes));
+
+    CHECK(snapshot.entries() == current_snapshot.entries());
+    CHECK(snapshot.hash() == current_snapshot.hash());
+    for (auto const& directory : {fs::path{"a"}, fs::path{"a/b"}, fs::path{"a/b/x"}, fs::path{"c"}}) {
+      CHECK(snapshot.directory_hash(directory) == current_snapshot.directory_hash(directory));
+    }
+  };
+
+  // 'a/b' is left without entries below it
+  entries.erase(fs::path{"a/b/2.txt"});
+  apply(dc::path_changes{{fs::path{"a/b"}, true}});
+
+  entries.emplace(fs::path{"a/b/x/y/4.txt"}, file_info(4));
+  entries[fs::path{"c/3.txt"}] = file_info(5);
+  apply(dc::path_changes{{fs::path{"a/b"}, true}, {fs::path{"c/3.txt"}, false}});
+
+  std::erase_if(entries, [](auto const& entry) { return *entry.first.begin() == "a"; });
+  apply(dc::path_changes{{fs::path{"a"}, true}});
+}
+
+TEST_CASE("local_diff reports changes below unchanged and changed subtrees", "[path_snapshot][local_diff]") {
+  create_test_tree(snapshot_root);
+
+  dc::path_snapshot previous_snapshot{snapshot_root};
+  previous_snapshot.make(accept_all);
+
+  std::ofstream{snapshot_root / "a" / "x" / "z" / "1.txt"} << "modified content";
+  fs::remove(snapshot_root / "c" / "y" / "2.pdf");
+
+  dc::path_snapshot current_snapshot{snapshot_root};
+  current_snapshot.make(accept_all);
+
+  CHECK(current_snapshot.directory_hash(fs::path{"b"}) == previous_snapshot.directory_hash(fs::path{"b"}));
+  CHECK(current_snapshot.directory_hash(fs::path{"a"}) != previous_snapshot.directory_hash(fs::path{"a"}));
+
+  auto const added_or_updated = current_snapshot.local_diff(previous_snapshot);
+  CHECK(added_or_updated.files().size() == 1);
+  CHECK(added_or_updated.files().contains(fs::path{"a/x/z/1.txt"}));
+
+  auto const deleted = previous_snapshot.local_diff(current_snapshot);
+  CHECK(deleted.files().contains(fs::path{"c/y/2.pdf"}));
+  CHECK(deleted.files().at(fs::path{"c/y/2.pdf"}).path_status == dc::path_info::status::deleted);
+
+  fs::remove_all(snapshot_root);
+}
+
+TEST_CASE("local_diff marks directories without relevant changes as structurally required", "[path_snapshot][local_diff]") {
+  fs::remove_all(snapshot_root);
+  fs::create_directories(snapshot_root / "a" / "b");
+  fs::create_directories(snapshot_root / "ab");
+  fs::create_directories(snapshot_root / "c");
+  std::ofstream{snapshot_root / "a" / "old.txt"} << "old";
+
+  dc::path_snapshot previous_snapshot{snapshot_root};
+  previous_snapshot.make(accept_all);
+
+  fs::remove(snapshot_root / "a" / "old.txt");
+  std::ofstream{snapshot_root / "ab" / "new.txt"} << "new";
+  std::ofstream{snapshot_root / "c" / "new.txt"} << "new";
+
+  dc::path_snapshot current_snapshot{snapshot_root};
+  current_snapshot.make(accept_all);
+
+  auto const diff = current_snapshot.local_diff(previous_snapshot);
+  REQUIRE(diff.directories().contains(fs::path{"a"}));
+  // 'ab/new.txt' shares the string prefix of 'a' but is not inside it
+  CHECK(diff.directories().at(fs::path{"a"}).path_status == dc::path_info::status::structurally_required);
+  CHECK(diff.directories().at(fs::path{"ab"}).path_status == dc::path_info::status::updated);
+  CHECK(diff.directories().at(fs::path{"c"}).path_status == dc::path_info::status::updated);
+
+  fs::remove_all(snapshot_root);
+}
@@ -0,0 +1,47 @@
+#include <catch2/catch_test_macros.hpp>
+#include <dropclone/path_table.hpp>
+#include <filesystem>
+#include <string>
+#include <set>
+
+namespace fs = std::filesystem;
+namespace dc = dropclone;
+
+TEST_CASE("path_table interns every component once", "[path_table]") {
+  dc::path_table paths{};
+
+  auto const file = paths.insert(fs::path{"a/b/file.txt"});
+  auto const directory = paths.find(fs::path{"a/b"});
+  REQUIRE(directory != dc::path_table::npos);
+  CHECK(paths.size() == 4);
+  CHECK(paths.insert(fs::path{"a/b/file.txt"}) == file);
+  CHECK(paths.parent(file) == directory);
+  CHECK(paths.name(file) == "file.txt");
+  CHECK(paths.path(file) == fs::path{"a/b/file.txt"});
+  CHECK(paths.find(fs::path{}) == dc::path_table::root);
+  CHECK(paths.path(dc::path_table::root).empty());
+  CHECK(paths.find(fs::path{"a/c"}) == dc::path_table::npos);
+  CHECK(paths.find_child(directory, "file.txt") == file);
+
+  paths.insert(fs::path{"a/b/other.txt"});
+  std::set<std::string> children{};
+  for (auto child = paths.first_child(directory); child != dc::path_table::npos; child = paths.next_sibling(child)) {
+    children.emplace(paths.name(child));
+  }
+  CHECK(children == std::set<std::string>{"file.txt", "other.txt"});
+}
+
+TEST_CASE("path_table keeps lookups working while it grows", "[path_table]") {
+  dc::path_table paths{};
+  for (auto index{0}; index != 5000; ++index) {
+    paths.insert(fs::path{"directory_" + std::to_string(index % 50)} / ("file_" + std::to_string(index)));
+  }
+
+  CHECK(paths.size() == 5051);
+  for (auto index{0}; index < 5000; index += 7) {
+    auto const path = fs::path{"directory_" + std::to_string(index % 50)} / ("file_" + std::to_string(index));
+    auto const found = paths.find(path);
+    REQUIRE(found != dc::path_table::npos);
+    CHECK(paths.path(found) == path);
+  }
+}
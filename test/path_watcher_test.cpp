@@ -0,0 +1,58 @@
+#include <catch2/catch_test_macros.hpp>
+#include <dropclone/path_watcher.hpp>
+#include <dropclone/path_snapshot.hpp>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+namespace fs = std::filesystem;
+namespace dc = dropclone;
+
+static fs::path const watch_root = fs::temp_directory_path() / fs::path{"dropclone_watch_test"};
+
+static auto contains_change(dc::path_changes const& changes, fs::path const& path, bool subtree) -> bool {
+  return std::ranges::any_of(changes, [&](auto const& change) {
+    return change.path == path && change.subtree == subtree;
+  });
+}
+
+TEST_CASE("poll reports created, modified and deleted paths relative to the root", "[path_watcher]") {
+  fs::remove_all(watch_root);
+  fs::create_directories(watch_root / "books");
+  std::ofstream{watch_root / "books" / "old.pdf"} << "old";
+
+  dc::path_watcher watcher{watch_root};
+  REQUIRE(watcher.is_active());
+
+  std::ofstream{watch_root / "books" / "new.pdf"} << "new";
+  fs::remove(watch_root / "books" / "old.pdf");
+
+  auto const poll_result = watcher.poll();
+  REQUIRE_FALSE(poll_result.overflow);
+  CHECK(contains_change(poll_result.changes, "books/new.pdf", false));
+  CHECK(contains_change(poll_result.changes, "books/old.pdf", false));
+  CHECK(contains_change(poll_result.changes, "books", false));
+
+  fs::remove_all(watch_root);
+}
+
+TEST_CASE("poll rescans directories created with content and watches them", "[path_watcher]") {
+  fs::remove_all(watch_root);
+  fs::create_directories(watch_root / "inbox");
+  fs::create_directories(watch_root.parent_path() / "dropclone_watch_outside" / "nested");
+
+  dc::path_watcher watcher{watch_root};
+  REQUIRE(watcher.is_active());
+
+  fs::rename(watch_root.parent_path() / "dropclone_watch_outside", watch_root / "inbox" / "moved");
+  auto poll_result = watcher.poll();
+  REQUIRE_FALSE(poll_result.overflow);
+  CHECK(contains_change(poll_result.changes, "inbox/moved", true));
+
+  std::ofstream{watch_root / "inbox" / "moved" / "nested" / "file.txt"} << "content";
+  poll_result = watcher.poll();
+  REQUIRE_FALSE(poll_result.overflow);
+  CHECK(contains_change(poll_result.changes, "inbox/moved/nested/file.txt", false));
+
+  fs::remove_all(watch_root);
+}
@@ -0,0 +1,65 @@
+#include <catch2/catch_test_macros.hpp>
+#include <dropclone/snapshot_index.hpp>
+#include <dropclone/path_snapshot.hpp>
+#include <filesystem>
+#include <fstream>
+
+namespace fs = std::filesystem;
+namespace dc = dropclone;
+
+static fs::path const index_test_root = fs::temp_directory_path() / fs::path{"dropclone_index_test"};
+static fs::path const index_source = index_test_root / fs::path{"source"};
+static fs::path const index_directory = index_test_root / fs::path{"index"};
+
+static auto create_index_test_tree() -> void {
+  fs::remove_all(index_test_root);
+  fs::create_directories(index_source / "books" / "cpp");
+  fs::create_directories(index_directory);
+  std::ofstream{index_source / "books" / "cpp" / "concurrency.pdf"} << "concurrency";
+  std::ofstream{index_source / "books" / "templates.pdf"} << "templates";
+  std::ofstream{index_source / "notes.txt"} << "notes";
+}
+
+static auto accept_all = [](fs::path const&) { return true; };
+
+TEST_CASE("load restores a stored snapshot with identical entries and hash", "[snapshot_index]") {
+  create_index_test_tree();
+
+  dc::path_snapshot snapshot{index_source};
+  snapshot.make(accept_all);
+
+  dc::snapshot_index index{index_directory / "entry.idx"};
+  REQUIRE(index.store(snapshot));
+
+  auto const loaded = index.load(index_source);
+  REQUIRE(loaded.has_value());
+  CHECK(loaded->entries() == snapshot.entries());
+  CHECK(loaded->hash() == snapshot.hash());
+
+  fs::remove_all(index_test_root);
+}
+
+TEST_CASE("load falls back if the index is missing, corrupt or stale", "[snapshot_index]") {
+  create_index_test_tree();
+
+  dc::path_snapshot snapshot{index_source};
+  snapshot.make(accept_all);
+
+  dc::snapshot_index index{index_directory / "entry.idx"};
+  CHECK_FALSE(index.load(index_source).has_value());
+
+  REQUIRE(index.store(snapshot));
+  CHECK_FALSE(index.load(index_test_root / "other").has_value());
+
+  {
+    std::fstream index_stream{index.path(), std::ios::in | std::ios::out | std::ios::binary};
+    index_stream.seekp(-1, std::ios::end);
+    index_stream.put('\x7f');
+  }
+  CHECK_FALSE(index.load(index_source).has_value());
+
+  fs::resize_file(index.path(), 10);
+  CHECK_FALSE(index.load(index_source).has_value());
+
+  fs::remove_all(index_test_root);
+}
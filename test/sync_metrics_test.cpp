@@ -0,0 +1,80 @@
+#include <catch2/catch_test_macros.hpp>
+#include <dropclone/sync_metrics.hpp>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+#include <chrono>
+
+namespace fs = std::filesystem;
+namespace dc = dropclone;
+namespace chr = std::chrono;
+
+static fs::path const metrics_root = fs::temp_directory_path() / fs::path{"dropclone_sync_metrics_test"};
+
+using counter = dc::sync_metrics::counter;
+using histogram = dc::sync_metrics::histogram;
+
+TEST_CASE("sync_metrics sums the counters of all threads", "[sync_metrics]") {
+  dc::sync_metrics metrics{};
+
+  std::vector<std::jthread> threads{};
+  for (int thread{0}; thread != 8; ++thread) {
+    threads.emplace_back([&] {
+      for (int file{0}; file != 1000; ++file) { metrics.add(counter::files_copied); }
+      metrics.add(counter::bytes_copied, 4096);
+    });
+  }
+  threads.clear();
+
+  auto const values = metrics.snapshot();
+  CHECK(values.counters[static_cast<std::size_t>(counter::files_copied)] == 8000);
+  CHECK(values.counters[static_cast<std::size_t>(counter::bytes_copied)] == 8 * 4096);
+  CHECK(values.counters[static_cast<std::size_t>(counter::rollbacks)] == 0);
+}
+
+TEST_CASE("sync_metrics sorts durations into their buckets", "[sync_metrics]") {
+  dc::sync_metrics metrics{};
+  metrics.observe(histogram::scan, chr::microseconds{50});
+  metrics.observe(histogram::scan, chr::milliseconds{1});
+  metrics.observe(histogram::scan, chr::minutes{10});
+
+  auto const scan = metrics.snapshot().histograms[static_cast<std::size_t>(histogram::scan)];
+  CHECK(scan.count == 3);
+  CHECK(scan.buckets[0] == 1);                                   // <= 100us
+  CHECK(scan.buckets[2] == 1);                                   // <= 1ms
+  CHECK(scan.buckets[dc::sync_metrics::bucket_count - 1] == 1);  // +Inf
+  CHECK(scan.sum == chr::microseconds{50} + chr::milliseconds{1} + chr::minutes{10});
+}
+
+TEST_CASE("sync_metrics maps commands to their execute and undo histograms", "[sync_metrics]") {
+  CHECK(dc::sync_metrics::command_histogram("copy_command", false) == histogram::copy_execute);
+  CHECK(dc::sync_metrics::command_histogram("update_command", false) == histogram::update_execute);
+  CHECK(dc::sync_metrics::command_histogram("remove_command", true) == histogram::remove_undo);
+  CHECK(dc::sync_metrics::command_histogram("delta_command", true) == histogram::delta_undo);
+}
+
+TEST_CASE("export_metrics writes a Prometheus textfile", "[sync_metrics]") {
+  fs::remove_all(metrics_root);
+  fs::create_directories(metrics_root);
+  auto const path = metrics_root / "dropclone.prom";
+
+  dc::sync_metrics metrics{};
+  metrics.add(counter::syncs, 2);
+  metrics.observe(histogram::copy_execute, chr::milliseconds{3});
+
+  dc::export_metrics(path, {{"/home/\"source\"", &metrics}});
+
+  std::ifstream file{path};
+  std::string const content{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+  CHECK(content.find("# TYPE dropclone_syncs_total counter") != std::string::npos);
+  CHECK(content.find("dropclone_syncs_total{entry=\"/home/\\\"source\\\"\"} 2") != std::string::npos);
+  CHECK(content.find("phase=\"execute\",command=\"copy_command\",le=\"0.005\"} 1") != std::string::npos);
+  CHECK(content.find("phase=\"execute\",command=\"copy_command\",le=\"0.001\"} 0") != std::string::npos);
+  CHECK(content.find("dropclone_commit_lag_seconds_count{entry=") != std::string::npos);
+  CHECK_FALSE(fs::exists(metrics_root / "dropclone.prom.tmp"));
+
+  fs::remove_all(metrics_root);
+}
@@ -0,0 +1,101 @@
+#include <catch2/catch_test_macros.hpp>
+#include <dropclone/sync_scheduler.hpp>
+#include <dropclone/clone_config.hpp>
+#include <filesystem>
+#include <chrono>
+#include <vector>
+
+namespace fs = std::filesystem;
+namespace chr = std::chrono;
+namespace dc = dropclone;
+
+static auto make_scheduler_entry(chr::milliseconds interval, dc::interval_mode mode,
+                                 chr::milliseconds max_interval = chr::milliseconds{0}) -> dc::config_entry {
+  dc::config_entry entry{fs::path{"/dropclone/source/"}, fs::path{"/dropclone/destination/"}, dc::clone_mode::copy};
+  entry.sync_interval = interval;
+  entry.max_sync_interval = max_interval;
+  entry.interval_mode = mode;
+  entry.sanitize();
+  return entry;
+}
+
+TEST_CASE("sync_scheduler starts every entry within its first interval", "[sync_scheduler]") {
+  std::vector<dc::config_entry> entries{};
+  for (int entry{0}; entry != 50; ++entry) {
+    entries.push_back(make_scheduler_entry(chr::milliseconds{1000}, dc::interval_mode::fixed));
+  }
+  auto const now = dc::sync_scheduler::clock::now();
+  dc::sync_scheduler scheduler{entries, now, 42};
+
+  REQUIRE(scheduler.next_due() >= now);
+  REQUIRE(scheduler.due(now + chr::milliseconds{1000}).size() == entries.size());
+  // jittered: the entries do not all start at the same moment
+  REQUIRE(scheduler.due(now + chr::milliseconds{500}).size() < entries.size());
+}
+
+TEST_CASE("sync_scheduler starts entries with long intervals within a few seconds", "[sync_scheduler]") {
+  std::vector<dc::config_entry> entries{};
+  for (int entry{0}; entry != 50; ++entry) {
+    entries.push_back(make_scheduler_entry(chr::milliseconds{3'600'000}, dc::interval_mode::fixed));
+  }
+  auto const now = dc::sync_scheduler::clock::now();
+  dc::sync_scheduler scheduler{entries, now, 42};
+
+  REQUIRE(scheduler.due(now + chr::seconds{5}).size() == entries.size());
+  REQUIRE(scheduler.due(now + chr::milliseconds{2500}).size() < entries.size());
+
+  // later cycles keep the full interval
+  scheduler.completed(0, false, now);
+  REQUIRE(scheduler.due(now + chr::minutes{50}).size() == entries.size() - 1);
+}
+
+TEST_CASE("sync_scheduler keeps a fixed interval", "[sync_scheduler]") {
+  std::vector<dc::config_entry> entries{make_scheduler_entry(chr::milliseconds{1000}, dc::interval_mode::fixed)};
+  auto const now = dc::sync_scheduler::clock::now();
+  dc::sync_scheduler scheduler{entries, now, 42};
+
+  for (int cycle{0}; cycle != 5; ++cycle) {
+    scheduler.completed(0, false, now);
+    REQUIRE(scheduler.interval(0) == chr::milliseconds{1000});
+  }
+
+  REQUIRE(scheduler.due(now + chr::milliseconds{899}).empty());
+  REQUIRE(scheduler.due(now + chr::milliseconds{1100}).size() == 1);
+}
+
+TEST_CASE("sync_scheduler backs off idle adaptive entries up to the cap", "[sync_scheduler]") {
+  std::vector<dc::config_entry> entries{
+    make_scheduler_entry(chr::milliseconds{500}, dc::interval_mode::adaptive, chr::milliseconds{3000})
+  };
+  auto const now = dc::sync_scheduler::clock::now();
+  dc::sync_scheduler scheduler{entries, now, 42};
+
+  scheduler.completed(0, false, now);
+  REQUIRE(scheduler.interval(0) == chr::milliseconds{1000});
+  scheduler.completed(0, false, now);
+  REQUIRE(scheduler.interval(0) == chr::milliseconds{2000});
+  scheduler.completed(0, false, now);
+  REQUIRE(scheduler.interval(0) == chr::milliseconds{3000});
+  scheduler.completed(0, false, now);
+  REQUIRE(scheduler.interval(0) == chr::milliseconds{3000});
+
+  scheduler.completed(0, true, now);
+  REQUIRE(scheduler.interval(0) == chr::milliseconds{500});
+  REQUIRE(scheduler.due(now + chr::milliseconds{550}).size() == 1);
+}
+
+TEST_CASE("sync_scheduler makes a triggered entry due at once", "[sync_scheduler]") {
+  std::vector<dc::config_entry> entries{
+    make_scheduler_entry(chr::milliseconds{60'000}, dc::interval_mode::fixed),
+    make_scheduler_entry(chr::milliseconds{60'000}, dc::interval_mode::fixed)
+  };
+  auto const now = dc::sync_scheduler::clock::now();
+  dc::sync_scheduler scheduler{entries, now, 42};
+  scheduler.completed(0, false, now);
+  scheduler.completed(1, false, now);
+
+  scheduler.trigger(1, now);
+
+  REQUIRE(scheduler.next_due() == now);
+  REQUIRE(scheduler.due(now) == std::vector<std::size_t>{1});
+}
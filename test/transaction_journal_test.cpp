@@ -0,0 +1,162 @@
+#include <catch2/catch_test_macros.hpp>
+#include <dropclone/transaction_journal.hpp>
+#include <dropclone/clone_transaction.hpp>
+#include <dropclone/path_snapshot.hpp>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <chrono>
+
+namespace fs = std::filesystem;
+namespace dc = dropclone;
+
+static fs::path const journal_root = fs::temp_directory_path() / fs::path{"dropclone_transaction_journal_test"};
+static fs::path const journal_path = journal_root / fs::path{"entry.journal"};
+
+using operation = dc::transaction_journal::operation;
+
+TEST_CASE("transaction_journal replays steps in order with their completion", "[transaction_journal]") {
+  fs::remove_all(journal_root);
+  fs::create_directories(journal_root);
+
+  dc::path_info info{};
+  info.file_size = 42;
+
+  {
+    dc::transaction_journal journal{journal_path};
+    journal.begin(operation::copy, "/src/a.txt", "/dst/a.txt", info);
+    journal.done(operation::copy, "/src/a.txt", "/dst/a.txt");
+    journal.begin(operation::update, "/src/b.txt", "/dst/b.txt", info);
+  }
+
+  auto const steps = dc::transaction_journal{journal_path}.replay();
+  REQUIRE(steps.size() == 2);
+  CHECK(steps[0].kind == operation::copy);
+  CHECK(steps[0].done);
+  CHECK(steps[0].info.file_size == 42);
+  CHECK(steps[1].kind == operation::update);
+  CHECK(steps[1].destination == fs::path{"/dst/b.txt"});
+  CHECK_FALSE(steps[1].done);
+
+  fs::remove_all(journal_root);
+}
+
+TEST_CASE("transaction_journal leaves abandoned steps out of the replay", "[transaction_journal]") {
+  fs::remove_all(journal_root);
+  fs::create_directories(journal_root);
+
+  {
+    dc::transaction_journal journal{journal_path};
+    journal.begin(operation::copy, "/src/a.txt", "/dst/a.txt");
+    journal.begin(operation::copy, "/src/b.txt", "/dst/b.txt");
+    journal.abandon(operation::copy, "/src/a.txt", "/dst/a.txt");
+    journal.sync();
+  }
+
+  auto const steps = dc::transaction_journal{journal_path}.replay();
+  REQUIRE(steps.size() == 1);
+  CHECK(steps[0].source == fs::path{"/src/b.txt"});
+  CHECK_FALSE(steps[0].done);
+
+  fs::remove_all(journal_root);
+}
+
+TEST_CASE("transaction_journal stops replaying at a torn record", "[transaction_journal]") {
+  fs::remove_all(journal_root);
+  fs::create_directories(journal_root);
+
+  {
+    dc::transaction_journal journal{journal_path};
+    journal.begin(operation::rename, "/dst/a.txt", "/dst/.dropclone-trash/1/a.txt");
+    journal.begin(operation::rename, "/dst/b.txt", "/dst/.dropclone-trash/1/b.txt");
+  }
+  fs::resize_file(journal_path, fs::file_size(journal_path) - 3);
+
+  CHECK(dc::transaction_journal{journal_path}.replay().size() == 1);
+
+  fs::remove_all(journal_root);
+}
+
+TEST_CASE("transaction_journal truncate drops the records after a mark", "[transaction_journal]") {
+  fs::remove_all(journal_root);
+  fs::create_directories(journal_root);
+
+  dc::transaction_journal journal{journal_path};
+  journal.begin(operation::copy, "/src/a.txt", "/dst/a.txt");
+  auto const mark = journal.mark();
+  journal.begin(operation::copy, "/src/b.txt", "/dst/b.txt");
+
+  journal.truncate(mark);
+  CHECK(journal.replay().size() == 1);
+
+  journal.reset();
+  CHECK(journal.replay().empty());
+  CHECK(fs::file_size(journal_path) == 0);
+
+  fs::remove_all(journal_root);
+}
+
+TEST_CASE("copy_files records every copy in the journal", "[transaction_journal][copy_files]") {
+  fs::remove_all(journal_root);
+  fs::create_directories(journal_root / "source");
+  fs::create_directories(journal_root / "destination");
+
+  dc::path_snapshot::snapshot_entries files{};
+  for (int file{0}; file != 8; ++file) {
+    auto const name = fs::path{"file_" + std::to_string(file)};
+    std::ofstream{journal_root / "source" / name} << file;
+    files.emplace(name, dc::path_info{});
+  }
+
+  dc::transaction_journal journal{journal_path};
+  dc::command_options options{4};
+  options.journal = &journal;
+  dc::copy_files(files, journal_root / "source", journal_root / "destination", 
+                 false, fs::copy_options::none, options);
+
+  auto const steps = journal.replay();
+  CHECK(steps.size() == 8);
+  for (auto const& step : steps) {
+    CHECK(step.kind == operation::copy);
+    CHECK(step.done);
+  }
+
+  fs::remove_all(journal_root);
+}
+
+TEST_CASE("copy_files abandons copies that kept an existing destination", "[transaction_journal][copy_files]") {
+  fs::remove_all(journal_root);
+  fs::create_directories(journal_root / "source");
+  fs::create_directories(journal_root / "destination");
+
+  std::ofstream{journal_root / "source" / "kept.txt"} << "old";
+  std::ofstream{journal_root / "destination" / "kept.txt"} << "newer";
+  fs::last_write_time(journal_root / "destination" / "kept.txt",
+                      fs::last_write_time(journal_root / "source" / "kept.txt") + std::chrono::hours{1});
+  std::ofstream{journal_root / "source" / "copied.txt"} << "copied";
+
+  dc::path_snapshot::snapshot_entries files{};
+  files.emplace(fs::path{"kept.txt"}, dc::path_info{});
+  files.emplace(fs::path{"copied.txt"}, dc::path_info{});
+
+  dc::transaction_journal journal{journal_path};
+  dc::durability_tracker durability{dc::durability_mode::per_file};
+  dc::command_options options{};
+  options.journal = &journal;
+  options.durability = &durability;
+  dc::copy_files(files, journal_root / "source", journal_root / "destination", 
+                 false, fs::copy_options::update_existing, options);
+
+  // recovery would otherwise remove the kept file as an unfinished copy
+  auto const steps = journal.replay();
+  REQUIRE(steps.size() == 1);
+  CHECK(steps[0].destination == journal_root / "destination" / "copied.txt");
+  CHECK(steps[0].done);
+
+  std::ifstream kept{journal_root / "destination" / "kept.txt"};
+  std::string content{};
+  kept >> content;
+  CHECK(content == "newer");
+
+  fs::remove_all(journal_root);
+}
@@ -0,0 +1,49 @@
+#include <catch2/catch_test_macros.hpp>
+#include <dropclone/trash_purger.hpp>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace fs = std::filesystem;
+namespace dc = dropclone;
+
+static fs::path const purger_root = fs::temp_directory_path() / fs::path{"dropclone_trash_purger_test"};
+
+static auto create_trash(fs::path const& trash, int directories, int files) -> void {
+  for (int directory{0}; directory != directories; ++directory) {
+    auto const directory_path = trash / ("dir_" + std::to_string(directory)) / "nested";
+    fs::create_directories(directory_path);
+    for (int file{0}; file != files; ++file) {
+      std::ofstream{directory_path / ("file_" + std::to_string(file))} << file;
+    }
+  }
+}
+
+TEST_CASE("trash_purger::purge_now unlinks a trash tree in parallel", "[trash_purger]") {
+  fs::remove_all(purger_root);
+  auto const trash = dc::trash_purger::trash_root(purger_root) / "1";
+  create_trash(trash, 8, 16);
+
+  // 8 * (dir + nested + 16 files) + the trash directory itself
+  CHECK(dc::trash_purger::purge_now(trash, 4) == 8 * 18 + 1);
+  CHECK_FALSE(fs::exists(trash));
+  CHECK(dc::trash_purger::purge_now(trash) == 0);
+
+  fs::remove_all(purger_root);
+}
+
+TEST_CASE("trash_purger purges in the background and drops an empty root", "[trash_purger]") {
+  fs::remove_all(purger_root);
+  auto const root = purger_root / "root";
+  auto const trash = dc::trash_purger::trash_root(root) / "1";
+  create_trash(trash, 2, 4);
+
+  dc::trash_purger purger{2};
+  purger.purge(trash, root);
+  purger.wait();
+
+  CHECK_FALSE(fs::exists(root));
+  CHECK(fs::exists(purger_root));
+
+  fs::remove_all(purger_root);
+}
@@ -0,0 +1,61 @@
+#include <catch2/catch_test_macros.hpp>
+#include <dropclone/worker_pool.hpp>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+
+namespace dc = dropclone;
+
+TEST_CASE("wait returns after all submitted tasks have run", "[worker_pool]") {
+  dc::worker_pool pool{3};
+  std::atomic<int> completed{0};
+
+  for (int task{0}; task != 20; ++task) {
+    pool.submit([&] { ++completed; });
+  }
+  pool.wait();
+
+  CHECK(completed == 20);
+}
+
+TEST_CASE("no more tasks than threads run at the same time", "[worker_pool]") {
+  dc::worker_pool pool{2};
+  std::atomic<int> running{0};
+  std::atomic<int> max_running{0};
+
+  for (int task{0}; task != 8; ++task) {
+    pool.submit([&] {
+      auto const now_running = ++running;
+      auto observed = max_running.load();
+      while (observed < now_running && !max_running.compare_exchange_weak(observed, now_running)) {}
+      std::this_thread::sleep_for(std::chrono::milliseconds{5});
+      --running;
+    });
+  }
+  pool.wait();
+
+  CHECK(pool.size() == 2);
+  CHECK(max_running <= 2);
+}
+
+TEST_CASE("submit blocks while the queue is at capacity", "[worker_pool]") {
+  dc::worker_pool pool{1, 2};
+  std::atomic<int> completed{0};
+  std::atomic<int> max_queued{0};
+  std::atomic<int> submitted{0};
+
+  for (int task{0}; task != 10; ++task) {
+    pool.submit([&] {
+      auto const queued = submitted.load() - completed.load() - 1;
+      max_queued = std::max(max_queued.load(), queued);
+      std::this_thread::sleep_for(std::chrono::milliseconds{2});
+      ++completed;
+    });
+    ++submitted;
+  }
+  pool.wait();
+
+  CHECK(completed == 10);
+  CHECK(max_queued <= 2);
+}